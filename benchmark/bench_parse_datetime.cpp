@@ -0,0 +1,92 @@
+#include <toml.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// parses arrays of timestamps and prints the throughput.
+
+namespace
+{
+
+template<typename F>
+double best_of(const std::size_t n, F&& f)
+{
+    double best = 1e300;
+    for(std::size_t i=0; i<n; ++i)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        f();
+        const auto stop  = std::chrono::steady_clock::now();
+        best = (std::min)(best, std::chrono::duration<double>(stop - start).count());
+    }
+    return best;
+}
+
+} // anonymous
+
+int main()
+{
+    // log-like timestamps with and without fractions and offsets.
+    std::mt19937 rng(123456789);
+    const char* const formats[] = {
+        "%04d-%02d-%02dT%02d:%02d:%02dZ",
+        "%04d-%02d-%02dT%02d:%02d:%02d.%03d+09:00",
+        "%04d-%02d-%02d %02d:%02d:%02d.%06d-07:30",
+        "%04d-%02d-%02dT%02d:%02d:%02d.%09dz",
+    };
+
+    std::vector<std::string> tokens;
+    std::string doc;
+    for(std::size_t i=0; i<1000; ++i)
+    {
+        doc += "a" + std::to_string(i) + " = [";
+        for(std::size_t j=0; j<1000; ++j)
+        {
+            char buf[64];
+            std::snprintf(buf, sizeof(buf), formats[j % 4],
+                static_cast<int>(1970 + rng() % 100), static_cast<int>(1 + rng() % 12),
+                static_cast<int>(1 + rng() % 28), static_cast<int>(rng() % 24),
+                static_cast<int>(rng() % 60), static_cast<int>(rng() % 60),
+                static_cast<int>(rng() % 1000));
+            tokens.push_back(buf);
+            doc += tokens.back();
+            doc += (j + 1 == 1000) ? "]\n" : ", ";
+        }
+    }
+    const double megabytes = static_cast<double>(doc.size()) / 1e6;
+
+    const auto document = best_of(5, [&doc] {
+        std::istringstream iss(doc);
+        const auto v = toml::parse(iss, "bench");
+        if(v.size() != 1000) {std::cerr << "unexpected size" << std::endl;}
+    });
+    std::cout << "toml::parse (1M datetimes in arrays): " << document << " s, "
+              << megabytes / document << " MB/s" << std::endl;
+
+    std::string joined;
+    for(const auto& token : tokens)
+    {
+        joined += token;
+        joined += ',';
+    }
+    int sum = 0;
+    const auto converter = best_of(5, [&joined, &tokens, &sum] {
+        sum = 0;
+        toml::detail::location loc("bench", joined);
+        for(std::size_t i=0; i<tokens.size(); ++i)
+        {
+            sum += toml::detail::parse_offset_datetime(loc).unwrap().first.time.second;
+            loc.advance(); // skip ','
+        }
+    });
+    std::cout << "detail::parse_offset_datetime: " << converter << " s, "
+              << static_cast<double>(joined.size()) / 1e6 / converter
+              << " MB/s (" << sum << ")" << std::endl;
+    return 0;
+}
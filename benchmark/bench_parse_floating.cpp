@@ -0,0 +1,114 @@
+#include <toml.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// parses arrays of floats and prints the throughput.
+//
+// To compare with the conversion through std::istringstream that was used
+// before, `legacy_parse_floating` is also measured on the same tokens.
+
+namespace
+{
+
+toml::floating legacy_parse_floating(std::string str)
+{
+    str.erase(std::remove(str.begin(), str.end(), '_'), str.end());
+    std::istringstream iss(str);
+    toml::floating retval(0.0);
+    iss >> retval;
+    return retval;
+}
+
+template<typename F>
+double best_of(const std::size_t n, F&& f)
+{
+    double best = 1e300;
+    for(std::size_t i=0; i<n; ++i)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        f();
+        const auto stop  = std::chrono::steady_clock::now();
+        best = (std::min)(best, std::chrono::duration<double>(stop - start).count());
+    }
+    return best;
+}
+
+} // anonymous
+
+int main()
+{
+    // hyperparameter-like values: short decimals and full 17-digit values.
+    std::mt19937_64 rng(123456789);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+
+    std::vector<std::string> tokens;
+    std::string doc;
+    for(std::size_t i=0; i<1000; ++i)
+    {
+        doc += "a" + std::to_string(i) + " = [";
+        for(std::size_t j=0; j<1000; ++j)
+        {
+            char buf[64];
+            std::snprintf(buf, sizeof(buf), (j % 2 == 0) ? "%.17g" : "%.4e",
+                          dist(rng) * 1000.0);
+            tokens.push_back(std::string(buf).find_first_of(".e") ==
+                std::string::npos ? std::string(buf) + ".0" : std::string(buf));
+            doc += tokens.back();
+            doc += (j + 1 == 1000) ? "]\n" : ", ";
+        }
+    }
+    const double megabytes = static_cast<double>(doc.size()) / 1e6;
+
+    const auto document = best_of(5, [&doc] {
+        std::istringstream iss(doc);
+        const auto v = toml::parse(iss, "bench");
+        if(v.size() != 1000) {std::cerr << "unexpected size" << std::endl;}
+    });
+    std::cout << "toml::parse (1M floats in arrays): " << document << " s, "
+              << megabytes / document << " MB/s" << std::endl;
+
+    std::string joined;
+    for(const auto& token : tokens)
+    {
+        joined += token;
+        joined += ' ';
+    }
+    const double token_megabytes = static_cast<double>(joined.size()) / 1e6;
+
+    double sum_new = 0.0;
+    const auto converter = best_of(5, [&joined, &tokens, &sum_new] {
+        sum_new = 0.0;
+        toml::detail::location loc("bench", joined);
+        for(std::size_t i=0; i<tokens.size(); ++i)
+        {
+            sum_new += toml::detail::parse_floating(loc).unwrap().first;
+            loc.advance(); // skip ' '
+        }
+    });
+    double sum_old = 0.0;
+    const auto legacy = best_of(5, [&tokens, &sum_old] {
+        sum_old = 0.0;
+        for(const auto& token : tokens)
+        {
+            sum_old += legacy_parse_floating(token);
+        }
+    });
+    if(std::memcmp(&sum_new, &sum_old, sizeof(double)) != 0)
+    {
+        std::cerr << "results differ" << std::endl;
+    }
+
+    std::cout << "detail::parse_floating: " << converter << " s, "
+              << token_megabytes / converter << " MB/s" << std::endl;
+    std::cout << "std::istringstream    : " << legacy    << " s, "
+              << token_megabytes / legacy    << " MB/s" << std::endl;
+    return 0;
+}
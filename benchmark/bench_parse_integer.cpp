@@ -0,0 +1,102 @@
+#include <toml.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// parses arrays of integers and prints the throughput.
+//
+// To compare with the conversion through std::istringstream that was used
+// before, `legacy_parse_integer` is also measured on the same tokens.
+
+namespace
+{
+
+toml::integer legacy_parse_integer(std::string str)
+{
+    str.erase(std::remove(str.begin(), str.end(), '_'), str.end());
+    std::istringstream iss(str);
+    toml::integer retval(0);
+    iss >> retval;
+    return retval;
+}
+
+template<typename F>
+double best_of(const std::size_t n, F&& f)
+{
+    double best = 1e300;
+    for(std::size_t i=0; i<n; ++i)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        f();
+        const auto stop  = std::chrono::steady_clock::now();
+        best = (std::min)(best, std::chrono::duration<double>(stop - start).count());
+    }
+    return best;
+}
+
+} // anonymous
+
+int main()
+{
+    std::mt19937_64 rng(123456789);
+    std::uniform_int_distribution<toml::integer> dist(
+        -1000000000000, 1000000000000);
+
+    std::vector<std::string> tokens;
+    std::string doc;
+    for(std::size_t i=0; i<1000; ++i)
+    {
+        doc += "a" + std::to_string(i) + " = [";
+        for(std::size_t j=0; j<1000; ++j)
+        {
+            tokens.push_back(std::to_string(dist(rng)));
+            doc += tokens.back();
+            doc += (j + 1 == 1000) ? "]\n" : ", ";
+        }
+    }
+    const double megabytes = static_cast<double>(doc.size()) / 1e6;
+
+    const auto document = best_of(5, [&doc] {
+        std::istringstream iss(doc);
+        const auto v = toml::parse(iss, "bench");
+        if(v.size() != 1000) {std::cerr << "unexpected size" << std::endl;}
+    });
+    std::cout << "toml::parse (1M integers in arrays): " << document << " s, "
+              << megabytes / document << " MB/s" << std::endl;
+
+    std::string joined;
+    for(const auto& token : tokens)
+    {
+        joined += token;
+        joined += ' ';
+    }
+    std::int64_t sum_new = 0;
+    const auto converter = best_of(5, [&joined, &tokens, &sum_new] {
+        sum_new = 0;
+        toml::detail::location loc("bench", joined);
+        for(std::size_t i=0; i<tokens.size(); ++i)
+        {
+            sum_new += toml::detail::parse_integer(loc).unwrap().first;
+            loc.advance(); // skip ' '
+        }
+    });
+    std::int64_t sum_old = 0;
+    const auto legacy = best_of(5, [&tokens, &sum_old] {
+        sum_old = 0;
+        for(const auto& token : tokens)
+        {
+            sum_old += legacy_parse_integer(token);
+        }
+    });
+    if(sum_new != sum_old) {std::cerr << "results differ" << std::endl;}
+
+    std::cout << "detail::parse_integer : " << converter << " s" << std::endl;
+    std::cout << "std::istringstream    : " << legacy    << " s" << std::endl;
+    return 0;
+}
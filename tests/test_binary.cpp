@@ -0,0 +1,146 @@
+#include <toml.hpp>
+
+#include "unit_test.hpp"
+
+#include <sstream>
+#include <string>
+
+BOOST_AUTO_TEST_CASE(test_binary_roundtrip)
+{
+    const auto data = toml::parse<toml::preserve_comments>(testinput("example.toml"));
+    toml::save_binary(data, "tmp_example.bin");
+    const auto loaded = toml::load_binary<toml::preserve_comments>("tmp_example.bin");
+    BOOST_TEST(loaded == data);
+
+    // comments are discarded if the value does not have them
+    const auto discarded = toml::load_binary("tmp_example.bin");
+    BOOST_TEST(discarded == toml::parse(testinput("example.toml")));
+}
+
+BOOST_AUTO_TEST_CASE(test_binary_all_types)
+{
+    std::istringstream iss(
+        "# file comment\n"
+        "\n"
+        "# comment for a\n"
+        "a = true\n"
+        "b = -9223372036854775808\n"
+        "c = -1.5e-300\n"
+        "d = \"basic\\n\"\n"
+        "e = 'literal'\n"
+        "f = 1979-05-27T07:32:00.123456789-07:30\n"
+        "g = 1979-05-27T07:32:00\n"
+        "h = 1979-05-27\n"
+        "i = 07:32:00.999\n"
+        "j = [1, \"two\", [3.0], {k = 4}] # inline\n"
+        "l = nan\n"
+        "[m.n]\n"
+        "o = -inf\n");
+    const auto data = toml::parse<toml::preserve_comments>(iss, "test.toml");
+
+    std::ostringstream oss;
+    toml::save_binary(oss, data);
+    const std::string bin = oss.str();
+    const auto loaded = toml::load_binary<toml::preserve_comments>(bin.data(), bin.size());
+
+    // nan != nan
+    BOOST_TEST(std::isnan(toml::find<double>(loaded, "l")));
+    for(const auto& kv : data.as_table())
+    {
+        if(kv.first == "l") {continue;}
+        BOOST_TEST(loaded.at(kv.first) == kv.second);
+        BOOST_TEST(loaded.at(kv.first).comments() == kv.second.comments());
+    }
+    BOOST_TEST(loaded.comments() == data.comments());
+    BOOST_TEST((loaded.at("d").as_string().kind == toml::string_t::basic));
+    BOOST_TEST((loaded.at("e").as_string().kind == toml::string_t::literal));
+
+    // an empty value
+    std::ostringstream oss2;
+    toml::save_binary(oss2, toml::value{});
+    const std::string bin2 = oss2.str();
+    BOOST_TEST(toml::load_binary(bin2.data(), bin2.size()).is_uninitialized());
+}
+
+BOOST_AUTO_TEST_CASE(test_binary_regions)
+{
+    std::istringstream iss("a = 42\n[b]\nc = \"foo\"\n");
+    const auto data = toml::parse(iss, "test.toml");
+
+    std::ostringstream oss;
+    toml::save_binary(oss, data, /*with_regions=*/true);
+    const std::string bin = oss.str();
+    const auto loaded = toml::load_binary(bin.data(), bin.size());
+
+    const auto& c = toml::find(loaded, "b", "c");
+    BOOST_TEST(c.location().file_name() == "test.toml");
+    BOOST_TEST(c.location().line() == 3u);
+    BOOST_TEST(c.location().line_str() == "c = \"foo\"");
+    BOOST_CHECK_THROW(toml::find<int>(loaded, "b", "c"), toml::type_error);
+
+    // without regions
+    std::ostringstream oss2;
+    toml::save_binary(oss2, data);
+    BOOST_TEST(oss2.str().size() < bin.size());
+    const std::string bin2 = oss2.str();
+    const auto loaded2 = toml::load_binary(bin2.data(), bin2.size());
+    BOOST_TEST(toml::find(loaded2, "b", "c").location().file_name() == "unknown file");
+}
+
+BOOST_AUTO_TEST_CASE(test_binary_errors)
+{
+    std::istringstream iss("a = [1, 2, 3]\nb = \"foo\"\n");
+    const auto data = toml::parse(iss);
+    std::ostringstream oss;
+    toml::save_binary(oss, data);
+    const std::string bin = oss.str();
+
+    // truncated
+    for(std::size_t i=0; i<bin.size(); ++i)
+    {
+        BOOST_CHECK_THROW(toml::load_binary(bin.data(), i), toml::binary_format_error);
+    }
+    // not a binary
+    const std::string text("a = 1\n");
+    BOOST_CHECK_THROW(toml::load_binary(text.data(), text.size()), toml::binary_format_error);
+    // another version
+    std::string other(bin);
+    other.at(8) = '\x7F';
+    BOOST_CHECK_THROW(toml::load_binary(other.data(), other.size()), toml::binary_format_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_binary_hostile)
+{
+    std::string header("TOML11B\n");
+    header += std::string("\x01\x00\x00\x00", 4); // version
+    const std::string no_regions  = header + std::string("\x00\x00\x00\x00", 4);
+    const std::string has_regions = header + std::string("\x01\x00\x00\x00", 4) +
+        std::string("\x01" "\x01" "a" "\x05" "a = 1", 9); // 1 source "a"
+
+    // the region [1, 1 + 2^64 - 1) wraps around.
+    std::string wrapped = has_regions + std::string("\x02\x00\x01\x01", 4) +
+        std::string(9, '\xFF') + std::string("\x01\x02", 2);
+    BOOST_CHECK_THROW(toml::load_binary(wrapped.data(), wrapped.size()),
+                      toml::binary_format_error);
+    // the region exceeds the source by one byte
+    std::string beyond = has_regions + std::string("\x02\x00\x01\x01\x05\x02", 6);
+    BOOST_CHECK_THROW(toml::load_binary(beyond.data(), beyond.size()),
+                      toml::binary_format_error);
+    std::string fits   = has_regions + std::string("\x02\x00\x01\x00\x05\x02", 6);
+    BOOST_TEST(toml::load_binary(fits.data(), fits.size()).as_integer() == 1);
+
+    // unknown string kind
+    const std::string kind = no_regions + std::string("\x04\x00\x05\x01" "a", 5);
+    BOOST_CHECK_THROW(toml::load_binary(kind.data(), kind.size()),
+                      toml::binary_format_error);
+
+    // deeply nested arrays
+    std::string nested = no_regions;
+    for(std::size_t i=0; i<100000; ++i)
+    {
+        nested += std::string("\x09\x00\x01", 3);
+    }
+    nested += std::string("\x00\x00", 2);
+    BOOST_CHECK_THROW(toml::load_binary(nested.data(), nested.size()),
+                      toml::binary_format_error);
+}
@@ -0,0 +1,171 @@
+#include <toml.hpp>
+
+#include "unit_test.hpp"
+
+#include <sstream>
+#include <string>
+
+namespace
+{
+toml::flat_document to_flat(const toml::value& v)
+{
+    std::stringstream ss;
+    toml::save_flat(ss, v);
+    return toml::flat_document(ss, "test.flat");
+}
+
+// compares a flat value with the original value recursively
+void check_same(const toml::flat_value& f, const toml::value& v)
+{
+    BOOST_TEST_REQUIRE((f.type() == v.type()));
+    switch(v.type())
+    {
+        case toml::value_t::boolean : {BOOST_TEST(f.as_boolean()  == v.as_boolean());  break;}
+        case toml::value_t::integer : {BOOST_TEST(f.as_integer()  == v.as_integer());  break;}
+        case toml::value_t::floating: {BOOST_TEST(f.as_floating() == v.as_floating()); break;}
+        case toml::value_t::string:
+        {
+            BOOST_TEST(f.as_string() == v.as_string().str);
+            BOOST_TEST((f.string_kind() == v.as_string().kind));
+            break;
+        }
+        case toml::value_t::offset_datetime:
+        {
+            BOOST_TEST(f.as_offset_datetime() == v.as_offset_datetime());
+            break;
+        }
+        case toml::value_t::local_datetime:
+        {
+            BOOST_TEST(f.as_local_datetime() == v.as_local_datetime());
+            break;
+        }
+        case toml::value_t::local_date:
+        {
+            BOOST_TEST(f.as_local_date() == v.as_local_date());
+            break;
+        }
+        case toml::value_t::local_time:
+        {
+            BOOST_TEST(f.as_local_time() == v.as_local_time());
+            break;
+        }
+        case toml::value_t::array:
+        {
+            BOOST_TEST_REQUIRE(f.size() == v.as_array().size());
+            for(std::size_t i=0; i<f.size(); ++i)
+            {
+                check_same(f.at(i), v.as_array().at(i));
+            }
+            break;
+        }
+        case toml::value_t::table:
+        {
+            BOOST_TEST_REQUIRE(f.size() == v.as_table().size());
+            for(std::size_t i=0; i<f.size(); ++i)
+            {
+                const auto k = f.key_at(i);
+                BOOST_TEST_REQUIRE(v.contains(k));
+                check_same(f.value_at(i), v.at(k));
+                check_same(f.at(k), v.at(k));
+                if(i != 0)
+                {
+                    BOOST_TEST((f.key_at(i-1) < k));
+                }
+            }
+            break;
+        }
+        default: {break;}
+    }
+}
+} // anonymous
+
+BOOST_AUTO_TEST_CASE(test_flat_document_example)
+{
+    const auto data = toml::parse(testinput("example.toml"));
+    toml::save_flat(data, "tmp_example.flat");
+
+    const toml::flat_document doc("tmp_example.flat");
+    check_same(doc.root(), data);
+
+    BOOST_TEST(toml::find<std::string>(doc.root(), "title") ==
+               toml::find<std::string>(data, "title"));
+}
+
+BOOST_AUTO_TEST_CASE(test_flat_document_find)
+{
+    std::istringstream iss(
+        "a = true\n"
+        "b = -9223372036854775808\n"
+        "c = -1.5e-300\n"
+        "d = \"basic\\n\"\n"
+        "e = 'literal'\n"
+        "f = 1979-05-27T07:32:00.999999-07:30\n"
+        "g = 1979-05-27T07:32:00\n"
+        "h = 1979-05-27\n"
+        "i = 07:32:00.123456789\n"
+        "j = [1, [2, 3], {k = 'v'}]\n"
+        "[t.u]\n"
+        "x = 42\n"
+        "[[arr]]\n"
+        "y = 1\n"
+        "[[arr]]\n"
+        "y = 2\n");
+    const auto data = toml::parse(iss, "test.toml");
+    const auto doc  = to_flat(data);
+    const auto root = doc.root();
+    check_same(root, data);
+
+    BOOST_TEST(toml::find<bool>(root, "a"));
+    BOOST_TEST(toml::find<std::int64_t>(root, "b") == (std::numeric_limits<std::int64_t>::min)());
+    BOOST_TEST(toml::find<double>(root, "c") == -1.5e-300);
+    BOOST_TEST(toml::find<std::string>(root, "d") == "basic\n");
+    BOOST_TEST(toml::find<int>(root, "j", 1u, 0u) == 2);
+    BOOST_TEST(toml::find<std::string>(root, "j", 2u, "k") == "v");
+    BOOST_TEST(toml::find<int>(root, "t", "u", "x") == 42);
+    BOOST_TEST(toml::find<int>(root, "arr", 1u, "y") == 2);
+    BOOST_TEST(toml::find<toml::local_date>(root, "h") ==
+               toml::local_date(1979, toml::month_t::May, 27));
+
+    const auto t = toml::find<toml::flat_value>(root, "t");
+    BOOST_TEST(t.is_table());
+    BOOST_TEST(t.contains("u"));
+    BOOST_TEST(t.count("v") == 0u);
+
+    // the string refers to the document
+    const auto d = toml::find(root, "d");
+    BOOST_TEST(std::string(d.string_data(), d.string_size()) == "basic\n");
+}
+
+BOOST_AUTO_TEST_CASE(test_flat_document_errors)
+{
+    std::istringstream iss("a = 1\nb = [1, 2]\n");
+    const auto doc  = to_flat(toml::parse(iss, "test.toml"));
+    const auto root = doc.root();
+
+    BOOST_CHECK_THROW(toml::find(root, "c"),              std::out_of_range);
+    BOOST_CHECK_THROW(toml::find(root, "b", 2u),           std::out_of_range);
+    BOOST_CHECK_THROW(toml::find<std::string>(root, "a"), toml::type_error);
+    BOOST_CHECK_THROW(toml::find(root, "a", "x"),         toml::type_error);
+    BOOST_CHECK_THROW(toml::find(root, "b").at(1).as_boolean(), toml::type_error);
+
+    std::stringstream ss;
+    toml::save_flat(ss, toml::value(toml::table{{"a", 1}}));
+    const std::string bytes = ss.str();
+    {
+        std::istringstream truncated(bytes.substr(0, bytes.size() - 1));
+        BOOST_CHECK_THROW(toml::flat_document(truncated, "test.flat"),
+                          toml::binary_format_error);
+    }
+    {
+        std::string wrong = bytes;
+        wrong[0] = 'X';
+        std::istringstream is(wrong);
+        BOOST_CHECK_THROW(toml::flat_document(is, "test.flat"), toml::binary_format_error);
+    }
+    {
+        std::string wrong = bytes;
+        wrong[8] = '\x7F';
+        std::istringstream is(wrong);
+        BOOST_CHECK_THROW(toml::flat_document(is, "test.flat"), toml::binary_format_error);
+    }
+}
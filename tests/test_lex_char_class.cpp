@@ -0,0 +1,86 @@
+#include <toml/lexer.hpp>
+
+#include "unit_test.hpp"
+
+#include <cctype>
+#include <random>
+#include <string>
+
+using namespace toml;
+using namespace detail;
+
+namespace
+{
+// runs both lexers on the same input and checks that they match the same
+// range, or both fail without moving the location.
+template<typename Fast, typename Reference>
+void check_same(const std::string& str)
+{
+    location fast_loc("test", str);
+    location ref_loc ("test", str);
+    const auto fast = Fast::invoke(fast_loc);
+    const auto ref  = Reference::invoke(ref_loc);
+
+    BOOST_TEST_REQUIRE(fast.is_ok() == ref.is_ok());
+    BOOST_TEST(std::distance(fast_loc.begin(), fast_loc.iter()) ==
+               std::distance(ref_loc.begin(),  ref_loc.iter()));
+    if(fast.is_ok())
+    {
+        BOOST_TEST(fast.unwrap().str() == ref.unwrap().str());
+    }
+}
+
+template<typename Fast, typename Reference>
+void check_random(const std::string& chars)
+{
+    std::mt19937 rng(123456789);
+    std::uniform_int_distribution<std::size_t> pick(0, chars.size() - 1);
+    for(std::size_t trial=0; trial<5000; ++trial)
+    {
+        std::string str;
+        for(std::size_t i=0, n=trial % 20; i<n; ++i)
+        {
+            str += chars.at(pick(rng));
+        }
+        check_same<Fast, Reference>(str);
+    }
+}
+} // anonymous
+
+BOOST_AUTO_TEST_CASE(test_char_class_table)
+{
+    for(int i=0; i<256; ++i)
+    {
+        const char c = static_cast<char>(i);
+        const bool ascii = i < 0x80;
+        BOOST_TEST(is_char_class(c, char_class_digit) == (ascii && std::isdigit(i) != 0));
+        BOOST_TEST(is_char_class(c, char_class_hex)   == (ascii && std::isxdigit(i) != 0));
+        BOOST_TEST(is_char_class(c, char_class_alpha) == (ascii && std::isalpha(i) != 0));
+        BOOST_TEST(is_char_class(c, char_class_oct)   == ('0' <= i && i <= '7'));
+        BOOST_TEST(is_char_class(c, char_class_bin)   == ('0' <= i && i <= '1'));
+        BOOST_TEST(is_char_class(c, char_class_bare_key) ==
+                   (ascii && (std::isalnum(i) != 0 || c == '_' || c == '-')));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_char_class_lexers)
+{
+    // all the bytes, one by one
+    for(int i=0; i<256; ++i)
+    {
+        const std::string str(1, static_cast<char>(i));
+        check_same<lex_alpha,           reference::lex_alpha          >(str);
+        check_same<lex_hex_dig,         reference::lex_hex_dig        >(str);
+        check_same<lex_unquoted_key,    reference::lex_unquoted_key   >(str);
+        check_same<lex_dec_digits<1>,   reference::lex_dec_digits<1>  >(str);
+        check_same<lex_hex_digits<0>,   reference::lex_hex_digits<0>  >(str);
+    }
+
+    const std::string chars("0123456789abcdefxyzABCDEFXYZ_-_.+ \xC3\xA9");
+    check_random<lex_unquoted_key,  reference::lex_unquoted_key >(chars);
+    check_random<lex_dec_digits<0>, reference::lex_dec_digits<0>>(chars);
+    check_random<lex_dec_digits<1>, reference::lex_dec_digits<1>>(chars);
+    check_random<lex_hex_digits<0>, reference::lex_hex_digits<0>>(chars);
+    check_random<lex_oct_digits<0>, reference::lex_oct_digits<0>>(chars);
+    check_random<lex_bin_digits<0>, reference::lex_bin_digits<0>>("01_2_");
+}
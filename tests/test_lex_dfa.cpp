@@ -0,0 +1,176 @@
+#include <toml/dfa.hpp>
+#include <toml/lexer.hpp>
+
+#include "unit_test.hpp"
+
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace toml;
+using namespace detail;
+
+namespace
+{
+// runs the automaton and the combinators on the same input and checks that
+// they match the same range, or both fail without moving the location.
+template<typename Lexer>
+void check_same(const std::string& str)
+{
+    location dfa_loc("test", str);
+    location ref_loc("test", str);
+    const auto fast = dfa<Lexer>::invoke(dfa_loc);
+    const auto ref  = Lexer::invoke(ref_loc);
+
+    BOOST_TEST_REQUIRE(fast.is_ok() == ref.is_ok(), "input: " << str);
+    BOOST_TEST(std::distance(dfa_loc.begin(), dfa_loc.iter()) ==
+               std::distance(ref_loc.begin(), ref_loc.iter()));
+    if(fast.is_ok())
+    {
+        BOOST_TEST(fast.unwrap().str() == ref.unwrap().str());
+    }
+}
+
+// random strings, and random edits of valid tokens.
+template<typename Lexer>
+void check_random(const std::string& chars, const std::vector<std::string>& seeds)
+{
+    std::mt19937 rng(123456789);
+    std::uniform_int_distribution<std::size_t> pick(0, chars.size() - 1);
+    for(std::size_t trial=0; trial<5000; ++trial)
+    {
+        std::string str;
+        for(std::size_t i=0, n=trial % 20; i<n; ++i)
+        {
+            str += chars.at(pick(rng));
+        }
+        check_same<Lexer>(str);
+    }
+    for(const auto& seed : seeds)
+    {
+        check_same<Lexer>(seed);
+        for(std::size_t trial=0; trial<1000; ++trial)
+        {
+            std::string str(seed);
+            std::uniform_int_distribution<std::size_t> pos(0, str.size() - 1);
+            switch(trial % 4)
+            {
+                case 0: str.at(pos(rng)) = chars.at(pick(rng));          break;
+                case 1: str.insert(pos(rng), 1, chars.at(pick(rng)));    break;
+                case 2: str.erase(pos(rng), 1);                          break;
+                case 3: str.resize(pos(rng));                            break;
+            }
+            check_same<Lexer>(str);
+        }
+    }
+}
+} // anonymous
+
+BOOST_AUTO_TEST_CASE(test_dfa_single_characters)
+{
+    for(int i=0; i<256; ++i)
+    {
+        const std::string str(1, static_cast<char>(i));
+        check_same<lex_digit>(str);
+        check_same<lex_alpha>(str);
+        check_same<lex_hex_dig>(str);
+        check_same<lex_unquoted_key>(str);
+        check_same<in_range<'\x00', '\x7F'>>(str);
+        check_same<in_range<'\x80', '\xBF'>>(str);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_dfa_numbers)
+{
+    const std::string chars("0123456789_+-.eExobABCDEFabcdfinty ");
+    const std::vector<std::string> ints{
+        "0", "+0", "-0", "42", "-17", "1_000_000", "0xDEAD_BEEF", "0o755",
+        "0b1101_0101", "123 # comment"
+    };
+    const std::vector<std::string> floats{
+        "3.1415", "-0.01", "5e+22", "1e06", "-2E-2", "6.626e-34",
+        "224_617.445_991_228", "inf", "+inf", "-nan", "1.0e+1_0"
+    };
+    check_random<lex_dec_int>(chars, ints);
+    check_random<lex_hex_int>(chars, ints);
+    check_random<lex_oct_int>(chars, ints);
+    check_random<lex_bin_int>(chars, ints);
+    check_random<lex_integer>(chars, ints);
+    check_random<lex_float  >(chars, floats);
+    check_random<lex_boolean>("truefals ", {"true", "false", "truefalse"});
+}
+
+BOOST_AUTO_TEST_CASE(test_dfa_datetimes)
+{
+    const std::string chars("0123456789-:.TtZz+ ");
+    const std::vector<std::string> seeds{
+        "1979-05-27T07:32:00Z", "1979-05-27t00:32:00-07:00",
+        "1979-05-27 00:32:00.999999+09:00", "1979-05-27T07:32:00",
+        "1979-05-27T00:32:00.999999", "1979-05-27", "07:32:00",
+        "00:32:00.999999"
+    };
+    check_random<lex_offset_date_time>(chars, seeds);
+    check_random<lex_local_date_time >(chars, seeds);
+    check_random<lex_local_date      >(chars, seeds);
+    check_random<lex_local_time      >(chars, seeds);
+}
+
+BOOST_AUTO_TEST_CASE(test_dfa_table)
+{
+    // [0-9]{2} : the dead state, start, one digit, and two digits.
+    // the bytes are [\x00-/], [0-9], and [:-\xFF].
+    const auto& t = dfa<repeat<lex_digit, exactly<2>>>::table();
+    BOOST_TEST(t.num_classes == 3u);
+    BOOST_TEST(t.next.size() == 4u * 3u);
+    BOOST_TEST(t.classes.at('/') != t.classes.at('0'));
+    BOOST_TEST(t.classes.at('0') == t.classes.at('9'));
+    BOOST_TEST(t.classes.at(':') == t.classes.at(0xFF));
+
+    // only the last state accepts.
+    BOOST_TEST(t.start_row  <  t.accept_row);
+    BOOST_TEST(t.accept_row == 3u * 3u);
+
+    // the dead state does not go anywhere.
+    for(std::size_t cls=0; cls<t.num_classes; ++cls)
+    {
+        BOOST_TEST(t.next.at(cls) == 0u);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_dfa_classifier)
+{
+    using classifier = dfa_classifier<lex_local_date, lex_float, lex_dec_int>;
+
+    // each lexer finds its own match in the same pass.
+    const auto check = [](const std::string& str) {
+        const auto ends = classifier::scan(str.data(), str.data() + str.size());
+        const auto end_of = [&str](const result<region, none_t>& r) -> const char* {
+            return r ? str.data() + r.unwrap().size() : nullptr;
+        };
+        location loc1("test", str);
+        location loc2("test", str);
+        location loc3("test", str);
+        BOOST_TEST((ends[0] == end_of(lex_local_date::invoke(loc1))), "input: " << str);
+        BOOST_TEST((ends[1] == end_of(lex_float     ::invoke(loc2))), "input: " << str);
+        BOOST_TEST((ends[2] == end_of(lex_dec_int   ::invoke(loc3))), "input: " << str);
+    };
+
+    for(const auto& str : std::vector<std::string>{
+            "", "1", "1979", "1979-05-27", "1979-05-27T", "3.14", "-3.14e+5",
+            "1e", "1_000 # comment", "x", "-", "+inf", "0123"})
+    {
+        check(str);
+    }
+    std::mt19937 rng(123456789);
+    const std::string chars("0123456789-+.eE_:T ");
+    std::uniform_int_distribution<std::size_t> pick(0, chars.size() - 1);
+    for(std::size_t trial=0; trial<5000; ++trial)
+    {
+        std::string str;
+        for(std::size_t i=0, n=trial % 16; i<n; ++i)
+        {
+            str += chars.at(pick(rng));
+        }
+        check(str);
+    }
+}
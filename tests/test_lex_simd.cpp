@@ -0,0 +1,201 @@
+#include <toml.hpp>
+
+#include "unit_test.hpp"
+#include "test_lex_aux.hpp"
+
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace toml;
+using namespace detail;
+
+namespace
+{
+// a string of random characters, mostly in `Class`.
+std::string random_run(std::mt19937& rng, const std::string& chars,
+                       const std::size_t len)
+{
+    std::uniform_int_distribution<std::size_t> pick(0, chars.size() - 1);
+    std::uniform_int_distribution<int> other(0, 255);
+    std::string str;
+    for(std::size_t i=0; i<len; ++i)
+    {
+        str += (other(rng) < 8) ? static_cast<char>(other(rng)) : chars.at(pick(rng));
+    }
+    return str;
+}
+
+template<typename Class>
+void check_kernels(const std::string& chars)
+{
+    std::mt19937 rng(123456789);
+    for(std::size_t len=0; len<100; ++len)
+    {
+        for(std::size_t trial=0; trial<20; ++trial)
+        {
+            const auto str = random_run(rng, chars, len);
+            const char* first = str.data();
+            const char* last  = str.data() + str.size();
+            const auto expected = skip_scalar<Class>(first, last);
+            BOOST_TEST(skip_class<Class>(first, last) == expected);
+#ifdef TOML11_HAS_SSE2
+            BOOST_TEST(skip_sse2<Class>(first, last) == expected);
+#endif
+#ifdef TOML11_HAS_AVX2_DISPATCH
+            if(cpu_has_avx2())
+            {
+                BOOST_TEST(skip_avx2<Class>(first, last) == expected);
+            }
+#endif
+        }
+    }
+}
+} // anonymous
+
+BOOST_AUTO_TEST_CASE(test_simd_kernels)
+{
+    check_kernels<ws_class>(" \t");
+    std::string printable("\t\x80\xC3\xA9\xFF");
+    for(char c = 0x20; c < 0x7F; ++c) {printable += c;}
+    check_kernels<comment_class>(printable);
+    check_kernels<ascii_class>(printable);
+
+    // all the bytes
+    for(int i=0; i<256; ++i)
+    {
+        const std::string str(40, static_cast<char>(i));
+        const char* first = str.data();
+        const char* last  = str.data() + str.size();
+        BOOST_TEST(skip_class<ws_class>(first, last) ==
+                   skip_scalar<ws_class>(first, last));
+        BOOST_TEST(skip_class<comment_class>(first, last) ==
+                   skip_scalar<comment_class>(first, last));
+        BOOST_TEST(skip_class<ascii_class>(first, last) ==
+                   skip_scalar<ascii_class>(first, last));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_lex_long_ws_comment)
+{
+    const std::string ws(100, ' ');
+    TOML11_TEST_LEX_ACCEPT(lex_ws, ws + "a", ws);
+    TOML11_TEST_LEX_ACCEPT(lex_ws, ws + "\t\t" + ws + "\n", ws + "\t\t" + ws);
+    TOML11_TEST_LEX_REJECT(lex_ws, "a" + ws);
+
+    const std::string text(100, 'x');
+    TOML11_TEST_LEX_ACCEPT(lex_comment, "#" + text + "\n", "#" + text);
+    TOML11_TEST_LEX_ACCEPT(lex_comment, "#" + text + "\xE3\x81\x82" + text + "\r\n",
+                                        "#" + text + "\xE3\x81\x82" + text);
+    // stops at a control character and an invalid UTF-8 sequence
+    TOML11_TEST_LEX_ACCEPT(lex_comment, "#" + text + "\x01" + text, "#" + text);
+    TOML11_TEST_LEX_ACCEPT(lex_comment, "#" + text + "\x7F" + text, "#" + text);
+    TOML11_TEST_LEX_ACCEPT(lex_comment, "#" + text + "\xE3\x81" + text, "#" + text);
+}
+
+BOOST_AUTO_TEST_CASE(test_simd_line_number)
+{
+    // heavily indented lines and long comments before an error
+    std::string content;
+    for(std::size_t i=0; i<50; ++i)
+    {
+        content += std::string(i, ' ') + "a" + std::to_string(i) + " = " +
+                   std::to_string(i) + std::string(i, '\t') + "# " +
+                   std::string(i, '-') + "\n";
+    }
+    content += "arr = [\n" + std::string(40, ' ') + "1, # comment\n" +
+               std::string(40, ' ') + "# comment\n" +
+               std::string(40, ' ') + "2,\n]\n";
+    content += std::string(40, ' ') + "err = \n";
+
+    std::istringstream iss(content);
+    std::string msg;
+    try
+    {
+        toml::parse(iss, "test.toml");
+    }
+    catch(const toml::syntax_error& e)
+    {
+        msg = e.what();
+    }
+    BOOST_TEST(msg.find(" 56 | ") != std::string::npos);
+
+    std::istringstream iss2(content.substr(0, content.size() - 47));
+    const auto v = toml::parse(iss2, "test.toml");
+    BOOST_TEST(toml::find<int>(v, "a49") == 49);
+    BOOST_TEST(toml::find(v, "arr").location().line() == 51);
+}
+
+BOOST_AUTO_TEST_CASE(test_simd_string_body_kernels)
+{
+    std::string chars("\t\n\"\\'\x7F\x01\x80\xC3\xA9\xFF");
+    for(char c = 0x20; c < 0x7F; c += 5) {chars += c;}
+    check_kernels<basic_string_body_class>(chars);
+    check_kernels<ml_basic_string_body_class>(chars);
+    check_kernels<literal_string_body_class>(chars);
+    check_kernels<ml_literal_string_body_class>(chars);
+}
+
+BOOST_AUTO_TEST_CASE(test_simd_utf8_validation)
+{
+    // fragments of valid and invalid sequences, including the boundaries
+    const std::vector<std::string> fragments = {
+        "a", "~", "\x7F", "\xC2\x80", "\xDF\xBF", "\xE0\xA0\x80", "\xED\x9F\xBF",
+        "\xEF\xBF\xBF", "\xF0\x90\x80\x80", "\xF4\x8F\xBF\xBF",
+        "\x80", "\xBF", "\xC0\x80", "\xC1\xBF", "\xC2", "\xE0\x80\x80",
+        "\xE0\x9F\xBF", "\xED\xA0\x80", "\xE1\x80", "\xF0\x8F\xBF\xBF",
+        "\xF4\x90\x80\x80", "\xF5\x80\x80\x80", "\xF8", "\xFF", "\xF1\x80\x80",
+    };
+    std::mt19937 rng(123456789);
+    std::uniform_int_distribution<std::size_t> pick(0, fragments.size() - 1);
+    std::uniform_int_distribution<int> percent(0, 99);
+    for(std::size_t trial=0; trial<20000; ++trial)
+    {
+        // mostly ASCII and valid sequences, sometimes an invalid one
+        std::string str;
+        const auto invalid_rate = trial % 3 == 0 ? 0 : 2;
+        while(str.size() < trial % 150)
+        {
+            const auto p = percent(rng);
+            if(p < 50)
+            {
+                str += 'a';
+            }
+            else if(p < 100 - invalid_rate)
+            {
+                str += fragments.at(pick(rng) % 10);
+            }
+            else
+            {
+                str += fragments.at(pick(rng));
+            }
+        }
+
+        // the reference is the lexer
+        location loc("test", str);
+        repeat<lex_utf8_code, unlimited>::invoke(loc);
+        const auto expected = std::distance(loc.begin(), loc.iter());
+
+        const char* first = str.data();
+        const char* last  = str.data() + str.size();
+        BOOST_TEST(std::distance(first, validate_utf8(first, last))        == expected);
+        BOOST_TEST(std::distance(first, validate_utf8_scalar(first, last)) == expected);
+#ifdef TOML11_HAS_AVX2_DISPATCH
+        if(cpu_has_avx2())
+        {
+            BOOST_TEST(utf8_checker_avx2::is_valid(first, last) ==
+                       (expected == static_cast<std::ptrdiff_t>(str.size())));
+        }
+#endif
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_lex_comment_utf8)
+{
+    const std::string text(50, 'x');
+    TOML11_TEST_LEX_ACCEPT(lex_comment, "#" + text + "\xF0\x9F\x98\x80" + text + "\xC0\x80",
+                                        "#" + text + "\xF0\x9F\x98\x80" + text);
+    TOML11_TEST_LEX_ACCEPT(lex_comment, "#" + text + "\xF0\x9F\x98" + "\n",
+                                        "#" + text);
+}
@@ -0,0 +1,99 @@
+#include <toml/region.hpp>
+
+#include "unit_test.hpp"
+
+#include <algorithm>
+#include <random>
+#include <string>
+
+using namespace toml;
+using namespace detail;
+
+BOOST_AUTO_TEST_CASE(test_line_starts)
+{
+    // longer than a SIMD block, with newlines at the block boundaries.
+    std::string str(100, 'a');
+    for(const std::size_t i : {0u, 15u, 16u, 31u, 32u, 33u, 63u, 64u, 98u, 99u})
+    {
+        str.at(i) = '\n';
+    }
+    const auto starts = find_line_starts(str.data(), str.data() + str.size());
+
+    std::vector<std::size_t> expected{0};
+    for(std::size_t i=0; i<str.size(); ++i)
+    {
+        if(str.at(i) == '\n') {expected.push_back(i+1);}
+    }
+    BOOST_TEST(starts == expected);
+
+    const std::string empty;
+    BOOST_TEST(find_line_starts(empty.data(), empty.data()) ==
+               std::vector<std::size_t>{0});
+}
+
+BOOST_AUTO_TEST_CASE(test_location_line_num)
+{
+    std::mt19937 rng(123456789);
+    std::string str;
+    for(std::size_t i=0; i<1000; ++i)
+    {
+        str += (rng() % 8 == 0) ? '\n' : 'x';
+    }
+
+    location loc("test", str);
+    std::size_t line = 1;
+    for(std::size_t i=0; i<=str.size(); ++i)
+    {
+        BOOST_TEST(loc.line_num() == std::to_string(line));
+
+        const auto newline = (i == 0) ? std::string::npos : str.rfind('\n', i - 1);
+        const auto first   = (newline == std::string::npos) ? 0 : newline + 1;
+        const auto last    = std::min(str.find('\n', i), str.size());
+        BOOST_TEST(loc.before() == i - first);
+        BOOST_TEST(loc.after()  == last - i);
+
+        if(i < str.size())
+        {
+            if(str.at(i) == '\n') {++line;}
+            loc.advance();
+        }
+    }
+
+    // moving backward
+    loc.reset(loc.begin() + 10);
+    BOOST_TEST(loc.line_num() ==
+        std::to_string(1 + std::count(str.begin(), str.begin() + 10, '\n')));
+    loc.reset(loc.end());
+    loc.retrace();
+    BOOST_TEST(loc.line_num() == std::to_string(
+        1 + std::count(str.begin(), str.end() - 1, '\n')));
+}
+
+BOOST_AUTO_TEST_CASE(test_line_noexcept)
+{
+    // they are called while an error message is formatted.
+    const std::string str("a\nb\n");
+    location loc("test", str);
+    const region reg(loc, loc.iter(), loc.iter() + 1);
+    BOOST_TEST(noexcept(loc.line_begin()));
+    BOOST_TEST(noexcept(loc.line_end()));
+    BOOST_TEST(noexcept(reg.line_begin()));
+    BOOST_TEST(noexcept(reg.line_end()));
+    BOOST_TEST(noexcept(loc.source()->line_number(loc.iter())));
+}
+
+BOOST_AUTO_TEST_CASE(test_region_line)
+{
+    const std::string str("a = 1\nb = [\n  2,\n  3,\n]\n");
+    location loc("test", str);
+    loc.advance(static_cast<std::ptrdiff_t>(str.find('[')));
+    const auto first = loc.iter();
+    loc.advance(static_cast<std::ptrdiff_t>(str.find(']') - str.find('[') + 1));
+
+    const region reg(loc, first, loc.iter());
+    BOOST_TEST(reg.line_num() == "2");
+    BOOST_TEST(reg.line()     == "b = [");
+    BOOST_TEST(reg.before()   == 4u);
+    BOOST_TEST(reg.after()    == 0u);
+    BOOST_TEST(loc.line_num() == "5");
+}
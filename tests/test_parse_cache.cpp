@@ -0,0 +1,149 @@
+#include <toml.hpp>
+
+#include "unit_test.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+// created by tests/CMakeLists.txt in the build tree.
+const std::string cache_dir("parse_cache");
+
+void write_file(const std::string& fname, const std::string& content)
+{
+    std::ofstream ofs(fname, std::ios_base::binary);
+    ofs << content;
+}
+std::vector<char> read_file(const std::string& fname)
+{
+    std::ifstream ifs(fname, std::ios_base::binary);
+    return toml::detail::read_stream(ifs);
+}
+std::string cache_path(const std::string& fname, const bool with_comments)
+{
+    return toml::detail::parse_cache_path(cache_dir, fname, read_file(fname),
+                                          with_comments);
+}
+// writes an entry as if `content` was parsed from a file named `source`.
+void write_entry(const std::string& path, const std::string& source,
+                 const std::string& content)
+{
+    std::istringstream iss(content);
+    toml::save_binary(toml::parse(iss, source), path, true);
+}
+bool exists(const std::string& fname)
+{
+    return std::ifstream(fname).good();
+}
+} // anonymous
+
+BOOST_AUTO_TEST_CASE(test_parse_cache_hit)
+{
+    const std::string fname("tmp_cached.toml");
+    write_file(fname, "# comment\na = 42\n[b]\nc = 'foo'\n");
+
+    const auto path = cache_path(fname, false);
+    std::remove(path.c_str());
+
+    const auto parsed = toml::parse_cached(fname, cache_dir);
+    BOOST_TEST(parsed == toml::parse(fname));
+    BOOST_TEST(exists(path));
+
+    // replace the entry to check that it is actually used
+    auto modified = toml::parse(fname);
+    modified["cached"] = true;
+    toml::save_binary(modified, path, true);
+    BOOST_TEST(toml::parse_cached(fname, cache_dir) == modified);
+
+    // comments are cached separately
+    const auto with_comments = toml::parse_cached<toml::preserve_comments>(fname, cache_dir);
+    BOOST_TEST(with_comments == toml::parse<toml::preserve_comments>(fname));
+    BOOST_TEST(exists(cache_path(fname, true)));
+
+    std::remove(cache_path(fname, true).c_str());
+    std::remove(path.c_str());
+    std::remove(fname.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(test_parse_cache_collision)
+{
+    const std::string fname("tmp_cached_collision.toml");
+    write_file(fname, "a = 1\n");
+    const auto path = cache_path(fname, false);
+
+    // an entry of another content that has the same hash is not used, even
+    // if the file name and the size are the same.
+    write_entry(path, fname, "a = 2\n");
+    BOOST_TEST(toml::find<int>(toml::parse_cached(fname, cache_dir), "a") == 1);
+
+    // the file name is also compared because it appears in error messages.
+    toml::value loaded;
+    write_entry(path, "another.toml", "a = 1\n");
+    BOOST_TEST(!toml::detail::load_parse_cache(path, fname, read_file(fname), loaded));
+    write_entry(path, fname, "a = 1\n");
+    BOOST_TEST( toml::detail::load_parse_cache(path, fname, read_file(fname), loaded));
+
+    // an entry without the source is not used either.
+    toml::save_binary(toml::value(toml::table{{"a", 4}}), path);
+    BOOST_TEST(!toml::detail::load_parse_cache(path, fname, read_file(fname), loaded));
+    BOOST_TEST(toml::find<int>(toml::parse_cached(fname, cache_dir), "a") == 1);
+
+    std::remove(path.c_str());
+    std::remove(fname.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(test_parse_cache_invalidate)
+{
+    const std::string fname("tmp_cached_modified.toml");
+    write_file(fname, "a = 1\n");
+    const auto path1 = cache_path(fname, false);
+    BOOST_TEST(toml::find<int>(toml::parse_cached(fname, cache_dir), "a") == 1);
+
+    write_file(fname, "a = 2\n");
+    const auto path2 = cache_path(fname, false);
+    BOOST_TEST(path1 != path2);
+    BOOST_TEST(toml::find<int>(toml::parse_cached(fname, cache_dir), "a") == 2);
+
+    // a broken entry is replaced
+    write_file(path2, "broken");
+    BOOST_TEST(toml::find<int>(toml::parse_cached(fname, cache_dir), "a") == 2);
+    toml::value reloaded;
+    BOOST_TEST(toml::detail::load_parse_cache(path2, fname, read_file(fname), reloaded));
+    BOOST_TEST(toml::find<int>(reloaded, "a") == 2);
+
+    std::remove(path1.c_str());
+    std::remove(path2.c_str());
+    std::remove(fname.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(test_parse_cache_error_message)
+{
+    const std::string fname("tmp_cached_error.toml");
+    write_file(fname, "a = 1\nb = 'foo'\n");
+    const auto path = cache_path(fname, false);
+
+    std::string expected;
+    try {toml::find<std::string>(toml::parse(fname), "a");}
+    catch(const toml::type_error& e) {expected = e.what();}
+
+    toml::parse_cached(fname, cache_dir);
+    std::string actual;
+    try {toml::find<std::string>(toml::parse_cached(fname, cache_dir), "a");}
+    catch(const toml::type_error& e) {actual = e.what();}
+
+    BOOST_TEST(!expected.empty());
+    BOOST_TEST(actual == expected);
+    std::remove(path.c_str());
+
+    // a syntax error is not cached
+    write_file(fname, "a = \n");
+    BOOST_CHECK_THROW(toml::parse_cached(fname, cache_dir), toml::syntax_error);
+    BOOST_TEST(!exists(cache_path(fname, false)));
+    BOOST_CHECK_THROW(toml::parse_cached("tmp_nonexistent.toml", cache_dir), std::ios_base::failure);
+
+    std::remove(fname.c_str());
+}
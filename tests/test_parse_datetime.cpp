@@ -3,6 +3,8 @@
 #include "unit_test.hpp"
 #include "test_parse_aux.hpp"
 
+#include <random>
+
 using namespace toml;
 using namespace detail;
 
@@ -19,6 +21,75 @@ BOOST_AUTO_TEST_CASE(test_time)
     TOML11_TEST_PARSE_EQUAL(parse_local_time, "23:59:60.999999", toml::local_time(23, 59, 60, 999, 999)); // leap second
 }
 
+BOOST_AUTO_TEST_CASE(test_time_secfrac)
+{
+    // shorter fractions are padded with 0. digits after the 9th are ignored.
+    TOML11_TEST_PARSE_EQUAL(parse_local_time, "07:32:00.5",           toml::local_time(7, 32, 0, 500,   0,   0));
+    TOML11_TEST_PARSE_EQUAL(parse_local_time, "07:32:00.1234",        toml::local_time(7, 32, 0, 123, 400,   0));
+    TOML11_TEST_PARSE_EQUAL(parse_local_time, "07:32:00.12345678",    toml::local_time(7, 32, 0, 123, 456, 780));
+    TOML11_TEST_PARSE_EQUAL(parse_local_time, "07:32:00.123456789",   toml::local_time(7, 32, 0, 123, 456, 789));
+    TOML11_TEST_PARSE_EQUAL(parse_local_time, "07:32:00.12345678987", toml::local_time(7, 32, 0, 123, 456, 789));
+    TOML11_TEST_PARSE_EQUAL(parse_local_time, "07:32:00.000000001",   toml::local_time(7, 32, 0,   0,   0,   1));
+
+    TOML11_TEST_PARSE_EQUAL(parse_offset_datetime, "1979-05-27T07:32:00.123456789Z",
+        toml::offset_datetime(toml::local_date(1979, toml::month_t::May, 27),
+                              toml::local_time(7, 32, 0, 123, 456, 789),
+                              toml::time_offset(0, 0)));
+    TOML11_TEST_PARSE_EQUAL(parse_offset_datetime, "1979-05-27T07:32:00.1-07:30",
+        toml::offset_datetime(toml::local_date(1979, toml::month_t::May, 27),
+                              toml::local_time(7, 32, 0, 100, 0, 0),
+                              toml::time_offset(-7, -30)));
+}
+
+BOOST_AUTO_TEST_CASE(test_swar_digits)
+{
+    // compare with a scalar reference on random 8-byte strings that are
+    // close to the patterns.
+    std::string chars("0123456789-:/;A ");
+    chars += '\0';
+    chars += '\xB0';
+    std::mt19937 rng(123456789);
+    std::uniform_int_distribution<std::size_t> pick(0, chars.size() - 1);
+    std::uniform_int_distribution<std::size_t> pos(0, 9);
+    const auto digit = [](const char c) {return '0' <= c && c <= '9';};
+    const auto two   = [](const char* p) {return (p[0] - '0') * 10 + (p[1] - '0');};
+
+    for(std::size_t trial=0; trial<20000; ++trial)
+    {
+        std::string date("1979-05-27");
+        std::string time("07:32:00");
+        for(std::size_t i=0, n=trial % 3; i<n; ++i)
+        {
+            date.at(pos(rng))     = chars.at(pick(rng));
+            time.at(pos(rng) % 8) = chars.at(pick(rng));
+        }
+
+        int y = 0, m = 0, d = 0;
+        const bool date_ok = digit(date[0]) && digit(date[1]) && digit(date[2]) &&
+            digit(date[3]) && date[4] == '-' && digit(date[5]) && digit(date[6]) &&
+            date[7] == '-' && digit(date[8]) && digit(date[9]);
+        BOOST_TEST(read_date_digits(date.data(), y, m, d) == date_ok, "input: " << date);
+        if(date_ok)
+        {
+            BOOST_TEST(y == two(date.data()) * 100 + two(date.data() + 2));
+            BOOST_TEST(m == two(date.data() + 5));
+            BOOST_TEST(d == two(date.data() + 8));
+        }
+
+        int h = 0, mi = 0, s = 0;
+        const bool time_ok = digit(time[0]) && digit(time[1]) && time[2] == ':' &&
+            digit(time[3]) && digit(time[4]) && time[5] == ':' &&
+            digit(time[6]) && digit(time[7]);
+        BOOST_TEST(read_time_digits(time.data(), h, mi, s) == time_ok, "input: " << time);
+        if(time_ok)
+        {
+            BOOST_TEST(h  == two(time.data()));
+            BOOST_TEST(mi == two(time.data() + 3));
+            BOOST_TEST(s  == two(time.data() + 6));
+        }
+    }
+}
+
 BOOST_AUTO_TEST_CASE(test_time_value)
 {
     TOML11_TEST_PARSE_EQUAL_VALUE(parse_value<toml::value>, "07:32:00",        toml::value(toml::local_time(7, 32, 0)));
@@ -244,3 +315,34 @@ BOOST_AUTO_TEST_CASE(test_offset_datetime_value)
         toml::value(toml::offset_datetime(toml::local_date(1979, toml::month_t::May, 27),
                               toml::local_time(7, 32, 0, 999, 999), toml::time_offset(9, 0))));
 }
+
+BOOST_AUTO_TEST_CASE(test_datetime_error_location)
+{
+    // the error points the invalid date or time, not the whole token
+    {
+        std::istringstream stream(std::string("ldt = 1979-15-27T07:32:00"));
+        try
+        {
+            toml::parse(stream);
+            BOOST_ERROR("toml::syntax_error is not thrown");
+        }
+        catch(const toml::syntax_error& e)
+        {
+            BOOST_TEST(e.location().column() == 7u);
+            BOOST_TEST(e.location().region() == 10u);
+        }
+    }
+    {
+        std::istringstream stream(std::string("odt = 1979-05-27T25:32:00.123-08:00"));
+        try
+        {
+            toml::parse(stream);
+            BOOST_ERROR("toml::syntax_error is not thrown");
+        }
+        catch(const toml::syntax_error& e)
+        {
+            BOOST_TEST(e.location().column() == 18u);
+            BOOST_TEST(e.location().region() == 12u);
+        }
+    }
+}
@@ -0,0 +1,217 @@
+#include <toml.hpp>
+
+#include "unit_test.hpp"
+
+#include <cstdlib>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// counts the allocations to check that parse_events does not allocate per value.
+static std::size_t allocation_count = 0;
+void* operator new(std::size_t n)
+{
+    ++allocation_count;
+    if(void* p = std::malloc(n == 0 ? 1 : n)) {return p;}
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept {std::free(p);}
+void operator delete(void* p, std::size_t) noexcept {std::free(p);}
+
+namespace
+{
+struct recorder : public toml::event_handler
+{
+    std::vector<std::string> events;
+    std::size_t              stop_at = 0; // 0 means never stop
+
+    bool push(std::string ev)
+    {
+        events.push_back(std::move(ev));
+        return events.size() != stop_at;
+    }
+    static std::string join(const std::vector<toml::key>& keys)
+    {
+        std::string retval;
+        for(const auto& k : keys)
+        {
+            if(!retval.empty()) {retval += '.';}
+            retval += k;
+        }
+        return retval;
+    }
+
+    bool on_table_header(const std::vector<toml::key>& keys)
+    {
+        return push("[" + join(keys) + "]");
+    }
+    bool on_array_table_header(const std::vector<toml::key>& keys)
+    {
+        return push("[[" + join(keys) + "]]");
+    }
+    bool on_key(const std::vector<toml::key>& keys)
+    {
+        return push("key " + join(keys));
+    }
+    bool on_boolean(const toml::boolean b)
+    {
+        return push(b ? "true" : "false");
+    }
+    bool on_integer(const toml::integer i)
+    {
+        return push("int " + std::to_string(i));
+    }
+    bool on_floating(const toml::floating f)
+    {
+        std::ostringstream oss; oss << "float " << f;
+        return push(oss.str());
+    }
+    bool on_string(const toml::string& s)
+    {
+        return push("str " + s.str);
+    }
+    bool on_local_date(const toml::local_date& d)
+    {
+        std::ostringstream oss; oss << "date " << d;
+        return push(oss.str());
+    }
+    bool on_offset_datetime(const toml::offset_datetime& dt)
+    {
+        std::ostringstream oss; oss << "odt " << dt;
+        return push(oss.str());
+    }
+    bool on_array_begin()        {return push("array begin");}
+    bool on_array_end()          {return push("array end");}
+    bool on_inline_table_begin() {return push("table begin");}
+    bool on_inline_table_end()   {return push("table end");}
+};
+} // anonymous
+
+BOOST_AUTO_TEST_CASE(test_parse_events_sequence)
+{
+    const std::string content(
+        "# comment\n"
+        "a.b = 42\n"
+        "c = \"foo\" # comment\n"
+        "\n"
+        "[d.\"e f\"]\n"
+        "g = [1, 2.5, [true], {h = 1979-05-27}]\n"
+        "i = {j = {k = 'bar'}}\n"
+        "[[l]]\n"
+        "m = [\n"
+        "  false, # comment\n"
+        "]\n"
+        "[[l]]\n"
+        "n = 1979-05-27T07:32:00Z");
+
+    recorder rec;
+    BOOST_TEST(toml::parse_events(content.data(), content.size(), rec));
+
+    const std::vector<std::string> expected{
+        "key a.b", "int 42",
+        "key c", "str foo",
+        "[d.e f]",
+        "key g", "array begin", "int 1", "float 2.5",
+            "array begin", "true", "array end",
+            "table begin", "key h", "date 1979-05-27", "table end",
+        "array end",
+        "key i", "table begin", "key j", "table begin", "key k", "str bar",
+        "table end", "table end",
+        "[[l]]",
+        "key m", "array begin", "false", "array end",
+        "[[l]]",
+        "key n", "odt 1979-05-27T07:32:00Z",
+    };
+    BOOST_TEST(rec.events == expected, boost::test_tools::per_element());
+}
+
+BOOST_AUTO_TEST_CASE(test_parse_events_stop)
+{
+    std::istringstream iss(
+        "a = [1, 2, 3]\n"
+        "b = 4\n");
+
+    recorder rec;
+    rec.stop_at = 3; // key a, array begin, int 1
+    BOOST_TEST(!toml::parse_events(iss, rec));
+
+    const std::vector<std::string> expected{"key a", "array begin", "int 1"};
+    BOOST_TEST(rec.events == expected, boost::test_tools::per_element());
+}
+
+BOOST_AUTO_TEST_CASE(test_parse_events_default_handler)
+{
+    toml::event_handler handler;
+    BOOST_TEST(toml::parse_events(testinput("example.toml"), handler));
+}
+
+BOOST_AUTO_TEST_CASE(test_parse_events_syntax_error)
+{
+    const std::vector<std::string> invalids{
+        "a = ",
+        "a = [1, 2",
+        "a = {b = 1,}",
+        "a = 1 b = 2",
+        "[a] b = 1",
+        "= 1",
+    };
+    for(const auto& content : invalids)
+    {
+        recorder rec;
+        BOOST_CHECK_THROW(toml::parse_events(content.data(), content.size(), rec),
+                          toml::syntax_error);
+    }
+
+    // the same error message as toml::parse
+    const std::string content("a = 1\nb = \"foo\nc = 3\n");
+    std::string expected, actual;
+    try
+    {
+        std::istringstream iss(content);
+        toml::parse(iss, "test.toml");
+    }
+    catch(const toml::syntax_error& e) {expected = e.what();}
+    try
+    {
+        recorder rec;
+        std::istringstream iss(content);
+        toml::parse_events(iss, rec, "test.toml");
+    }
+    catch(const toml::syntax_error& e) {actual = e.what();}
+    BOOST_TEST(!expected.empty());
+    BOOST_TEST(actual == expected);
+}
+
+BOOST_AUTO_TEST_CASE(test_parse_events_allocation)
+{
+    const auto make_content = [](const std::size_t n) -> std::string {
+        std::string content;
+        for(std::size_t i=0; i<n; ++i)
+        {
+            const auto idx = std::to_string(i);
+            content += "integer_" + idx + " = " + idx + "\n";
+            content += "floating_" + idx + " = 3.14\n";
+            content += "boolean_" + idx + " = true\n";
+            content += "string_" + idx + " = \"a string longer than a small buffer\"\n";
+            content += "literal_" + idx + " = 'a literal string longer than a buffer'\n";
+            content += "dotted_" + idx + ".key.\"quoted key\" = 1979-05-27T07:32:00Z\n";
+            content += "array_" + idx + " = [1, 2.0, 'three']\n";
+            content += "table_" + idx + " = {a = 1, b.c = 'd'} # comment\n";
+        }
+        return content;
+    };
+    const auto count = [](const std::string& content) -> std::size_t {
+        toml::event_handler handler;
+        const auto before = allocation_count;
+        toml::parse_events(content.data(), content.size(), handler,
+                           "a file name longer than a small string buffer.toml");
+        return allocation_count - before;
+    };
+    const auto small = make_content(100);
+    const auto large = make_content(1000);
+    count(small); // the automata for the lexers are built at the first time
+
+    // the buffers are reused, so the count does not depend on the size.
+    BOOST_TEST(count(large) == count(small));
+}
@@ -6,6 +6,13 @@
 #include <fstream>
 #include <iostream>
 #include <map>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 BOOST_AUTO_TEST_CASE(test_example)
 {
@@ -207,6 +214,268 @@ BOOST_AUTO_TEST_CASE(test_example_file_pointer)
     }
 }
 
+BOOST_AUTO_TEST_CASE(test_example_mapped)
+{
+    const auto data = toml::parse_mapped(testinput("example.toml"));
+
+    BOOST_TEST(toml::find<std::string>(data, "title") == "TOML Example");
+    const auto& owner = toml::find(data, "owner");
+    {
+        BOOST_TEST(toml::find<std::string>(owner, "name") == "Tom Preston-Werner");
+        BOOST_TEST(toml::find<std::string>(owner, "organization") == "GitHub");
+        BOOST_TEST(toml::find<std::string>(owner, "bio") ==
+                          "GitHub Cofounder & CEO\nLikes tater tots and beer.");
+        BOOST_TEST(toml::find<toml::offset_datetime>(owner, "dob") ==
+                          toml::offset_datetime(toml::local_date(1979, toml::month_t::May, 27),
+                                                toml::local_time(7, 32, 0), toml::time_offset(0, 0)));
+    }
+
+    const auto& servers = toml::find(data, "servers");
+    {
+        toml::table beta = toml::find<toml::table>(servers, "beta");
+        BOOST_TEST(toml::get<std::string>(beta.at("ip")) == "10.0.0.2");
+        BOOST_TEST(toml::get<std::string>(beta.at("country")) == "\xE4\xB8\xAD\xE5\x9B\xBD");
+    }
+
+    std::vector<toml::table> products =
+        toml::find<std::vector<toml::table>>(data, "products");
+    {
+        BOOST_TEST(toml::get<std::string>(products.at(1).at("name")) == "Nail");
+        BOOST_TEST(toml::get<std::int64_t>(products.at(1).at("sku")) == 284758393);
+    }
+
+    // the regions keep referring the mapped file.
+    BOOST_TEST(toml::find(owner, "dob").location().line() == 9u);
+    BOOST_TEST(toml::find(owner, "dob").location().file_name() == testinput("example.toml"));
+}
+
+BOOST_AUTO_TEST_CASE(test_mapped_file_without_newline_at_the_end_of_file)
+{
+    {
+        {
+            std::ofstream ofs("tmp_mapped.toml", std::ios_base::binary);
+            ofs << "key = \"value\"\n[table]\nkey = \"value\" # comment";
+        }
+        const auto data = toml::parse_mapped("tmp_mapped.toml");
+        BOOST_TEST(toml::find<std::string>(data, "key") == "value");
+        BOOST_TEST(toml::find<std::string>(toml::find(data, "table"), "key") == "value");
+    }
+    {
+        {
+            std::ofstream ofs("tmp_mapped.toml", std::ios_base::binary);
+            ofs << "key = \"value\"\n[table] # comment";
+        }
+        const auto data = toml::parse_mapped("tmp_mapped.toml");
+        BOOST_TEST(toml::find<std::string>(data, "key") == "value");
+        BOOST_TEST(toml::find(data, "table").as_table().empty());
+    }
+    {
+        {
+            std::ofstream ofs("tmp_mapped.toml", std::ios_base::binary);
+        }
+        const auto data = toml::parse_mapped("tmp_mapped.toml");
+        BOOST_TEST(data.as_table().empty());
+    }
+    BOOST_CHECK_THROW(toml::parse_mapped("nonexistent.toml"), std::ios_base::failure);
+}
+
+#if defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))
+BOOST_AUTO_TEST_CASE(test_mapped_fifo)
+{
+    // a FIFO reports a size of 0. it should be read until EOF, not mapped.
+    const std::string content("a = 1\n[table]\nb = \"value\" # comment\n");
+    const std::string fname("tmp_mapped_fifo.toml");
+    ::unlink(fname.c_str());
+    BOOST_REQUIRE(::mkfifo(fname.c_str(), 0600) == 0);
+
+    // the writer runs in a child process. opening a FIFO blocks until the
+    // other end is opened.
+    const auto write_fifo = [&content, &fname]() -> pid_t {
+        const pid_t pid = ::fork();
+        if(pid == 0)
+        {
+            {
+                std::ofstream ofs(fname, std::ios_base::binary);
+                ofs << content;
+            }
+            ::_exit(0);
+        }
+        return pid;
+    };
+
+    const pid_t writer1 = write_fifo();
+    BOOST_REQUIRE(writer1 > 0);
+    const auto mapped = toml::parse_mapped(fname);
+    ::waitpid(writer1, nullptr, 0);
+
+    const pid_t writer2 = write_fifo();
+    BOOST_REQUIRE(writer2 > 0);
+    const auto parsed = toml::parse(fname);
+    ::waitpid(writer2, nullptr, 0);
+
+    ::unlink(fname.c_str());
+
+    BOOST_TEST(toml::find<int>(mapped, "a") == 1);
+    BOOST_TEST(toml::find<std::string>(toml::find(mapped, "table"), "b") == "value");
+    BOOST_CHECK(mapped == parsed);
+}
+#endif
+
+BOOST_AUTO_TEST_CASE(test_parse_borrowed_buffer)
+{
+    const std::string content(
+        "key = \"value\"\n"
+        "[table]\n"
+        "key = 42 # comment"
+        );
+    {
+        const auto data = toml::parse(content.data(), content.size(), "borrowed.toml");
+        BOOST_TEST(toml::find<std::string>(data, "key") == "value");
+        BOOST_TEST(toml::find<int>(toml::find(data, "table"), "key") == 42);
+
+        // the regions point to the caller's buffer, not to a copy.
+        const auto& v = toml::find(toml::find(data, "table"), "key");
+        const auto* reg = dynamic_cast<const toml::detail::region*>(
+                toml::detail::get_region(v));
+        BOOST_TEST_REQUIRE(reg != nullptr);
+        BOOST_TEST(reg->first() == content.data() + content.find("42"));
+        BOOST_TEST(v.location().line() == 3u);
+        BOOST_TEST(v.location().file_name() == "borrowed.toml");
+    }
+    {
+        // a part of the buffer.
+        const auto data = toml::parse(content.data(), content.find('['));
+        BOOST_TEST(toml::find<std::string>(data, "key") == "value");
+        BOOST_TEST(!data.contains("table"));
+    }
+#if defined(TOML11_USING_STRING_VIEW) && TOML11_USING_STRING_VIEW>0
+    {
+        const auto data = toml::parse(std::string_view(content), "borrowed.toml");
+        BOOST_TEST(toml::find<std::string>(data, "key") == "value");
+        BOOST_TEST(toml::find<int>(toml::find(data, "table"), "key") == 42);
+    }
+#endif
+}
+
+BOOST_AUTO_TEST_CASE(test_parse_str)
+{
+    toml::value data;
+    {
+        std::string content("key = \"value\"\n[table]\nkey = 42 # comment");
+        data = toml::parse_str(std::move(content), "owned.toml");
+    }
+    // the content is owned by the values.
+    BOOST_TEST(toml::find<std::string>(data, "key") == "value");
+    BOOST_TEST(toml::find<int>(toml::find(data, "table"), "key") == 42);
+    BOOST_TEST(toml::find(toml::find(data, "table"), "key").location().line_str()
+               == "key = 42 # comment");
+
+    BOOST_CHECK_THROW(toml::parse_str("key = "), toml::syntax_error);
+}
+
+namespace
+{
+// a streambuf that cannot seek and gives only a few characters at once, like
+// the one connected to a pipe or a socket.
+struct non_seekable_buffer final : public std::streambuf
+{
+    non_seekable_buffer(std::string content, const std::size_t chunk)
+        : content_(std::move(content)), chunk_(chunk), pos_(0)
+    {}
+
+  protected:
+    int_type underflow() override
+    {
+        if(pos_ >= content_.size()) {return traits_type::eof();}
+        const auto n = (std::min)(chunk_, content_.size() - pos_);
+        char* first = &content_[pos_];
+        this->setg(first, first, first + n);
+        pos_ += n;
+        return traits_type::to_int_type(*first);
+    }
+
+  private:
+    std::string content_;
+    std::size_t chunk_;
+    std::size_t pos_;
+};
+
+// a stream that fails (e.g. a broken pipe) after some content.
+struct failing_buffer final : public std::streambuf
+{
+    explicit failing_buffer(std::string content)
+        : content_(std::move(content)), done_(false)
+    {}
+
+  protected:
+    int_type underflow() override
+    {
+        if(done_) {throw std::runtime_error("read error");}
+        done_ = true;
+        char* first = &content_[0];
+        this->setg(first, first, first + content_.size());
+        return traits_type::to_int_type(*first);
+    }
+
+  private:
+    std::string content_;
+    bool done_;
+};
+} // anonymous
+
+BOOST_AUTO_TEST_CASE(test_parse_non_seekable_stream)
+{
+    {
+        non_seekable_buffer buf("key = \"value\"\n[table]\nkey = 42 # comment", 3);
+        std::istream is(&buf);
+        BOOST_TEST(is.tellg() == std::istream::pos_type(-1));
+
+        const auto data = toml::parse(is, "pipe.toml");
+        BOOST_TEST(toml::find<std::string>(data, "key") == "value");
+        BOOST_TEST(toml::find<int>(toml::find(data, "table"), "key") == 42);
+    }
+    {
+        // larger than a chunk
+        std::string content;
+        for(std::size_t i=0; i<20000; ++i)
+        {
+            content += "key" + std::to_string(i) + " = " + std::to_string(i) + "\n";
+        }
+        non_seekable_buffer buf(content, 4096);
+        std::istream is(&buf);
+        is.exceptions(std::ios_base::failbit | std::ios_base::badbit);
+
+        const auto data = toml::parse(is, "pipe.toml");
+        BOOST_TEST(data.as_table().size() == 20000u);
+        BOOST_TEST(toml::find<int>(data, "key19999") == 19999);
+        BOOST_TEST(toml::find(data, "key19999").location().line() == 20000u);
+    }
+    {
+        // EOF does not set failbit
+        non_seekable_buffer buf("key = 42", 3);
+        std::istream is(&buf);
+        is.exceptions(std::ios_base::failbit | std::ios_base::badbit);
+
+        const auto data = toml::parse(is, "pipe.toml");
+        BOOST_TEST(toml::find<int>(data, "key") == 42);
+        BOOST_TEST(is.eof());
+        BOOST_TEST(!is.fail());
+    }
+    {
+        // a read error is not treated as EOF
+        failing_buffer buf("key = 42\n");
+        std::istream is(&buf);
+        BOOST_CHECK_THROW(toml::parse(is, "pipe.toml"), std::ios_base::failure);
+        BOOST_TEST(is.bad());
+    }
+    {
+        failing_buffer buf("key = 42\n");
+        std::istream is(&buf);
+        is.exceptions(std::ios_base::badbit);
+        BOOST_CHECK_THROW(toml::parse(is, "pipe.toml"), std::ios_base::failure);
+    }
+}
+
 BOOST_AUTO_TEST_CASE(test_fruit)
 {
     const auto data = toml::parse(testinput("fruit.toml"));
@@ -1001,6 +1270,10 @@ BOOST_AUTO_TEST_CASE(test_parse_function_compiles)
     (void) [](std::filesystem::path&& that) -> result_type { return toml::parse(that); };
 #endif
     (void) [](std::FILE* that) -> result_type { return toml::parse(that, "mandatory.toml"); };
+    (void) [](const char* that) -> result_type { return toml::parse(that, 10, "buffer.toml"); };
+#if defined(TOML11_USING_STRING_VIEW) && TOML11_USING_STRING_VIEW>0
+    (void) [](std::string_view that) -> result_type { return toml::parse(that, "buffer.toml"); };
+#endif
 }
 
 BOOST_AUTO_TEST_CASE(test_parse_nonexistent_file)
@@ -4,6 +4,10 @@
 #include "test_parse_aux.hpp"
 
 #include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <locale>
+#include <random>
 
 using namespace toml;
 using namespace detail;
@@ -177,5 +181,90 @@ BOOST_AUTO_TEST_CASE(test_overflow)
 {
     std::istringstream float_overflow (std::string("float-overflow  = 1.0e+1024"));
     BOOST_CHECK_THROW(toml::parse(float_overflow ), toml::syntax_error);
-    // istringstream >> float does not set failbit in case of underflow.
+    // underflow is not an error. it becomes a subnormal or zero.
+    TOML11_TEST_PARSE_EQUAL(parse_floating, "1e-400",  0.0);
+    TOML11_TEST_PARSE_EQUAL(parse_floating, "-1e-400", -0.0);
+    TOML11_TEST_PARSE_EQUAL(parse_floating, "4.9406564584124654e-324", 4.9406564584124654e-324);
+
+    for(const std::string str : {"1e309", "-1e309", "1.7976931348623159e308", "1e1_000"})
+    {
+        location loc("test", str);
+        BOOST_TEST(parse_floating(loc).is_err(), "input: " << str);
+        BOOST_TEST(loc.iter() == loc.begin());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_correctly_rounded)
+{
+    // the boundaries of subnormal and normal numbers.
+    TOML11_TEST_PARSE_EQUAL(parse_floating, "2.2250738585072011e-308", 2.2250738585072011e-308);
+    TOML11_TEST_PARSE_EQUAL(parse_floating, "2.2250738585072012e-308", 2.2250738585072012e-308);
+    TOML11_TEST_PARSE_EQUAL(parse_floating, "2.4703282292062328e-324", 4.9406564584124654e-324);
+    TOML11_TEST_PARSE_EQUAL(parse_floating, "2.4703282292062327e-324", 0.0);
+    TOML11_TEST_PARSE_EQUAL(parse_floating, "1.7976931348623157e308", 1.7976931348623157e308);
+    TOML11_TEST_PARSE_EQUAL(parse_floating, "1.7976931348623158e308", 1.7976931348623157e308);
+
+    // halfway between two doubles. ties to even, but any digit after the
+    // half (even the 800th) rounds up.
+    TOML11_TEST_PARSE_EQUAL(parse_floating, "9007199254740993.0", 9007199254740992.0);
+    TOML11_TEST_PARSE_EQUAL(parse_floating, "9007199254740995.0", 9007199254740996.0);
+    TOML11_TEST_PARSE_EQUAL(parse_floating,
+        "1.00000000000000011102230246251565404236316680908203125", 1.0);
+    TOML11_TEST_PARSE_EQUAL(parse_floating,
+        "1.00000000000000011102230246251565404236316680908203126", 1.0000000000000002);
+    TOML11_TEST_PARSE_EQUAL(parse_floating,
+        "1.000_000_000_000_000_111_022_302_462_515_654_042_363_166_809_082_031_25", 1.0);
+    TOML11_TEST_PARSE_EQUAL(parse_floating,
+        "1.00000000000000011102230246251565404236316680908203125" +
+        std::string(800, '0') + "1", 1.0000000000000002);
+
+    // more than 19 digits, that are dropped in the fast path.
+    TOML11_TEST_PARSE_EQUAL(parse_floating, "0.1000000000000000055511151231257827", 0.1);
+    TOML11_TEST_PARSE_EQUAL(parse_floating, "123456789012345678901234567890e-10",
+                            123456789012345678901234567890e-10);
+    TOML11_TEST_PARSE_EQUAL(parse_floating, "0.000000000000000000000000000001e30", 1.0);
+
+    // round trip of random doubles in the shortest and longer forms.
+    std::mt19937_64 rng(123456789);
+    for(std::size_t i=0; i<100000; ++i)
+    {
+        const std::uint64_t bits = rng() & 0x7FEFFFFFFFFFFFFFu; // finite
+        double expected(0.0);
+        std::memcpy(&expected, &bits, sizeof(expected));
+
+        char buf[64];
+        std::snprintf(buf, sizeof(buf), "%.*e", static_cast<int>(i % 20), expected);
+        expected = std::strtod(buf, nullptr);
+
+        location loc("test", std::string(buf));
+        const auto result = parse_floating(loc);
+        if(std::isinf(expected)) // e.g. 1.8e308 -> 2e+308
+        {
+            BOOST_TEST(result.is_err(), "input: " << buf);
+            continue;
+        }
+        BOOST_TEST_REQUIRE(result.is_ok(), "input: " << buf);
+        BOOST_TEST(result.unwrap().first == expected, "input: " << buf);
+    }
+}
+
+namespace
+{
+struct comma_numpunct : std::numpunct<char>
+{
+    char do_decimal_point() const override {return ',';}
+};
+} // anonymous
+
+BOOST_AUTO_TEST_CASE(test_locale_independent)
+{
+    // a locale that uses ',' as the decimal point does not change the result.
+    const auto original = std::locale::global(
+        std::locale(std::locale::classic(), new comma_numpunct));
+
+    TOML11_TEST_PARSE_EQUAL(parse_floating, "3.1415",   3.1415);
+    TOML11_TEST_PARSE_EQUAL(parse_floating, "-2.5e-3", -2.5e-3);
+    TOML11_TEST_PARSE_EQUAL(parse_floating, "0.1000000000000000055511151231257827", 0.1);
+
+    std::locale::global(original);
 }
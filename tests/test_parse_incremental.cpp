@@ -0,0 +1,229 @@
+#include <toml.hpp>
+#include <toml/incremental_parser.hpp>
+
+#include "unit_test.hpp"
+
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+toml::value parse_string(const std::string& content)
+{
+    std::istringstream iss(content);
+    return toml::parse(iss, "test.toml");
+}
+
+std::string replace(std::string str, const std::string& from, const std::string& to)
+{
+    const auto pos = str.find(from);
+    BOOST_TEST_REQUIRE(pos != std::string::npos);
+    return str.replace(pos, from.size(), to);
+}
+
+const std::string base(
+    "# comment for the file\n"
+    "\n"
+    "title = \"incremental\"\n"
+    "owner.name = \"foo\"\n"
+    "[a]\n"
+    "x = 1\n"
+    "y = [1, 2, 3]\n"
+    "[a.b]\n"
+    "z = \"\"\"\n"
+    "[not.a.table]\"\"\"\n"
+    "[[c]]\n"
+    "i = 1\n"
+    "[[c]]\n"
+    "i = 2\n"
+    "[d]\n"
+    "w = {p = 1, q = [1, {r = 2}]}\n"
+    "[e]\n"
+    "v = 1979-05-27T07:32:00Z\n");
+} // anonymous
+
+BOOST_AUTO_TEST_CASE(test_parse_incremental_update)
+{
+    const std::vector<std::string> contents = {
+        base,
+        replace(base, "x = 1\n", "x = 42\n"),                 // change a value
+        replace(base, "i = 2\n", "i = 2\nj = 3\n"),           // insert a line
+        replace(base, "[d]\n", "[f]\ng = 1\n[d]\n"),          // insert a section
+        replace(base, "[[c]]\ni = 1\n", ""),                  // remove a section
+        replace(base, "title", "name"),                       // change the root
+        replace(base, "# comment", "# another comment"),      // change the comment
+        replace(base, "y = [1, 2, 3]\n", "y = '''\n[d]\n'''\n"), // a fake header
+        replace(base, "z = \"\"\"\n", "z = \"\"\"\n[e]\n"),   // string gets longer
+        base + "[h]\nk = 1\n",                                // append
+        "[a]\nw = 1\n" + base.substr(base.find("[a]\n") + 4), // add a key at the top
+        "",                                                   // empty
+        base,
+    };
+
+    std::istringstream iss(base);
+    auto doc = toml::parse_incremental(iss, "test.toml");
+    BOOST_TEST(doc.value() == parse_string(base));
+    for(const auto& content : contents)
+    {
+        doc.update(content);
+        BOOST_TEST(doc.value() == parse_string(content));
+    }
+
+    // edits applied one by one
+    std::string content = base;
+    std::istringstream iss2(base);
+    auto doc2 = toml::parse_incremental(iss2, "test.toml");
+    for(std::size_t i=0; i<10; ++i)
+    {
+        content = replace(content, "[d]\n", "[d]\nk" + std::to_string(i) + " = 1\n");
+        content = replace(content, "[a]\n", "[a]\nk" + std::to_string(i) + " = 1\n");
+        doc2.update(content);
+        BOOST_TEST(doc2.value() == parse_string(content));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_parse_incremental_changed_ranges)
+{
+    std::istringstream iss(base);
+    auto doc = toml::parse_incremental(iss, "test.toml");
+
+    const std::string from("x = 1");
+    const auto pos = base.find(from);
+    const std::string content = replace(base, from, "x = 12345");
+    doc.update(content, {{pos, pos + 9}});
+    BOOST_TEST(doc.value() == parse_string(content));
+    BOOST_TEST(toml::find<int>(doc.value(), "a", "x") == 12345);
+
+    // no change
+    doc.update(content, {});
+    BOOST_TEST(doc.value() == parse_string(content));
+}
+
+BOOST_AUTO_TEST_CASE(test_parse_incremental_regions)
+{
+    // the sources that the regions in a value refer to.
+    struct collector
+    {
+        void operator()(const toml::value& v)
+        {
+            if(const auto reg = dynamic_cast<const toml::detail::region*>(
+                        toml::detail::get_region(v)))
+            {
+                sources.insert(reg->source().get());
+            }
+            if(v.is_array()) {for(const auto& e  : v.as_array()) {(*this)(e);}}
+            if(v.is_table()) {for(const auto& kv : v.as_table()) {(*this)(kv.second);}}
+        }
+        std::set<const toml::detail::source_base*> sources;
+    };
+    const auto type_error_of = [](const toml::value& v) -> std::string {
+        try {toml::find<std::string>(v, "e", "v");}
+        catch(const toml::type_error& e) {return e.what();}
+        return "";
+    };
+
+    std::istringstream iss(base);
+    auto doc = toml::parse_incremental(iss, "test.toml");
+    std::string content = base;
+    for(std::size_t i=0; i<10; ++i)
+    {
+        // the sections before [a] and after [a.b] are reused
+        content = replace(content, "[a]\n", "[a]\nk" + std::to_string(i) + " = 1\n");
+        doc.update(content);
+
+        // the previous contents are not referred to
+        collector c;
+        c(doc.value());
+        BOOST_TEST(c.sources.size() == 1u);
+
+        // the line number of [e] is updated
+        const auto expected = type_error_of(parse_string(content));
+        BOOST_TEST(!expected.empty());
+        BOOST_TEST(type_error_of(doc.value()) == expected);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_parse_incremental_header_comments)
+{
+    // the comments above a header that is reused from the unchanged part.
+    using value_type = toml::basic_value<toml::preserve_comments>;
+    const std::string content(
+        "a = 1\n"
+        "[s]\n"
+        "k = 1\n"
+        "# old comment\n"
+        "[t]\n"
+        "k = 2\n"
+        "[u]\n"
+        "k = 3\n");
+    const auto parse_preserved = [](const std::string& str) {
+        std::istringstream iss(str);
+        return toml::parse<toml::preserve_comments>(iss, "test.toml");
+    };
+
+    std::istringstream iss(content);
+    auto doc = toml::parse_incremental<toml::preserve_comments>(iss, "test.toml");
+    BOOST_TEST(doc.value() == parse_preserved(content));
+
+    for(const auto& updated : {
+            replace(content, "# old comment", "# new comment"),
+            replace(content, "# old comment\n", ""),
+            replace(content, "# old comment\n", "# old comment\n# more\n"),
+            replace(content, "k = 1\n", "k = 1\n# above\n"),
+            replace(content, "k = 1\n", "k = 1 # inline\n")
+        })
+    {
+        doc.update(updated);
+        BOOST_TEST(doc.value() == parse_preserved(updated));
+        const value_type& t = doc.value().at("t");
+        BOOST_TEST(t.comments() == parse_preserved(updated).at("t").comments());
+        doc.update(content);
+        BOOST_TEST(doc.value() == parse_preserved(content));
+    }
+
+    doc.update(replace(content, "# old comment", "# new comment"));
+    BOOST_TEST(doc.value().at("t").comments().size() == 1u);
+    BOOST_TEST(doc.value().at("t").comments().front() == " new comment");
+}
+
+BOOST_AUTO_TEST_CASE(test_parse_incremental_errors)
+{
+    std::istringstream iss(base);
+    auto doc = toml::parse_incremental(iss, "test.toml");
+
+    const std::vector<std::string> invalid = {
+        replace(base, "x = 1\n", "x = 1 2\n"),    // syntax error
+        replace(base, "[d]\n", "[a]\n"),          // table defined twice
+        replace(base, "[[c]]\ni = 1\n", "[[c]]\ni = 1\ni = 2\n"), // key defined twice
+        replace(base, "[e]\n", "[e\n"),           // invalid header
+    };
+    for(const auto& content : invalid)
+    {
+        std::string expected;
+        try
+        {
+            parse_string(content);
+        }
+        catch(const toml::syntax_error& e)
+        {
+            expected = e.what();
+        }
+        BOOST_TEST(!expected.empty());
+
+        std::string actual;
+        try
+        {
+            doc.update(content);
+        }
+        catch(const toml::syntax_error& e)
+        {
+            actual = e.what();
+        }
+        BOOST_TEST(actual == expected);
+
+        // the document is not modified
+        BOOST_TEST(doc.value() == parse_string(base));
+    }
+}
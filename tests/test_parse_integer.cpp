@@ -114,3 +114,40 @@ BOOST_AUTO_TEST_CASE(test_integer_overflow)
     BOOST_CHECK_THROW(toml::parse(oct_overflow), toml::syntax_error);
     BOOST_CHECK_THROW(toml::parse(bin_overflow), toml::syntax_error);
 }
+
+BOOST_AUTO_TEST_CASE(test_integer_bad_prefix)
+{
+    const auto error_of = [](const std::string& str) -> std::string {
+        std::istringstream iss(str);
+        try {toml::parse(iss);} catch(const toml::syntax_error& e) {return e.what();}
+        return "";
+    };
+    const auto hex = error_of("a = 0xg1\n");
+    BOOST_TEST(hex.find("toml::parse_hexadecimal_integer") != std::string::npos, hex);
+    BOOST_TEST(hex.find("the next token is not an integer") != std::string::npos, hex);
+
+    const auto unknown = error_of("a = 0n12\n");
+    BOOST_TEST(unknown.find("unknown integer prefix appeared") != std::string::npos, unknown);
+    BOOST_TEST(unknown.find("none of 0x, 0o, 0b") != std::string::npos, unknown);
+}
+
+BOOST_AUTO_TEST_CASE(test_integer_limits)
+{
+    TOML11_TEST_PARSE_EQUAL(parse_integer,  "9223372036854775807", (std::numeric_limits<toml::integer>::max)());
+    TOML11_TEST_PARSE_EQUAL(parse_integer, "-9223372036854775808", (std::numeric_limits<toml::integer>::min)());
+    TOML11_TEST_PARSE_EQUAL(parse_integer, "-9_223_372_036_854_775_807", -(std::numeric_limits<toml::integer>::max)());
+    TOML11_TEST_PARSE_EQUAL(parse_integer, "0x7FFF_FFFF_FFFF_FFFF", (std::numeric_limits<toml::integer>::max)());
+    TOML11_TEST_PARSE_EQUAL(parse_integer, "0o777_777_777_777_777_777_777", (std::numeric_limits<toml::integer>::max)());
+    TOML11_TEST_PARSE_EQUAL(parse_integer, "-0", 0);
+
+    for(const auto& str : std::vector<std::string>{
+            "-9223372036854775809", "18446744073709551616", "99999999999999999999",
+            "0x8000000000000000", "0o1000000000000000000000"})
+    {
+        location loc("test", str);
+        const auto result = parse_integer(loc);
+        BOOST_TEST_REQUIRE(result.is_err(), "input: " << str);
+        BOOST_TEST(result.unwrap_err().find("out of range") != std::string::npos);
+        BOOST_TEST(loc.iter() == loc.begin());
+    }
+}
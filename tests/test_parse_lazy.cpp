@@ -0,0 +1,84 @@
+#include <toml.hpp>
+
+#include "unit_test.hpp"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+BOOST_AUTO_TEST_CASE(test_parse_lazy_example)
+{
+    const auto data = toml::parse(testinput("example.toml"));
+    const auto lazy = toml::parse_lazy(testinput("example.toml"));
+
+    for(const auto& kv : data.as_table())
+    {
+        BOOST_TEST(lazy.contains(kv.first));
+        BOOST_TEST(lazy.at(kv.first) == kv.second);
+    }
+    BOOST_TEST(!lazy.contains("nonexistent"));
+    BOOST_CHECK_THROW(lazy.at("nonexistent"), std::out_of_range);
+
+    BOOST_TEST(toml::find<std::string>(lazy, "title") == "TOML Example");
+    BOOST_TEST(toml::find<std::string>(lazy, "owner", "name") == "Tom Preston-Werner");
+    BOOST_TEST(toml::find(lazy, "database", "ports").as_array().size() == 3u);
+    BOOST_TEST(toml::find(lazy, "servers").is_table());
+}
+
+BOOST_AUTO_TEST_CASE(test_parse_lazy_headers_in_values)
+{
+    // lines that start with `[` in multi-line arrays and strings are not
+    // table headers.
+    const std::string content(
+        "a.b = 1\n"
+        "c = [\n"
+        "[1, 2],\n"
+        "[3, 4], # ]\n"
+        "]\n"
+        "d = \"\"\"\n"
+        "[not.a.table]\n"
+        "\"\"\"\n"
+        "e = '''\n"
+        "[[not.an.array.of.tables]]'''\n"
+        "[a.f]\n"
+        "g = \"[x]\" # [y]\n"
+        "[[h]]\n"
+        "i = 1\n"
+        "[[h]]\n"
+        "i = 2\n"
+        "[a.j]\n"
+        "k = {l = [1, {m = 2}]}\n");
+
+    std::istringstream iss1(content);
+    const auto data = toml::parse(iss1, "test.toml");
+    std::istringstream iss2(content);
+    const auto lazy = toml::parse_lazy(iss2, "test.toml");
+
+    BOOST_TEST(data.as_table().size() == 5u);
+    for(const auto& kv : data.as_table())
+    {
+        BOOST_TEST(lazy.at(kv.first) == kv.second);
+    }
+    BOOST_TEST(toml::find<int>(lazy, "a", "b") == 1);
+    BOOST_TEST(toml::find<std::string>(lazy, "a", "f", "g") == "[x]");
+    BOOST_TEST(toml::find<std::string>(lazy, "d") == "[not.a.table]\n");
+    BOOST_TEST(toml::find(lazy, "h").as_array().size() == 2u);
+}
+
+BOOST_AUTO_TEST_CASE(test_parse_lazy_error_on_access)
+{
+    const std::string content(
+        "[a]\n"
+        "b = 1\n"
+        "[c]\n"
+        "d = 1 2\n"
+        "[a]\n"
+        "e = 2\n");
+    std::istringstream iss(content);
+    const auto lazy = toml::parse_lazy(iss);
+
+    // the syntax error in [c] does not matter until [c] is accessed
+    BOOST_CHECK_THROW(lazy.at("c"), toml::syntax_error);
+    // [a] is defined twice
+    BOOST_CHECK_THROW(lazy.at("a"), toml::syntax_error);
+}
@@ -0,0 +1,105 @@
+#include <toml.hpp>
+
+#include "unit_test.hpp"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+BOOST_AUTO_TEST_CASE(test_parse_only)
+{
+    const std::string content(
+        "title = \"example\"\n"
+        "owner.name = \"foo\"\n"
+        "misc = [\n"
+        "[1, \"]\"],\n"
+        "{a = '[b]'}, # [c]\n"
+        "]\n"
+        "[db]\n"
+        "name = \"\"\"\n"
+        "[db.pool]\n"
+        "\"\"\"\n"
+        "replica.port = 5432\n"
+        "[db.pool]\n"
+        "min = 1\n"
+        "max = 10\n"
+        "[db.pool.options]\n"
+        "timeout = 30\n"
+        "[server]\n"
+        "host = \"localhost\"\n"
+        "port = 8080\n"
+        "[[server.routes]]\n"
+        "path = \"/\"\n"
+        "[[server.routes]]\n"
+        "path = \"/api\"\n"
+        "[[logs]]\n"
+        "level = \"info\"\n");
+
+    std::istringstream iss(content);
+    const auto data = toml::parse_only(iss, {"server", "db.pool"}, "test.toml");
+
+    BOOST_TEST(data.as_table().size() == 2u);
+    BOOST_TEST(toml::find<std::string>(data, "server", "host") == "localhost");
+    BOOST_TEST(toml::find<int>(data, "server", "port") == 8080);
+    BOOST_TEST(toml::find(data, "server", "routes").as_array().size() == 2u);
+
+    const auto& db = toml::find(data, "db");
+    BOOST_TEST(db.as_table().size() == 1u);
+    BOOST_TEST(toml::find<int>(db, "pool", "min") == 1);
+    BOOST_TEST(toml::find<int>(db, "pool", "max") == 10);
+
+    // the result is the same as the corresponding part of toml::parse
+    std::istringstream iss2(content);
+    const auto full = toml::parse(iss2, "test.toml");
+    BOOST_TEST(toml::find(data, "server") == toml::find(full, "server"));
+    BOOST_TEST(toml::find(data, "db", "pool") == toml::find(full, "db", "pool"));
+}
+
+BOOST_AUTO_TEST_CASE(test_parse_only_partial_inline_table)
+{
+    std::istringstream iss(
+        "a = {b = {c = 1, d = 2}, e = 3}\n"
+        "f = [{b = 1, g = 2}, {b = 3}]\n");
+    const auto data = toml::parse_only(iss, {"a.b.c", "f.b"});
+
+    BOOST_TEST(toml::find(data, "a").as_table().size() == 1u);
+    BOOST_TEST(toml::find(data, "a", "b").as_table().size() == 1u);
+    BOOST_TEST(toml::find<int>(data, "a", "b", "c") == 1);
+    BOOST_TEST(toml::find(data, "f", 0).as_table().size() == 1u);
+    BOOST_TEST(toml::find<int>(data, "f", 1, "b") == 3);
+}
+
+BOOST_AUTO_TEST_CASE(test_parse_only_errors)
+{
+    {
+        // a syntax error in the selected part is reported
+        std::istringstream iss("[a]\nb = 1 2\n");
+        BOOST_CHECK_THROW(toml::parse_only(iss, {"a"}), toml::syntax_error);
+    }
+    {
+        // ... but not in the skipped part
+        std::istringstream iss("[a]\nb = 1 2\n[c]\nd = 1\n");
+        const auto data = toml::parse_only(iss, {"c"});
+        BOOST_TEST(toml::find<int>(data, "c", "d") == 1);
+    }
+    {
+        std::istringstream iss("a = 1\n");
+        BOOST_CHECK_THROW(toml::parse_only(iss, {"a..b"}), toml::syntax_error);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_parse_only_file_comments)
+{
+    const std::string content("# top\n\na = [1,2]\nb = 3\n");
+
+    std::istringstream iss(content);
+    const auto data = toml::parse_only<toml::preserve_comments>(iss, {"b"}, "test.toml");
+
+    std::istringstream iss2(content);
+    const auto full = toml::parse<toml::preserve_comments>(iss2, "test.toml");
+
+    BOOST_TEST(data.comments().size() == 1u);
+    BOOST_TEST(data.comments().at(0) == " top");
+    BOOST_TEST(data.comments() == full.comments());
+    BOOST_TEST(toml::find<int>(data, "b") == 3);
+}
@@ -0,0 +1,153 @@
+#include <toml.hpp>
+#include <toml/parallel_parser.hpp>
+
+#include "unit_test.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+std::string generate_document(const std::size_t n)
+{
+    std::ostringstream oss;
+    oss << "# comment for the file\n\n";
+    oss << "title = \"parallel\"\n";
+    oss << "root.dotted = 42\n";
+    for(std::size_t i=0; i<n; ++i)
+    {
+        oss << "[table" << i << "]\n";
+        oss << "int = " << i << "\n";
+        oss << "str = \"\"\"\n[table" << i << "]\n\"\"\"\n";
+        oss << "arr = [\n[1, 2],\n[3, 4],\n]\n";
+        oss << "[table" << i << ".sub]\n";
+        oss << "inline = {a = '[b]', c = [1, {d = 2}]}\n";
+        oss << "[[aot]]\n";
+        oss << "index = " << i << "\n";
+        oss << "[[aot.nested]]\n";
+        oss << "x = " << i * 2 << "\n";
+    }
+    return oss.str();
+}
+} // anonymous
+
+BOOST_AUTO_TEST_CASE(test_parse_parallel_example)
+{
+    const auto data = toml::parse(testinput("example.toml"));
+    for(const std::size_t n : {1u, 2u, 4u, 16u})
+    {
+        BOOST_TEST(toml::parse_parallel(testinput("example.toml"), n) == data);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_parse_parallel_many_tables)
+{
+    const std::string content = generate_document(100);
+    std::istringstream iss(content);
+    const auto data = toml::parse(iss, "test.toml");
+
+    for(const std::size_t n : {0u, 1u, 3u, 8u})
+    {
+        std::istringstream iss2(content);
+        const auto par = toml::parse_parallel(iss2, n, "test.toml");
+        BOOST_TEST(par == data);
+        BOOST_TEST(toml::find(par, "aot").as_array().size() == 100u);
+        BOOST_TEST(toml::find<int>(par, "aot", 99, "nested", 0, "x") == 198);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_parse_parallel_errors)
+{
+    // the error messages are the same as toml::parse
+    const std::string generated = generate_document(20);
+    const std::string contents[] = {
+        // a table is defined twice in different chunks
+        generated + "[table3]\nint = 3\n",
+        // a syntax error in the last chunk
+        generated + "[last]\na = 1 2\n",
+        // a syntax error in the first chunk
+        "[a]\nb = 1 2\n" + generated,
+        // an invalid header
+        generated + "[a.\nb = 1\n",
+        // an unclosed multi-line string hides the rest
+        "[a]\nb = \"\"\"\n" + generated,
+        // the root table throws while the workers are running
+        "a = {b = 1,}\n[x]\nk=1\n[y]\nk=2\n[z]\nk=3\n",
+        "title = 1 2\n" + generated,
+    };
+    for(const auto& content : contents)
+    {
+        std::string expected;
+        try
+        {
+            std::istringstream iss(content);
+            toml::parse(iss, "test.toml");
+        }
+        catch(const toml::syntax_error& err)
+        {
+            expected = err.what();
+        }
+        BOOST_TEST(!expected.empty());
+
+        std::string actual;
+        try
+        {
+            std::istringstream iss(content);
+            toml::parse_parallel(iss, 4, "test.toml");
+        }
+        catch(const toml::syntax_error& err)
+        {
+            actual = err.what();
+        }
+        BOOST_TEST(actual == expected);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_parse_many)
+{
+    std::vector<std::string> paths;
+    for(std::size_t i=0; i<20; ++i)
+    {
+        const std::string fname = "tmp_parse_many_" + std::to_string(i) + ".toml";
+        std::ofstream ofs(fname);
+        if(i == 7)
+        {
+            ofs << "a = 1 2\n"; // syntax error
+        }
+        else
+        {
+            ofs << "index = " << i << "\n[table]\nkey = \"value\"\n";
+        }
+        paths.push_back(fname);
+    }
+    paths.push_back("nonexistent.toml");
+    paths.push_back(testinput("example.toml"));
+
+    toml::parse_many_options options;
+    options.num_threads = 4;
+    const auto results = toml::parse_many(paths, options);
+
+    BOOST_TEST_REQUIRE(results.size() == paths.size());
+    for(std::size_t i=0; i<20; ++i)
+    {
+        if(i == 7)
+        {
+            BOOST_TEST_REQUIRE(results.at(i).is_err());
+            BOOST_TEST(results.at(i).as_err().find("tmp_parse_many_7.toml") != std::string::npos);
+            continue;
+        }
+        BOOST_TEST_REQUIRE(results.at(i).is_ok());
+        BOOST_TEST(toml::find<std::size_t>(results.at(i).as_ok(), "index") == i);
+    }
+    BOOST_TEST(results.at(20).is_err());
+    BOOST_TEST_REQUIRE(results.at(21).is_ok());
+    BOOST_TEST(results.at(21).as_ok() == toml::parse(testinput("example.toml")));
+
+    // with the default options
+    const auto results2 = toml::parse_many(paths);
+    BOOST_TEST_REQUIRE(results2.size() == paths.size());
+    BOOST_TEST(results2.at(0).as_ok() == results.at(0).as_ok());
+    BOOST_TEST(toml::parse_many({}).empty());
+}
@@ -3,6 +3,9 @@
 #include "unit_test.hpp"
 #include "test_parse_aux.hpp"
 
+#include <string>
+#include <vector>
+
 using namespace toml;
 using namespace detail;
 
@@ -243,3 +246,65 @@ BOOST_AUTO_TEST_CASE(test_unicode_escape_sequence)
             string("𝞪", string_t::basic));
 #endif
 }
+
+BOOST_AUTO_TEST_CASE(test_long_strings)
+{
+    // long enough to be scanned by SIMD kernels, with special characters at
+    // various positions
+    const std::string text("The quick brown fox jumps over the lazy dog. "
+                           "\xE3\x81\x84\xE3\x82\x8D\xE3\x81\xAF\xE3\x81\xAB");
+    for(std::size_t i=0; i<45; i+=4) // not to split a UTF-8 character
+    {
+        const std::string head = text.substr(0, i);
+        const std::string tail = text.substr(i);
+
+        TOML11_TEST_PARSE_EQUAL(parse_string,
+            "\"" + text + head + "\\t\\\"\\u00E9" + tail + "\"",
+            string(text + head + "\t\"\xC3\xA9" + tail, string_t::basic));
+        TOML11_TEST_PARSE_EQUAL(parse_string,
+            "\"\"\"\n" + text + head + "\"\n\r\n\\\n   \"\"" + tail + "\"\"\"\"",
+            string(text + head + "\"\n\r\n\"\"" + tail + "\"", string_t::basic));
+        TOML11_TEST_PARSE_EQUAL(parse_string,
+            "'" + text + head + "\\\"" + tail + "'",
+            string(text + head + "\\\"" + tail, string_t::literal));
+        TOML11_TEST_PARSE_EQUAL(parse_string,
+            "'''" + text + head + "'\n''" + tail + "''''",
+            string(text + head + "'\n''" + tail + "'", string_t::literal));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_long_strings_invalid)
+{
+    const std::string text(40, 'a');
+    const std::vector<std::string> invalid = {
+        "\"" + text + "\x01" + text + "\"",
+        "\"" + text + "\n" + text + "\"",
+        "'" + text + "\x7F" + text + "'",
+        "\"\"\"" + text + "\x1F" + text + "\"\"\"",
+        "'''" + text + "\x08" + text + "'''",
+    };
+    for(const auto& token : invalid)
+    {
+        toml::detail::location loc("test", token);
+        BOOST_TEST(parse_string(loc).is_err());
+    }
+
+    // the position of an invalid UTF-8 sequence
+    for(const auto& quote : std::vector<std::string>{"\"", "'", "\"\"\"", "'''"})
+    {
+        toml::detail::location loc("test", quote + text + "\xE3\x81" + text + quote);
+        std::string msg;
+        std::size_t column = 0;
+        try
+        {
+            parse_string(loc);
+        }
+        catch(const toml::syntax_error& e)
+        {
+            msg    = e.what();
+            column = e.location().column();
+        }
+        BOOST_TEST(msg.find("invalid utf8 sequence found") != std::string::npos);
+        BOOST_TEST(column == quote.size() + text.size() + 1);
+    }
+}
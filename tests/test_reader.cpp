@@ -0,0 +1,189 @@
+#include <toml.hpp>
+
+#include "unit_test.hpp"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+BOOST_AUTO_TEST_CASE(test_reader_tokens)
+{
+    const std::string content(
+        "a.b = 42 # comment\n"
+        "[c]\n"
+        "d = [\"foo\", {e = 3.14}]\n"
+        "[[f]]\n"
+        "g = 1979-05-27\n");
+    toml::reader r(content.data(), content.size());
+
+    BOOST_TEST(r.next() == toml::token_t::key);
+    BOOST_TEST(r.keys() == (std::vector<toml::key>{"a", "b"}), boost::test_tools::per_element());
+    BOOST_TEST(r.next() == toml::token_t::value);
+    BOOST_TEST(r.type() == toml::value_t::integer);
+    BOOST_TEST(r.as_integer() == 42);
+
+    BOOST_TEST(r.next() == toml::token_t::table_header);
+    BOOST_TEST(r.keys() == (std::vector<toml::key>{"c"}), boost::test_tools::per_element());
+
+    BOOST_TEST(r.next() == toml::token_t::key);
+    BOOST_TEST(r.next() == toml::token_t::array_begin);
+    BOOST_TEST(r.type() == toml::value_t::array);
+    BOOST_TEST(r.next() == toml::token_t::value);
+    BOOST_TEST(r.as_string().str == "foo");
+    BOOST_TEST(r.next() == toml::token_t::inline_table_begin);
+    BOOST_TEST(r.next() == toml::token_t::key);
+    BOOST_TEST(r.keys() == (std::vector<toml::key>{"e"}), boost::test_tools::per_element());
+    BOOST_TEST(r.next() == toml::token_t::value);
+    BOOST_TEST(r.as_floating() == 3.14);
+    BOOST_TEST(r.next() == toml::token_t::inline_table_end);
+    BOOST_TEST(r.next() == toml::token_t::array_end);
+
+    BOOST_TEST(r.next() == toml::token_t::array_table_header);
+    BOOST_TEST(r.keys() == (std::vector<toml::key>{"f"}), boost::test_tools::per_element());
+    BOOST_TEST(r.next() == toml::token_t::key);
+    BOOST_TEST(r.next() == toml::token_t::value);
+    BOOST_TEST(r.as_local_date() == toml::local_date(1979, toml::month_t::May, 27));
+    BOOST_TEST(r.location().line() == 5u);
+
+    BOOST_TEST(r.next() == toml::token_t::end_of_file);
+    BOOST_TEST(r.next() == toml::token_t::end_of_file);
+}
+
+BOOST_AUTO_TEST_CASE(test_reader_keys_and_strings)
+{
+    const std::string content(
+        "a . \"b c\" . 'd' = \"e\"\n"
+        "\"f\\tg\" = 'h\\i'\n"
+        "j = \"k\\nl\"\n"
+        "\"\" = ''\n");
+    toml::reader r(content.data(), content.size());
+
+    BOOST_TEST(r.next() == toml::token_t::key);
+    BOOST_TEST(r.keys() == (std::vector<toml::key>{"a", "b c", "d"}), boost::test_tools::per_element());
+    BOOST_TEST(r.next() == toml::token_t::value);
+    BOOST_TEST(r.as_string().str == "e");
+    BOOST_CHECK(r.as_string().kind == toml::string_t::basic);
+
+    // the keys with escape sequences
+    BOOST_TEST(r.next() == toml::token_t::key);
+    BOOST_TEST(r.keys() == (std::vector<toml::key>{"f\tg"}), boost::test_tools::per_element());
+    BOOST_TEST(r.next() == toml::token_t::value);
+    BOOST_TEST(r.as_string().str == "h\\i");
+    BOOST_CHECK(r.as_string().kind == toml::string_t::literal);
+
+    BOOST_TEST(r.next() == toml::token_t::key);
+    BOOST_TEST(r.keys() == (std::vector<toml::key>{"j"}), boost::test_tools::per_element());
+    BOOST_TEST(r.next() == toml::token_t::value);
+    BOOST_TEST(r.as_string().str == "k\nl");
+
+    BOOST_TEST(r.next() == toml::token_t::key);
+    BOOST_TEST(r.keys() == (std::vector<toml::key>{""}), boost::test_tools::per_element());
+    BOOST_TEST(r.next() == toml::token_t::value);
+    BOOST_TEST(r.as_string().str == "");
+    BOOST_TEST(r.next() == toml::token_t::end_of_file);
+}
+
+BOOST_AUTO_TEST_CASE(test_reader_type_error)
+{
+    std::istringstream iss("a = 42\n");
+    toml::reader r(iss);
+    BOOST_TEST(r.next() == toml::token_t::key);
+    BOOST_CHECK_THROW(r.as_integer(), toml::type_error);
+    BOOST_TEST(r.next() == toml::token_t::value);
+    BOOST_CHECK_THROW(r.as_string(), toml::type_error);
+    BOOST_TEST(r.as_integer() == 42);
+}
+
+BOOST_AUTO_TEST_CASE(test_reader_skip)
+{
+    const std::string content(
+        "a = [1, [2, {b = [3]}], \"]\"]\n"
+        "c = {d = {e = '}'}}\n"
+        "[f]\n"
+        "g = 99999999999999999999 # overflows, but not converted\n"
+        "h = [\n"
+        "  [1],\n"
+        "]\n"
+        "[i]\n"
+        "j = true\n");
+    toml::reader r(content.data(), content.size());
+
+    BOOST_TEST(r.next() == toml::token_t::key);
+    r.skip();
+    BOOST_TEST(r.kind() == toml::token_t::array_end);
+
+    BOOST_TEST(r.next() == toml::token_t::key);
+    BOOST_TEST(r.next() == toml::token_t::inline_table_begin);
+    r.skip();
+    BOOST_TEST(r.kind() == toml::token_t::inline_table_end);
+
+    BOOST_TEST(r.next() == toml::token_t::table_header);
+    r.skip();
+
+    BOOST_TEST(r.next() == toml::token_t::table_header);
+    BOOST_TEST(r.keys() == (std::vector<toml::key>{"i"}), boost::test_tools::per_element());
+    BOOST_TEST(r.next() == toml::token_t::key);
+    BOOST_TEST(r.next() == toml::token_t::value);
+    BOOST_TEST(r.as_boolean() == true);
+    BOOST_TEST(r.next() == toml::token_t::end_of_file);
+}
+
+BOOST_AUTO_TEST_CASE(test_reader_same_error_as_parse)
+{
+    const std::vector<std::string> invalids{
+        "a = ",
+        "a = # comment\n",
+        "a = 1 b = 2\n",
+        "= 1\n",
+        "a b = 1\n",
+        "a = \"foo\nb = 3\n",
+        "a = [1, 2",
+        "a = [1, 2,",
+        "a = [1 2]\n",
+        "a = [1, foo]\n",
+        "a = [1, {b = foo}]\n",
+        "a = [{b = {c = foo}}]\n",
+        "a = {b = 1,}\n",
+        "a = {b = 1 c = 2}\n",
+        "a = {b = 1\n",
+        "a = {b = }\n",
+        "a = {b = foo}\n",
+        "a = {b = 1,",
+        "a = 1979-13-27\n",
+        "[a] b = 1\n",
+        "[[a]] b = 1\n",
+        "a = 0x\n",
+        "a = 0xg1\n",
+        "a = 9223372036854775808\n",
+        "a = 1e999\n",
+        "a = 1979-02-30\n",
+        "a. = 1\n",
+        "a.\"b\\q\" = 1\n",
+        "a.'b = 1\n",
+        "a = \"b\\q\"\n",
+        "a = 'b\n",
+        "\"\" 1\n",
+        "a = 0n12\n",
+    };
+    for(const auto& content : invalids)
+    {
+        std::string expected, actual;
+        try
+        {
+            std::istringstream iss(content);
+            toml::parse(iss, "test.toml");
+        }
+        catch(const toml::syntax_error& e) {expected = e.what();}
+        try
+        {
+            std::istringstream iss(content);
+            toml::reader r(iss, "test.toml");
+            while(r.next() != toml::token_t::end_of_file) {}
+        }
+        catch(const toml::syntax_error& e) {actual = e.what();}
+
+        BOOST_TEST_MESSAGE(content);
+        BOOST_TEST(!expected.empty());
+        BOOST_TEST(actual == expected);
+    }
+}
@@ -0,0 +1,108 @@
+#include <toml.hpp>
+#include <toml/watched_document.hpp>
+
+#include "unit_test.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+
+namespace
+{
+// waits until the document is reloaded, or a few seconds pass.
+template<typename Document>
+bool wait_for_version(const Document& doc, const std::size_t version)
+{
+    for(int i=0; i<500; ++i)
+    {
+        if(version <= doc.version()) {return true;}
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return false;
+}
+
+template<typename Document>
+bool wait_for_error(const Document& doc)
+{
+    for(int i=0; i<500; ++i)
+    {
+        if(!doc.last_error().empty()) {return true;}
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return false;
+}
+} // anonymous
+
+BOOST_AUTO_TEST_CASE(test_watched_document)
+{
+    const std::string fname("tmp_watched.toml");
+    {
+        std::ofstream ofs(fname);
+        ofs << "a = 1\n[b]\nc = \"foo\"\n";
+    }
+
+    toml::watched_document<> doc(fname);
+    const auto first = doc.get();
+    BOOST_TEST(doc.version() == 0u);
+    BOOST_TEST(toml::find<int>(*first, "a") == 1);
+
+    // overwrite the file
+    {
+        std::ofstream ofs(fname);
+        ofs << "a = 2\n[b]\nc = \"foo\"\n";
+    }
+    BOOST_TEST_REQUIRE(wait_for_version(doc, 1));
+    BOOST_TEST(toml::find<int>(*doc.get(), "a") == 2);
+    BOOST_TEST(doc.last_error().empty());
+    // the previous snapshot is still alive
+    BOOST_TEST(toml::find<int>(*first, "a") == 1);
+
+    // replace the file by rename, as editors do
+    {
+        std::ofstream ofs("tmp_watched.toml.new");
+        ofs << "a = 3\n[b]\nc = \"bar\"\n";
+    }
+    BOOST_TEST_REQUIRE(std::rename("tmp_watched.toml.new", fname.c_str()) == 0);
+    BOOST_TEST_REQUIRE(wait_for_version(doc, 2));
+    BOOST_TEST(toml::find<int>(*doc.get(), "a") == 3);
+    BOOST_TEST(toml::find<std::string>(*doc.get(), "b", "c") == "bar");
+
+    // a syntax error does not replace the value
+    const auto version = doc.version();
+    {
+        std::ofstream ofs(fname);
+        ofs << "a = 4 5\n";
+    }
+    BOOST_TEST_REQUIRE(wait_for_error(doc));
+    BOOST_TEST(doc.version() == version);
+    BOOST_TEST(toml::find<int>(*doc.get(), "a") == 3);
+
+    // writes to the other files in the directory are ignored
+    {
+        std::ofstream ofs("tmp_watched_other.toml");
+        ofs << "a = 5\n";
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    BOOST_TEST(doc.version() == version);
+}
+
+BOOST_AUTO_TEST_CASE(test_watched_document_write_after_construction)
+{
+    const std::string fname("tmp_watched_early.toml");
+    {
+        std::ofstream ofs(fname);
+        ofs << "a = 1\n";
+    }
+
+    // the directory is watched before the first parse, so a write made right
+    // after (or during) the construction is not missed.
+    toml::watched_document<> doc(fname);
+    {
+        std::ofstream ofs(fname);
+        ofs << "a = 2\n";
+    }
+    BOOST_TEST_REQUIRE(wait_for_version(doc, 1));
+    BOOST_TEST(toml::find<int>(*doc.get(), "a") == 2);
+}
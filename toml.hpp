@@ -30,6 +30,13 @@
 #define TOML11_VERSION_PATCH 1
 
 #include "toml/parser.hpp"
+#include "toml/reader.hpp"
+#include "toml/event_parser.hpp"
+#include "toml/lazy_document.hpp"
+#include "toml/selective_parser.hpp"
+#include "toml/binary.hpp"
+#include "toml/flat_document.hpp"
+#include "toml/parse_cache.hpp"
 #include "toml/literal.hpp"
 #include "toml/serializer.hpp"
 #include "toml/get.hpp"
@@ -0,0 +1,609 @@
+//     Copyright Toru Niina 2017.
+// Distributed under the MIT License.
+#ifndef TOML11_BINARY_HPP
+#define TOML11_BINARY_HPP
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "exception.hpp"
+#include "mapped_file.hpp"
+#include "parser.hpp"
+#include "value.hpp"
+
+namespace toml
+{
+
+// A compact binary encoding of a basic_value, to skip lexing of a file that
+// has not been changed since the last time it was parsed.
+//
+// layout (all the integers are little endian):
+//
+// ```
+// file    := magic(8 bytes) version(u32) flags(u32) [sources] value
+// sources := count(varint) {name(str) content(str)}*      -- if has_regions
+// value   := type(u8) comments [region] body
+// comments:= count(varint) {str}*
+// region  := source(varint, 1-based. 0 if none) first(varint) size(varint)
+// str     := length(varint) bytes
+// body    := boolean(u8) | integer(zigzag varint) | floating(u64) |
+//            kind(u8) str | date time offset | date time | date | time |
+//            count(varint) {value}* | count(varint) {str value}*
+// date    := year(zigzag varint) month(u8) day(u8)
+// time    := hour(u8) minute(u8) second(u8) ms(varint) us(varint) ns(varint)
+// offset  := hour(i8) minute(i8)
+// ```
+//
+// Comments are always written if the value has them, and are discarded when
+// it is loaded into a value with discard_comments. Strings are stored as-is;
+// they are not validated again when loaded.
+constexpr std::uint32_t binary_format_version = 1;
+
+struct binary_format_error : public std::runtime_error
+{
+    explicit binary_format_error(const std::string& what_arg)
+        : std::runtime_error(what_arg)
+    {}
+};
+
+namespace detail
+{
+constexpr std::size_t binary_magic_size = 8;
+inline const char* binary_magic() noexcept {return "TOML11B\n";}
+constexpr std::uint32_t binary_has_regions = 1;
+// arrays and tables are read recursively. A broken or crafted file must not
+// overflow the stack.
+constexpr std::size_t binary_max_depth = 512;
+
+struct binary_writer
+{
+    explicit binary_writer(const bool with_regions): with_regions_(with_regions) {}
+
+    void u8(const std::uint8_t x) {buf_.push_back(static_cast<char>(x));}
+    void u32(const std::uint32_t x)
+    {
+        for(int i=0; i<4; ++i) {this->u8(static_cast<std::uint8_t>(x >> (8 * i)));}
+    }
+    void u64(const std::uint64_t x)
+    {
+        for(int i=0; i<8; ++i) {this->u8(static_cast<std::uint8_t>(x >> (8 * i)));}
+    }
+    void varint(std::uint64_t x)
+    {
+        while(0x80 <= x)
+        {
+            this->u8(static_cast<std::uint8_t>((x & 0x7F) | 0x80));
+            x >>= 7;
+        }
+        this->u8(static_cast<std::uint8_t>(x));
+    }
+    void zigzag(const std::int64_t x)
+    {
+        this->varint((static_cast<std::uint64_t>(x) << 1) ^
+                     static_cast<std::uint64_t>(x >> 63));
+    }
+    void str(const char* first, const std::size_t len)
+    {
+        this->varint(len);
+        buf_.append(first, len);
+    }
+    void str(const std::string& s) {this->str(s.data(), s.size());}
+
+    void date(const local_date& d)
+    {
+        this->zigzag(d.year);
+        this->u8(d.month);
+        this->u8(d.day);
+    }
+    void time(const local_time& t)
+    {
+        this->u8(t.hour);
+        this->u8(t.minute);
+        this->u8(t.second);
+        this->varint(t.millisecond);
+        this->varint(t.microsecond);
+        this->varint(t.nanosecond);
+    }
+
+    // collects the sources of the regions before writing values.
+    template<typename Value>
+    void collect_sources(const Value& v)
+    {
+        if(const auto reg = dynamic_cast<const region*>(get_region(v)))
+        {
+            if(sources_.count(reg->source().get()) == 0)
+            {
+                const auto idx = sources_.size();
+                sources_[reg->source().get()] = idx;
+                source_list_.push_back(reg);
+            }
+        }
+        if(v.is_array())
+        {
+            for(const auto& elem : v.as_array()) {this->collect_sources(elem);}
+        }
+        else if(v.is_table())
+        {
+            for(const auto& kv : v.as_table()) {this->collect_sources(kv.second);}
+        }
+        return;
+    }
+
+    template<typename Value>
+    void value(const Value& v)
+    {
+        this->u8(static_cast<std::uint8_t>(v.type()));
+
+        this->varint(v.comments().size());
+        for(const auto& c : v.comments()) {this->str(c);}
+
+        if(with_regions_)
+        {
+            const auto reg = dynamic_cast<const region*>(get_region(v));
+            if(reg)
+            {
+                this->varint(sources_.at(reg->source().get()) + 1);
+                this->varint(static_cast<std::uint64_t>(reg->first() - reg->begin()));
+                this->varint(reg->size());
+            }
+            else
+            {
+                this->varint(0);
+            }
+        }
+
+        switch(v.type())
+        {
+            case value_t::empty   : {break;}
+            case value_t::boolean : {this->u8(v.as_boolean() ? 1 : 0); break;}
+            case value_t::integer : {this->zigzag(v.as_integer()); break;}
+            case value_t::floating:
+            {
+                const double f = v.as_floating();
+                std::uint64_t bits = 0;
+                static_assert(sizeof(f) == sizeof(bits), "double should be 64-bit");
+                std::memcpy(&bits, &f, sizeof(bits));
+                this->u64(bits);
+                break;
+            }
+            case value_t::string:
+            {
+                const auto& s = v.as_string();
+                this->u8(static_cast<std::uint8_t>(s.kind));
+                this->str(s.str);
+                break;
+            }
+            case value_t::offset_datetime:
+            {
+                const auto& odt = v.as_offset_datetime();
+                this->date(odt.date);
+                this->time(odt.time);
+                this->u8(static_cast<std::uint8_t>(odt.offset.hour));
+                this->u8(static_cast<std::uint8_t>(odt.offset.minute));
+                break;
+            }
+            case value_t::local_datetime:
+            {
+                const auto& ldt = v.as_local_datetime();
+                this->date(ldt.date);
+                this->time(ldt.time);
+                break;
+            }
+            case value_t::local_date: {this->date(v.as_local_date()); break;}
+            case value_t::local_time: {this->time(v.as_local_time()); break;}
+            case value_t::array:
+            {
+                this->varint(v.as_array().size());
+                for(const auto& elem : v.as_array()) {this->value(elem);}
+                break;
+            }
+            case value_t::table:
+            {
+                this->varint(v.as_table().size());
+                for(const auto& kv : v.as_table())
+                {
+                    this->str(kv.first);
+                    this->value(kv.second);
+                }
+                break;
+            }
+            default: {break;}
+        }
+        return;
+    }
+
+    template<typename Value>
+    std::string write(const Value& v)
+    {
+        buf_.append(binary_magic(), binary_magic_size);
+        this->u32(binary_format_version);
+        this->u32(with_regions_ ? binary_has_regions : 0);
+        if(with_regions_)
+        {
+            this->collect_sources(v);
+            this->varint(source_list_.size());
+            for(const auto reg : source_list_)
+            {
+                this->str(reg->name());
+                this->str(reg->begin(), static_cast<std::size_t>(reg->end() - reg->begin()));
+            }
+        }
+        this->value(v);
+        return std::move(buf_);
+    }
+
+  private:
+    bool        with_regions_;
+    std::string buf_;
+    std::map<const source_base*, std::size_t> sources_;
+    std::vector<const region*>                source_list_;
+};
+
+struct binary_reader
+{
+    binary_reader(const char* first, const char* last, std::string name)
+        : iter_(first), last_(last), name_(std::move(name))
+    {}
+
+    [[noreturn]] void fail(const std::string& what) const
+    {
+        throw binary_format_error("toml::load_binary: " + what + " in \"" + name_ + "\"");
+    }
+
+    void require(const std::size_t n) const
+    {
+        if(static_cast<std::size_t>(last_ - iter_) < n)
+        {
+            this->fail("unexpected end of data");
+        }
+    }
+    std::uint8_t u8()
+    {
+        this->require(1);
+        return static_cast<std::uint8_t>(*iter_++);
+    }
+    std::uint32_t u32()
+    {
+        std::uint32_t x = 0;
+        for(int i=0; i<4; ++i) {x |= static_cast<std::uint32_t>(this->u8()) << (8 * i);}
+        return x;
+    }
+    std::uint64_t u64()
+    {
+        std::uint64_t x = 0;
+        for(int i=0; i<8; ++i) {x |= static_cast<std::uint64_t>(this->u8()) << (8 * i);}
+        return x;
+    }
+    std::uint64_t varint()
+    {
+        std::uint64_t x = 0;
+        for(int shift=0; shift < 64; shift += 7)
+        {
+            const auto b = this->u8();
+            x |= static_cast<std::uint64_t>(b & 0x7F) << shift;
+            if((b & 0x80) == 0) {return x;}
+        }
+        this->fail("too long varint");
+    }
+    std::int64_t zigzag()
+    {
+        const auto x = this->varint();
+        return static_cast<std::int64_t>(x >> 1) ^ -static_cast<std::int64_t>(x & 1);
+    }
+    std::size_t size()
+    {
+        const auto n = this->varint();
+        // every element takes at least one byte
+        if(static_cast<std::uint64_t>(last_ - iter_) < n)
+        {
+            this->fail("invalid length");
+        }
+        return static_cast<std::size_t>(n);
+    }
+    std::string str()
+    {
+        const auto n = this->size();
+        std::string s(iter_, n);
+        iter_ += n;
+        return s;
+    }
+
+    local_date date()
+    {
+        local_date d;
+        d.year  = static_cast<std::int16_t>(this->zigzag());
+        d.month = this->u8();
+        d.day   = this->u8();
+        return d;
+    }
+    local_time time()
+    {
+        local_time t;
+        t.hour        = this->u8();
+        t.minute      = this->u8();
+        t.second      = this->u8();
+        t.millisecond = static_cast<std::uint16_t>(this->varint());
+        t.microsecond = static_cast<std::uint16_t>(this->varint());
+        t.nanosecond  = static_cast<std::uint16_t>(this->varint());
+        return t;
+    }
+
+    // counts the nesting of arrays and tables while they are read.
+    struct nesting_guard
+    {
+        explicit nesting_guard(binary_reader& self): self_(self)
+        {
+            if(binary_max_depth <= self_.depth_)
+            {
+                self_.fail("too deeply nested");
+            }
+            ++self_.depth_;
+        }
+        ~nesting_guard() {--self_.depth_;}
+        nesting_guard(const nesting_guard&) = delete;
+        nesting_guard& operator=(const nesting_guard&) = delete;
+
+      private:
+        binary_reader& self_;
+    };
+
+    template<typename Value>
+    Value value()
+    {
+        using value_type = Value;
+
+        const auto type = this->u8();
+
+        std::vector<std::string> comments(this->size());
+        for(auto& c : comments) {c = this->str();}
+
+        std::uint64_t src = 0, first = 0, len = 0;
+        if(has_regions_)
+        {
+            src = this->varint();
+            if(src != 0)
+            {
+                first = this->varint();
+                len   = this->varint();
+                if(sources_.size() < src)
+                {
+                    this->fail("invalid region");
+                }
+                // first + len may overflow.
+                const auto size = static_cast<std::uint64_t>(
+                    sources_.at(src-1).end() - sources_.at(src-1).begin());
+                if(first > size || len > size - first)
+                {
+                    this->fail("invalid region");
+                }
+            }
+        }
+
+        value_type v;
+        switch(static_cast<value_t>(type))
+        {
+            case value_t::empty:
+            {
+                v.comments() = typename value_type::comment_type(std::move(comments));
+                break;
+            }
+            case value_t::boolean:
+            {
+                v = value_type(this->u8() != 0, std::move(comments));
+                break;
+            }
+            case value_t::integer:
+            {
+                v = value_type(this->zigzag(), std::move(comments));
+                break;
+            }
+            case value_t::floating:
+            {
+                const auto bits = this->u64();
+                double f = 0.0;
+                std::memcpy(&f, &bits, sizeof(f));
+                v = value_type(f, std::move(comments));
+                break;
+            }
+            case value_t::string:
+            {
+                const auto kind = this->u8();
+                if(kind != static_cast<std::uint8_t>(string_t::basic) &&
+                   kind != static_cast<std::uint8_t>(string_t::literal))
+                {
+                    this->fail("unknown string kind");
+                }
+                v = value_type(this->str(), static_cast<string_t>(kind),
+                               std::move(comments));
+                break;
+            }
+            case value_t::offset_datetime:
+            {
+                const auto d = this->date();
+                const auto t = this->time();
+                time_offset o;
+                o.hour   = static_cast<std::int8_t>(this->u8());
+                o.minute = static_cast<std::int8_t>(this->u8());
+                v = value_type(offset_datetime(d, t, o), std::move(comments));
+                break;
+            }
+            case value_t::local_datetime:
+            {
+                const auto d = this->date();
+                const auto t = this->time();
+                v = value_type(local_datetime(d, t), std::move(comments));
+                break;
+            }
+            case value_t::local_date:
+            {
+                v = value_type(this->date(), std::move(comments));
+                break;
+            }
+            case value_t::local_time:
+            {
+                v = value_type(this->time(), std::move(comments));
+                break;
+            }
+            case value_t::array:
+            {
+                const nesting_guard guard(*this);
+                typename value_type::array_type ary(this->size());
+                for(auto& elem : ary) {elem = this->value<value_type>();}
+                v = value_type(std::move(ary), std::move(comments));
+                break;
+            }
+            case value_t::table:
+            {
+                const nesting_guard guard(*this);
+                typename value_type::table_type tab;
+                const auto n = this->size();
+                for(std::size_t i=0; i<n; ++i)
+                {
+                    auto k = this->str();
+                    tab.emplace(std::move(k), this->value<value_type>());
+                }
+                v = value_type(std::move(tab), std::move(comments));
+                break;
+            }
+            default: {this->fail("unknown value type");}
+        }
+        if(src != 0)
+        {
+            const auto& loc = sources_.at(src-1);
+            const auto reg_first = loc.begin() + static_cast<std::ptrdiff_t>(first);
+            change_region(v, region(loc, reg_first,
+                                    reg_first + static_cast<std::ptrdiff_t>(len)));
+        }
+        return v;
+    }
+
+    template<typename Value>
+    Value read()
+    {
+        this->require(binary_magic_size);
+        if(!std::equal(iter_, iter_ + binary_magic_size, binary_magic()))
+        {
+            this->fail("not a toml11 binary");
+        }
+        iter_ += binary_magic_size;
+
+        const auto version = this->u32();
+        if(version != binary_format_version)
+        {
+            this->fail("unsupported version " + std::to_string(version));
+        }
+        has_regions_ = (this->u32() & binary_has_regions) != 0;
+        if(has_regions_)
+        {
+            const auto n = this->size();
+            for(std::size_t i=0; i<n; ++i)
+            {
+                auto name    = this->str();
+                auto content = this->str();
+                sources_.emplace_back(std::move(name), std::make_shared<string_source>(
+                            std::move(content)));
+            }
+        }
+        auto v = this->value<Value>();
+        if(iter_ != last_)
+        {
+            this->fail("trailing bytes");
+        }
+        return v;
+    }
+
+    // the files that the regions in the value refer to.
+    const std::vector<location>& sources() const noexcept {return sources_;}
+
+  private:
+    const char*           iter_;
+    const char*           last_;
+    std::string           name_;
+    bool                  has_regions_ = false;
+    std::size_t           depth_       = 0;
+    std::vector<location> sources_;
+};
+
+} // detail
+
+// Writes a value in the binary format. If `with_regions` is true, the contents
+// of the files that the value was parsed from are also written, so that error
+// messages about the loaded value can show the original lines.
+template<typename C, template<typename ...> class M, template<typename ...> class V>
+void save_binary(std::ostream& os, const basic_value<C, M, V>& v,
+                 const bool with_regions = false)
+{
+    const auto buf = detail::binary_writer(with_regions).write(v);
+    os.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+    return;
+}
+
+template<typename C, template<typename ...> class M, template<typename ...> class V>
+void save_binary(const basic_value<C, M, V>& v, const std::string& fname,
+                 const bool with_regions = false)
+{
+    std::ofstream ofs(fname, std::ios_base::binary);
+    if(!ofs.good())
+    {
+        throw std::ios_base::failure(
+                "toml::save_binary: Error opening file \"" + fname + "\"");
+    }
+    ofs.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+    save_binary(ofs, v, with_regions);
+    return;
+}
+
+// Reads a value written by toml::save_binary. It throws
+// toml::binary_format_error if the data is broken or written by another
+// version of the format.
+template<typename                     Comment = TOML11_DEFAULT_COMMENT_STRATEGY,
+         template<typename ...> class Table   = std::unordered_map,
+         template<typename ...> class Array   = std::vector>
+basic_value<Comment, Table, Array>
+load_binary(const char* first, const std::size_t len,
+            std::string fname = "unknown file")
+{
+    return detail::binary_reader(first, first + len, std::move(fname)).read<
+        basic_value<Comment, Table, Array>>();
+}
+
+template<typename                     Comment = TOML11_DEFAULT_COMMENT_STRATEGY,
+         template<typename ...> class Table   = std::unordered_map,
+         template<typename ...> class Array   = std::vector>
+basic_value<Comment, Table, Array>
+load_binary(std::istream& is, std::string fname = "unknown file")
+{
+    const auto buf = detail::read_stream(is);
+    return load_binary<Comment, Table, Array>(buf.data(), buf.size(), std::move(fname));
+}
+
+// the file is mapped into memory if possible.
+template<typename                     Comment = TOML11_DEFAULT_COMMENT_STRATEGY,
+         template<typename ...> class Table   = std::unordered_map,
+         template<typename ...> class Array   = std::vector>
+basic_value<Comment, Table, Array> load_binary(const std::string& fname)
+{
+#ifdef TOML11_HAS_MMAP
+    const detail::mapped_file_source src(fname);
+    return load_binary<Comment, Table, Array>(src.begin(),
+            static_cast<std::size_t>(src.end() - src.begin()), fname);
+#else
+    std::ifstream ifs(fname, std::ios_base::binary);
+    if(!ifs.good())
+    {
+        throw std::ios_base::failure(
+                "toml::load_binary: Error opening file \"" + fname + "\"");
+    }
+    ifs.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+    return load_binary<Comment, Table, Array>(ifs, fname);
+#endif
+}
+
+} // toml
+#endif// TOML11_BINARY_HPP
@@ -7,6 +7,7 @@
 #include <cstdio>
 
 #include <array>
+#include <cstdint>
 #include <iomanip>
 #include <iterator>
 #include <limits>
@@ -18,7 +19,8 @@
 #include "utility.hpp"
 
 // they scans characters and returns region if it matches to the condition.
-// when they fail, it does not change the location.
+// when they fail, it does not change the location. internally, they return a
+// span instead of a region to avoid constructing a region for each character.
 // in lexer.hpp, these are used.
 
 namespace toml
@@ -53,13 +55,35 @@ inline std::string show_char(const char c)
     }
 }
 
+// a range [first, last) matched by a combinator. Unlike region, it does not
+// share the ownership of the source nor copy the name of it, so it is trivially
+// copyable. The combinators pass spans to each other through `scan` and a
+// region is constructed only once, when a lexer is `invoke`d from the parser.
+struct span
+{
+    using const_iterator = location::const_iterator;
+
+    const_iterator first;
+    const_iterator last;
+};
+
+inline result<region, none_t>
+to_region(const location& loc, const result<span, none_t>& s)
+{
+    if(s.is_err())
+    {
+        return none();
+    }
+    return ok(region(loc, s.as_ok().first, s.as_ok().last));
+}
+
 template<char C>
 struct character
 {
     static constexpr char target = C;
 
-    static result<region, none_t>
-    invoke(location& loc)
+    static result<span, none_t>
+    scan(location& loc)
     {
         if(loc.iter() == loc.end()) {return none();}
         const auto first = loc.iter();
@@ -71,7 +95,12 @@ struct character
         }
         loc.advance(); // update location
 
-        return ok(region(loc, first, loc.iter()));
+        return ok(span{first, loc.iter()});
+    }
+    static result<region, none_t>
+    invoke(location& loc)
+    {
+        return to_region(loc, scan(loc));
     }
 };
 template<char C>
@@ -87,8 +116,8 @@ struct in_range
     static constexpr char upper = Up;
     static constexpr char lower = Low;
 
-    static result<region, none_t>
-    invoke(location& loc)
+    static result<span, none_t>
+    scan(location& loc)
     {
         if(loc.iter() == loc.end()) {return none();}
         const auto first = loc.iter();
@@ -100,31 +129,59 @@ struct in_range
         }
 
         loc.advance();
-        return ok(region(loc, first, loc.iter()));
+        return ok(span{first, loc.iter()});
+    }
+    static result<region, none_t>
+    invoke(location& loc)
+    {
+        return to_region(loc, scan(loc));
     }
 };
 template<char L, char U> constexpr char in_range<L, U>::upper;
 template<char L, char U> constexpr char in_range<L, U>::lower;
 
+// matches only at the end of the input and consumes nothing. since the last
+// line of a file may not have a newline, this is used as an alternative of
+// lex_newline where a line ends. Do not put it in a `repeat`; it never advances.
+struct end_of_file
+{
+    static result<span, none_t>
+    scan(location& loc)
+    {
+        if(loc.iter() != loc.end()) {return none();}
+        return ok(span{loc.iter(), loc.iter()});
+    }
+    static result<region, none_t>
+    invoke(location& loc)
+    {
+        return to_region(loc, scan(loc));
+    }
+};
+
 // keep iterator if `Combinator` matches. otherwise, increment `iter` by 1 char.
 // for detecting invalid characters, like control sequences in toml string.
 template<typename Combinator>
 struct exclude
 {
-    static result<region, none_t>
-    invoke(location& loc)
+    static result<span, none_t>
+    scan(location& loc)
     {
         if(loc.iter() == loc.end()) {return none();}
         auto first = loc.iter();
 
-        auto rslt = Combinator::invoke(loc);
+        const auto rslt = Combinator::scan(loc);
         if(rslt.is_ok())
         {
             loc.reset(first);
             return none();
         }
         loc.reset(std::next(first)); // XXX maybe loc.advance() is okay but...
-        return ok(region(loc, first, loc.iter()));
+        return ok(span{first, loc.iter()});
+    }
+    static result<region, none_t>
+    invoke(location& loc)
+    {
+        return to_region(loc, scan(loc));
     }
 };
 
@@ -132,69 +189,79 @@ struct exclude
 template<typename Combinator>
 struct maybe
 {
-    static result<region, none_t>
-    invoke(location& loc)
+    static result<span, none_t>
+    scan(location& loc)
     {
-        const auto rslt = Combinator::invoke(loc);
+        const auto rslt = Combinator::scan(loc);
         if(rslt.is_ok())
         {
             return rslt;
         }
-        return ok(region(loc));
+        return ok(span{loc.iter(), loc.iter()});
+    }
+    static result<region, none_t>
+    invoke(location& loc)
+    {
+        return to_region(loc, scan(loc));
     }
 };
 
+// the combinators always match a contiguous range, so the span of a sequence
+// is [the first of the first one, the last of the last one).
 template<typename ... Ts>
 struct sequence;
 
 template<typename Head, typename ... Tail>
 struct sequence<Head, Tail...>
 {
-    static result<region, none_t>
-    invoke(location& loc)
+    static result<span, none_t>
+    scan(location& loc)
     {
         const auto first = loc.iter();
-        auto rslt = Head::invoke(loc);
+        const auto rslt = Head::scan(loc);
         if(rslt.is_err())
         {
             loc.reset(first);
             return none();
         }
-        return sequence<Tail...>::invoke(loc, std::move(rslt.unwrap()), first);
+        return sequence<Tail...>::scan(loc, first);
+    }
+    static result<region, none_t>
+    invoke(location& loc)
+    {
+        return to_region(loc, scan(loc));
     }
 
     // called from the above function only, recursively.
     template<typename Iterator>
-    static result<region, none_t>
-    invoke(location& loc, region reg, Iterator first)
+    static result<span, none_t>
+    scan(location& loc, Iterator first)
     {
-        const auto rslt = Head::invoke(loc);
+        const auto rslt = Head::scan(loc);
         if(rslt.is_err())
         {
             loc.reset(first);
             return none();
         }
-        reg += rslt.unwrap(); // concat regions
-        return sequence<Tail...>::invoke(loc, std::move(reg), first);
+        return sequence<Tail...>::scan(loc, first);
     }
 };
 
 template<typename Head>
 struct sequence<Head>
 {
-    // would be called from sequence<T ...>::invoke only.
+    // would be called from sequence<T ...>::scan only.
     template<typename Iterator>
-    static result<region, none_t>
-    invoke(location& loc, region reg, Iterator first)
+    static result<span, none_t>
+    scan(location& loc, Iterator first)
     {
-        const auto rslt = Head::invoke(loc);
+        const auto rslt = Head::scan(loc);
         if(rslt.is_err())
         {
             loc.reset(first);
             return none();
         }
-        reg += rslt.unwrap(); // concat regions
-        return ok(reg);
+        return ok(span{first, loc.iter()});
     }
 };
 
@@ -204,21 +271,31 @@ struct either;
 template<typename Head, typename ... Tail>
 struct either<Head, Tail...>
 {
+    static result<span, none_t>
+    scan(location& loc)
+    {
+        const auto rslt = Head::scan(loc);
+        if(rslt.is_ok()) {return rslt;}
+        return either<Tail...>::scan(loc);
+    }
     static result<region, none_t>
     invoke(location& loc)
     {
-        const auto rslt = Head::invoke(loc);
-        if(rslt.is_ok()) {return rslt;}
-        return either<Tail...>::invoke(loc);
+        return to_region(loc, scan(loc));
     }
 };
 template<typename Head>
 struct either<Head>
 {
+    static result<span, none_t>
+    scan(location& loc)
+    {
+        return Head::scan(loc);
+    }
     static result<region, none_t>
     invoke(location& loc)
     {
-        return Head::invoke(loc);
+        return to_region(loc, scan(loc));
     }
 };
 
@@ -232,72 +309,190 @@ struct unlimited{};
 template<typename T, std::size_t N>
 struct repeat<T, exactly<N>>
 {
-    static result<region, none_t>
-    invoke(location& loc)
+    static result<span, none_t>
+    scan(location& loc)
     {
-        region retval(loc);
         const auto first = loc.iter();
         for(std::size_t i=0; i<N; ++i)
         {
-            auto rslt = T::invoke(loc);
+            const auto rslt = T::scan(loc);
             if(rslt.is_err())
             {
                 loc.reset(first);
                 return none();
             }
-            retval += rslt.unwrap();
         }
-        return ok(std::move(retval));
+        return ok(span{first, loc.iter()});
+    }
+    static result<region, none_t>
+    invoke(location& loc)
+    {
+        return to_region(loc, scan(loc));
     }
 };
 
 template<typename T, std::size_t N>
 struct repeat<T, at_least<N>>
 {
-    static result<region, none_t>
-    invoke(location& loc)
+    static result<span, none_t>
+    scan(location& loc)
     {
-        region retval(loc);
-
         const auto first = loc.iter();
         for(std::size_t i=0; i<N; ++i)
         {
-            auto rslt = T::invoke(loc);
+            const auto rslt = T::scan(loc);
             if(rslt.is_err())
             {
                 loc.reset(first);
                 return none();
             }
-            retval += rslt.unwrap();
         }
         while(true)
         {
-            auto rslt = T::invoke(loc);
+            const auto rslt = T::scan(loc);
             if(rslt.is_err())
             {
-                return ok(std::move(retval));
+                return ok(span{first, loc.iter()});
             }
-            retval += rslt.unwrap();
         }
     }
+    static result<region, none_t>
+    invoke(location& loc)
+    {
+        return to_region(loc, scan(loc));
+    }
 };
 
 template<typename T>
 struct repeat<T, unlimited>
 {
-    static result<region, none_t>
-    invoke(location& loc)
+    static result<span, none_t>
+    scan(location& loc)
     {
-        region retval(loc);
+        const auto first = loc.iter();
         while(true)
         {
-            auto rslt = T::invoke(loc);
+            const auto rslt = T::scan(loc);
             if(rslt.is_err())
             {
-                return ok(std::move(retval));
+                return ok(span{first, loc.iter()});
+            }
+        }
+    }
+    static result<region, none_t>
+    invoke(location& loc)
+    {
+        return to_region(loc, scan(loc));
+    }
+};
+
+// ----------------------------------------------------------------------------
+// table-driven lexers.
+//
+// A character class is a set of bits looked up in a 256-entry table, so a
+// character is checked by one load instead of nested `either<in_range>` calls.
+// The combinator grammar of the lexers that use them is in lexer.hpp, as
+// `reference::*`.
+
+constexpr std::uint8_t char_class_digit    = 0x01; // [0-9]
+constexpr std::uint8_t char_class_hex      = 0x02; // [0-9A-Fa-f]
+constexpr std::uint8_t char_class_oct      = 0x04; // [0-7]
+constexpr std::uint8_t char_class_bin      = 0x08; // [01]
+constexpr std::uint8_t char_class_alpha    = 0x10; // [A-Za-z]
+constexpr std::uint8_t char_class_bare_key = 0x20; // [A-Za-z0-9_-]
+
+constexpr std::uint8_t classify_char(const std::size_t c) noexcept
+{
+    return static_cast<std::uint8_t>(
+        (('0' <= c && c <= '9') ? (char_class_digit | char_class_hex | char_class_bare_key) : 0) |
+        (('0' <= c && c <= '7') ? char_class_oct : 0) |
+        (('0' <= c && c <= '1') ? char_class_bin : 0) |
+        (('A' <= c && c <= 'F') || ('a' <= c && c <= 'f') ? char_class_hex : 0) |
+        (('A' <= c && c <= 'Z') || ('a' <= c && c <= 'z') ?
+            (char_class_alpha | char_class_bare_key) : 0) |
+        ((c == '_' || c == '-') ? char_class_bare_key : 0));
+}
+
+template<typename IndexSequence>
+struct char_class_table_impl;
+template<std::size_t ... Is>
+struct char_class_table_impl<index_sequence<Is...>>
+{
+    static constexpr std::uint8_t value[sizeof...(Is)] = {classify_char(Is)...};
+};
+template<std::size_t ... Is>
+constexpr std::uint8_t char_class_table_impl<index_sequence<Is...>>::value[sizeof...(Is)];
+
+using char_class_table = char_class_table_impl<make_index_sequence<256>>;
+
+inline bool is_char_class(const char c, const std::uint8_t cls) noexcept
+{
+    return (char_class_table::value[static_cast<unsigned char>(c)] & cls) != 0;
+}
+
+// matches a character in `Class`.
+template<std::uint8_t Class>
+struct char_in_class
+{
+    static result<span, none_t>
+    scan(location& loc)
+    {
+        if(loc.iter() == loc.end() || !is_char_class(*loc.iter(), Class))
+        {
+            return none();
+        }
+        const auto first = loc.iter();
+        loc.advance();
+        return ok(span{first, loc.iter()});
+    }
+    static result<region, none_t>
+    invoke(location& loc)
+    {
+        return to_region(loc, scan(loc));
+    }
+};
+
+// matches `Min` or more characters in `Class`. If `Underscore`, a character
+// can be preceded by an underscore, like `repeat<either<C, sequence<'_', C>>>`.
+template<std::uint8_t Class, bool Underscore, std::size_t Min>
+struct char_class_run
+{
+    static result<span, none_t>
+    scan(location& loc)
+    {
+        const auto first = loc.iter();
+        const auto last  = loc.end();
+
+        auto iter = first;
+        std::size_t count = 0;
+        while(iter != last)
+        {
+            if(is_char_class(*iter, Class))
+            {
+                iter += 1;
+            }
+            else if(Underscore && *iter == '_' && last - iter >= 2 &&
+                    is_char_class(iter[1], Class))
+            {
+                iter += 2;
+            }
+            else
+            {
+                break;
             }
-            retval += rslt.unwrap();
+            ++count;
         }
+        if(count < Min)
+        {
+            return none();
+        }
+        loc.advance(iter - first);
+        return ok(span{first, iter});
+    }
+    static result<region, none_t>
+    invoke(location& loc)
+    {
+        return to_region(loc, scan(loc));
     }
 };
 
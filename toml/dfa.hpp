@@ -0,0 +1,563 @@
+//     Copyright Toru Niina 2017.
+// Distributed under the MIT License.
+#ifndef TOML11_DFA_HPP
+#define TOML11_DFA_HPP
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "combinator.hpp"
+#include "simd.hpp"
+
+// compiles a lexer written by the combinators into a deterministic finite
+// automaton. `dfa<lex_float>::scan(loc)` matches the same range as
+// `lex_float::scan(loc)`, but it reads each character only once, without
+// calling `loc.reset` when an alternative fails.
+//
+// The grammar in lexer.hpp is still the single source of truth; the automaton
+// is derived from the type of a lexer when it is used for the first time.
+// Only the regular part of the combinators (character, in_range,
+// char_in_class, char_class_run, sequence, either, maybe, and repeat) can be
+// compiled. Using it with `exclude` or `end_of_file` is a compile error.
+//
+// The combinators take the first alternative that matches and a `repeat` never
+// gives back what it consumed, while an automaton finds the longest match. They
+// agree on the token lexers in lexer.hpp, and tests/test_lex_dfa.cpp checks it.
+//
+// parser.hpp uses `dfa<lex_float>` in parse_floating, and `number_classifier`
+// runs the datetime, float and integer lexers through one `dfa_classifier`, so
+// that a value is read once to find both its type and its end.
+
+namespace toml
+{
+namespace detail
+{
+
+// ---------------------------------------------------------------------------
+// NFA (Thompson's construction)
+
+struct nfa
+{
+    struct edge
+    {
+        std::uint8_t lower;
+        std::uint8_t upper;
+        std::size_t  target;
+    };
+    struct node
+    {
+        std::vector<edge>        edges;
+        std::vector<std::size_t> epsilons;
+    };
+
+    std::size_t add_node()
+    {
+        nodes.emplace_back();
+        return nodes.size() - 1;
+    }
+    void add_edge(const std::size_t from, const std::uint8_t lower,
+                  const std::uint8_t upper, const std::size_t to)
+    {
+        nodes.at(from).edges.push_back(edge{lower, upper, to});
+    }
+    void add_epsilon(const std::size_t from, const std::size_t to)
+    {
+        nodes.at(from).epsilons.push_back(to);
+    }
+
+    std::vector<node> nodes;
+};
+
+// nfa_builder<Lexer>::build(g, from, to) adds the nodes that matches `Lexer`
+// from `from` to `to`. It never adds an edge that goes back to `from`, so
+// `from` and `to` can be shared with the other alternatives.
+template<typename Lexer>
+struct nfa_builder; // not defined for the non-regular combinators.
+
+template<char C>
+struct nfa_builder<character<C>>
+{
+    static void build(nfa& g, const std::size_t from, const std::size_t to)
+    {
+        const auto c = static_cast<std::uint8_t>(C);
+        g.add_edge(from, c, c, to);
+    }
+};
+
+template<char Low, char Up>
+struct nfa_builder<in_range<Low, Up>>
+{
+    static void build(nfa& g, const std::size_t from, const std::size_t to)
+    {
+        // in_range compares `char`s. if it is signed, [-128, -1] are [128, 255].
+        const auto lower = static_cast<std::uint8_t>(Low);
+        const auto upper = static_cast<std::uint8_t>(Up);
+        if(lower <= upper)
+        {
+            g.add_edge(from, lower, upper, to);
+        }
+        else // Low < 0 <= Up
+        {
+            g.add_edge(from, 0x00,  upper, to);
+            g.add_edge(from, lower, 0xFF,  to);
+        }
+    }
+};
+
+inline void add_char_class_edges(nfa& g, const std::uint8_t cls,
+                                 const std::size_t from, const std::size_t to)
+{
+    std::size_t c = 0;
+    while(c < 256)
+    {
+        if((char_class_table::value[c] & cls) == 0) {++c; continue;}
+
+        const std::size_t lower = c;
+        while(c < 256 && (char_class_table::value[c] & cls) != 0) {++c;}
+        g.add_edge(from, static_cast<std::uint8_t>(lower),
+                         static_cast<std::uint8_t>(c - 1), to);
+    }
+    return;
+}
+
+template<std::uint8_t Class>
+struct nfa_builder<char_in_class<Class>>
+{
+    static void build(nfa& g, const std::size_t from, const std::size_t to)
+    {
+        add_char_class_edges(g, Class, from, to);
+    }
+};
+
+template<typename Head, typename ... Tail>
+struct nfa_builder<sequence<Head, Tail...>>
+{
+    static void build(nfa& g, const std::size_t from, const std::size_t to)
+    {
+        const auto mid = g.add_node();
+        nfa_builder<Head>::build(g, from, mid);
+        nfa_builder<sequence<Tail...>>::build(g, mid, to);
+    }
+};
+template<typename Head>
+struct nfa_builder<sequence<Head>>
+{
+    static void build(nfa& g, const std::size_t from, const std::size_t to)
+    {
+        nfa_builder<Head>::build(g, from, to);
+    }
+};
+
+template<typename Head, typename ... Tail>
+struct nfa_builder<either<Head, Tail...>>
+{
+    static void build(nfa& g, const std::size_t from, const std::size_t to)
+    {
+        nfa_builder<Head>::build(g, from, to);
+        nfa_builder<either<Tail...>>::build(g, from, to);
+    }
+};
+template<typename Head>
+struct nfa_builder<either<Head>>
+{
+    static void build(nfa& g, const std::size_t from, const std::size_t to)
+    {
+        nfa_builder<Head>::build(g, from, to);
+    }
+};
+
+template<typename T>
+struct nfa_builder<maybe<T>>
+{
+    static void build(nfa& g, const std::size_t from, const std::size_t to)
+    {
+        nfa_builder<T>::build(g, from, to);
+        g.add_epsilon(from, to);
+    }
+};
+
+// matches `Elem` N times and then zero or more times.
+template<typename Elem>
+void add_nfa_repeat(nfa& g, const std::size_t n, const bool unbounded,
+                    std::size_t from, const std::size_t to)
+{
+    for(std::size_t i=0; i<n; ++i)
+    {
+        const auto next = (i+1 == n && !unbounded) ? to : g.add_node();
+        Elem::build(g, from, next);
+        from = next;
+    }
+    if(unbounded)
+    {
+        // a loop between new nodes, so that the loop does not include `from`.
+        const auto loop_first = g.add_node();
+        const auto loop_last  = g.add_node();
+        g.add_epsilon(from,       loop_first);
+        g.add_epsilon(loop_first, to);
+        Elem::build(g, loop_first, loop_last);
+        g.add_epsilon(loop_last,  loop_first);
+    }
+    else if(n == 0)
+    {
+        g.add_epsilon(from, to);
+    }
+    return;
+}
+
+template<typename T, std::size_t N>
+struct nfa_builder<repeat<T, exactly<N>>>
+{
+    static void build(nfa& g, const std::size_t from, const std::size_t to)
+    {
+        add_nfa_repeat<nfa_builder<T>>(g, N, false, from, to);
+    }
+};
+template<typename T, std::size_t N>
+struct nfa_builder<repeat<T, at_least<N>>>
+{
+    static void build(nfa& g, const std::size_t from, const std::size_t to)
+    {
+        add_nfa_repeat<nfa_builder<T>>(g, N, true, from, to);
+    }
+};
+template<typename T>
+struct nfa_builder<repeat<T, unlimited>>
+{
+    static void build(nfa& g, const std::size_t from, const std::size_t to)
+    {
+        add_nfa_repeat<nfa_builder<T>>(g, 0, true, from, to);
+    }
+};
+
+// a character in `Class`, optionally preceded by an underscore.
+template<std::uint8_t Class, bool Underscore>
+struct nfa_char_class_run_elem
+{
+    static void build(nfa& g, const std::size_t from, const std::size_t to)
+    {
+        add_char_class_edges(g, Class, from, to);
+        if(Underscore)
+        {
+            const auto mid = g.add_node();
+            g.add_edge(from, '_', '_', mid);
+            add_char_class_edges(g, Class, mid, to);
+        }
+    }
+};
+template<std::uint8_t Class, bool Underscore, std::size_t Min>
+struct nfa_builder<char_class_run<Class, Underscore, Min>>
+{
+    static void build(nfa& g, const std::size_t from, const std::size_t to)
+    {
+        add_nfa_repeat<nfa_char_class_run_elem<Class, Underscore>>(
+                g, Min, true, from, to);
+    }
+};
+
+// ---------------------------------------------------------------------------
+// DFA (subset construction)
+
+struct dfa_table
+{
+    // the bytes that no edge of the NFA distinguishes share a class, so a row
+    // of the table has an entry per class instead of per byte.
+    std::array<std::uint8_t, 256> classes;
+    std::size_t num_classes;
+
+    // an entry of `next` is the offset of the row of the next state. The row
+    // of the dead state is at 0, so an entry 0 means no match. The accepting
+    // states are put after the others, so a state accepts if the offset of
+    // its row is not less than `accept_row`.
+    std::vector<std::uint32_t> next;
+    std::uint32_t start_row;
+    std::uint32_t accept_row;
+
+    // if the automaton is made from several lexers, `matches[row]` has the
+    // bits of the lexers that accept at the state. only the first entry of
+    // each row is used.
+    std::vector<std::uint32_t> matches;
+};
+
+inline std::vector<std::size_t>
+nfa_closure(const nfa& g, std::vector<std::size_t> states)
+{
+    std::vector<bool> visited(g.nodes.size(), false);
+    std::vector<std::size_t> stack(states);
+    for(const auto s : states) {visited.at(s) = true;}
+    while(!stack.empty())
+    {
+        const auto s = stack.back();
+        stack.pop_back();
+        for(const auto t : g.nodes.at(s).epsilons)
+        {
+            if(!visited.at(t))
+            {
+                visited.at(t) = true;
+                states.push_back(t);
+                stack.push_back(t);
+            }
+        }
+    }
+    std::sort(states.begin(), states.end());
+    return states;
+}
+
+// splits the bytes at the boundaries of the edges.
+inline std::size_t make_byte_classes(const nfa& g, std::array<std::uint8_t, 256>& classes)
+{
+    std::array<bool, 257> boundary;
+    boundary.fill(false);
+    for(const auto& n : g.nodes)
+    {
+        for(const auto& e : n.edges)
+        {
+            boundary[e.lower]     = true;
+            boundary[e.upper + 1] = true;
+        }
+    }
+    std::size_t cls = 0;
+    for(std::size_t c=0; c<256; ++c)
+    {
+        if(c != 0 && boundary[c]) {++cls;}
+        classes[c] = static_cast<std::uint8_t>(cls);
+    }
+    return cls + 1;
+}
+
+// `accepts` are the accepting nodes of the NFA, one for each lexer.
+inline dfa_table make_dfa_table(const nfa& g, const std::size_t start,
+                                const std::vector<std::size_t>& accepts)
+{
+    assert(accepts.size() <= 32);
+    dfa_table table;
+    table.num_classes = make_byte_classes(g, table.classes);
+    const auto width  = table.num_classes;
+
+    // a representative byte of each class
+    std::vector<std::size_t> bytes(width);
+    for(std::size_t c=256; c-- != 0;)
+    {
+        bytes.at(table.classes[c]) = c;
+    }
+
+    std::vector<std::vector<std::size_t>> subsets;
+    std::vector<std::uint32_t> matches;
+    std::map<std::vector<std::size_t>, std::size_t> index;
+
+    const auto add_state = [&](std::vector<std::size_t> subset) -> std::size_t {
+        const auto found = index.find(subset);
+        if(found != index.end()) {return found->second;}
+
+        const auto id = subsets.size();
+        std::uint32_t match = 0;
+        for(std::size_t i=0; i<accepts.size(); ++i)
+        {
+            if(std::binary_search(subset.begin(), subset.end(), accepts[i]))
+            {
+                match |= (1u << i);
+            }
+        }
+        matches.push_back(match);
+        index.emplace(subset, id);
+        subsets.push_back(std::move(subset));
+        return id;
+    };
+
+    add_state(std::vector<std::size_t>{});                      // dead
+    add_state(nfa_closure(g, std::vector<std::size_t>{start})); // start
+
+    std::vector<std::size_t> targets;
+    std::vector<std::size_t> transitions(width, 0); // to the dead state
+    for(std::size_t id=1; id<subsets.size(); ++id)
+    {
+        transitions.resize((id+1) * width, 0);
+        for(std::size_t cls=0; cls<width; ++cls)
+        {
+            const auto c = bytes.at(cls);
+            targets.clear();
+            // `add_state` may reallocate `subsets`, so do not keep a reference.
+            for(const auto s : subsets.at(id))
+            {
+                for(const auto& e : g.nodes.at(s).edges)
+                {
+                    if(e.lower <= c && c <= e.upper) {targets.push_back(e.target);}
+                }
+            }
+            if(!targets.empty())
+            {
+                transitions.at(id * width + cls) = add_state(nfa_closure(g, targets));
+            }
+        }
+    }
+
+    // renumber the states; the dead state, the others, and the accepting ones.
+    const auto num_states = subsets.size();
+    assert(num_states * width < std::numeric_limits<std::uint32_t>::max());
+    std::vector<std::uint32_t> row(num_states);
+    std::uint32_t offset = 0;
+    for(const bool accepting : {false, true})
+    {
+        if(accepting) {table.accept_row = offset;}
+        for(std::size_t id=0; id<num_states; ++id)
+        {
+            if((matches.at(id) != 0) == accepting)
+            {
+                row.at(id) = offset;
+                offset += static_cast<std::uint32_t>(width);
+            }
+        }
+    }
+    table.start_row = row.at(1);
+    table.next.resize(num_states * width);
+    table.matches.resize(num_states * width, 0);
+    for(std::size_t id=0; id<num_states; ++id)
+    {
+        for(std::size_t cls=0; cls<width; ++cls)
+        {
+            table.next.at(row.at(id) + cls) = row.at(transitions.at(id * width + cls));
+        }
+        table.matches.at(row.at(id)) = matches.at(id);
+    }
+    return table;
+}
+
+template<typename Lexer>
+struct dfa
+{
+    static const dfa_table& table()
+    {
+        static const dfa_table t = make_table();
+        return t;
+    }
+
+    // returns the longest match from the current location. the location is
+    // moved only once, to the end of the match.
+    static result<span, none_t>
+    scan(location& loc)
+    {
+        const auto& t    = table();
+        const auto first = loc.iter();
+        const auto last  = loc.end();
+
+        const auto* const next    = t.next.data();
+        const auto* const classes = t.classes.data();
+
+        auto row     = t.start_row;
+        auto matched = (row >= t.accept_row) ? first : nullptr;
+        for(auto iter = first; iter != last; ++iter)
+        {
+            row = next[row + classes[static_cast<unsigned char>(*iter)]];
+            if(row == 0) // dead
+            {
+                break;
+            }
+            if(row >= t.accept_row)
+            {
+                matched = iter + 1;
+            }
+        }
+        if(matched == nullptr)
+        {
+            return none();
+        }
+        loc.advance(matched - first);
+        return ok(span{first, matched});
+    }
+    static result<region, none_t>
+    invoke(location& loc)
+    {
+        return to_region(loc, scan(loc));
+    }
+
+  private:
+
+    static dfa_table make_table()
+    {
+        nfa g;
+        const auto start  = g.add_node();
+        const auto accept = g.add_node();
+        nfa_builder<Lexer>::build(g, start, accept);
+        return make_dfa_table(g, start, std::vector<std::size_t>{accept});
+    }
+};
+
+// runs several lexers at once. `scan` returns the end of the longest match of
+// each lexer, or nullptr if it does not match, by reading the characters once.
+template<typename ... Lexers>
+struct dfa_classifier
+{
+    static_assert(sizeof...(Lexers) <= 32, "too many lexers");
+
+    using match_type = std::array<const char*, sizeof...(Lexers)>;
+
+    static const dfa_table& table()
+    {
+        static const dfa_table t = make_table();
+        return t;
+    }
+
+    static match_type scan(const char* first, const char* last)
+    {
+        const auto& t = table();
+        const auto* const next    = t.next.data();
+        const auto* const classes = t.classes.data();
+
+        match_type ends;
+        ends.fill(nullptr);
+
+        auto row = t.start_row;
+        auto iter = first;
+        while(true)
+        {
+            if(row >= t.accept_row)
+            {
+                auto bits = t.matches[row];
+                while(bits != 0)
+                {
+                    ends[count_trailing_zeros(bits)] = iter;
+                    bits &= bits - 1;
+                }
+            }
+            if(iter == last)
+            {
+                break;
+            }
+            row = next[row + classes[static_cast<unsigned char>(*iter)]];
+            if(row == 0) // dead
+            {
+                break;
+            }
+            ++iter;
+        }
+        return ends;
+    }
+
+  private:
+
+    static dfa_table make_table()
+    {
+        nfa g;
+        const auto start = g.add_node();
+        std::vector<std::size_t> accepts;
+        const int dummy[] = {(add_lexer<Lexers>(g, start, accepts), 0)...};
+        (void)dummy;
+        return make_dfa_table(g, start, accepts);
+    }
+
+    template<typename Lexer>
+    static void add_lexer(nfa& g, const std::size_t start,
+                          std::vector<std::size_t>& accepts)
+    {
+        accepts.push_back(g.add_node());
+        nfa_builder<Lexer>::build(g, start, accepts.back());
+    }
+};
+
+} // detail
+} // toml
+#endif// TOML11_DFA_HPP
@@ -0,0 +1,136 @@
+//     Copyright Toru Niina 2017.
+// Distributed under the MIT License.
+#ifndef TOML11_EVENT_PARSER_HPP
+#define TOML11_EVENT_PARSER_HPP
+#include <istream>
+#include <string>
+#include <vector>
+
+#include "reader.hpp"
+
+namespace toml
+{
+
+// An event handler for toml::parse_events. toml::parse_events reads a file
+// and calls the member functions of a handler in the order of appearance,
+// without constructing toml::value. Derive this and re-define the member
+// functions you are interested in. Each function returns `false` to stop
+// parsing, `true` to continue.
+//
+// ```toml
+// a.b = 42            # on_key({"a", "b"}), on_integer(42)
+// [c]                 # on_table_header({"c"})
+// d = [1, {e = "f"}]  # on_key({"d"}), on_array_begin(), on_integer(1),
+//                     # on_inline_table_begin(), on_key({"e"}), on_string("f"),
+//                     # on_inline_table_end(), on_array_end()
+// [[g]]               # on_array_table_header({"g"})
+// ```
+//
+// Since it does not have a table, it does not check that a key or a table is
+// defined twice. Syntax errors are reported by throwing toml::syntax_error.
+//
+// The keys and the strings are passed as the buffers in toml::reader that are
+// reused for the next ones, so a key-value pair is read without allocation
+// once they are large enough. Table headers, escape sequences, multi-line
+// strings, inf and nan take the same path as toml::parse and do allocate.
+struct event_handler
+{
+    bool on_table_header      (const std::vector<key>&) {return true;}
+    bool on_array_table_header(const std::vector<key>&) {return true;}
+    bool on_key               (const std::vector<key>&) {return true;}
+
+    bool on_boolean        (const boolean)          {return true;}
+    bool on_integer        (const integer)          {return true;}
+    bool on_floating       (const floating)         {return true;}
+    bool on_string         (const string&)          {return true;}
+    bool on_offset_datetime(const offset_datetime&) {return true;}
+    bool on_local_datetime (const local_datetime&)  {return true;}
+    bool on_local_date     (const local_date&)      {return true;}
+    bool on_local_time     (const local_time&)      {return true;}
+
+    bool on_array_begin()        {return true;}
+    bool on_array_end()          {return true;}
+    bool on_inline_table_begin() {return true;}
+    bool on_inline_table_end()   {return true;}
+};
+
+namespace detail
+{
+
+template<typename Handler>
+bool emit_value_event(const reader& r, Handler& handler)
+{
+    switch(r.type())
+    {
+        case value_t::boolean        : {return handler.on_boolean        (r.as_boolean()        );}
+        case value_t::integer        : {return handler.on_integer        (r.as_integer()        );}
+        case value_t::floating       : {return handler.on_floating       (r.as_floating()       );}
+        case value_t::string         : {return handler.on_string         (r.as_string()         );}
+        case value_t::offset_datetime: {return handler.on_offset_datetime(r.as_offset_datetime());}
+        case value_t::local_datetime : {return handler.on_local_datetime (r.as_local_datetime() );}
+        case value_t::local_date     : {return handler.on_local_date     (r.as_local_date()     );}
+        case value_t::local_time     : {return handler.on_local_time     (r.as_local_time()     );}
+        default:
+        {
+            throw internal_error("toml::parse_events: unknown value type: " +
+                                 stringize(r.type()), r.location());
+        }
+    }
+}
+
+template<typename Handler>
+bool parse_events(reader& r, Handler& handler)
+{
+    while(true)
+    {
+        bool cont = true;
+        switch(r.next())
+        {
+            case token_t::end_of_file       : {return true;}
+            case token_t::table_header      : {cont = handler.on_table_header(r.keys());       break;}
+            case token_t::array_table_header: {cont = handler.on_array_table_header(r.keys()); break;}
+            case token_t::key               : {cont = handler.on_key(r.keys());                break;}
+            case token_t::value             : {cont = emit_value_event(r, handler);            break;}
+            case token_t::array_begin       : {cont = handler.on_array_begin();                break;}
+            case token_t::array_end         : {cont = handler.on_array_end();                  break;}
+            case token_t::inline_table_begin: {cont = handler.on_inline_table_begin();         break;}
+            case token_t::inline_table_end  : {cont = handler.on_inline_table_end();           break;}
+            default: {break;}
+        }
+        if(!cont)
+        {
+            return false;
+        }
+    }
+}
+
+} // detail
+
+// Reads a file and calls the handler. Returns false if the handler stops the
+// parsing. The file is mapped into memory if possible.
+template<typename Handler>
+bool parse_events(const std::string& fname, Handler& handler)
+{
+    reader r(fname);
+    return detail::parse_events(r, handler);
+}
+
+template<typename Handler>
+bool parse_events(std::istream& is, Handler& handler,
+                  std::string fname = "unknown file")
+{
+    reader r(is, std::move(fname));
+    return detail::parse_events(r, handler);
+}
+
+// The buffer is not copied. It should be alive while parsing.
+template<typename Handler>
+bool parse_events(const char* first, const std::size_t len, Handler& handler,
+                  std::string fname = "unknown file")
+{
+    reader r(first, len, std::move(fname));
+    return detail::parse_events(r, handler);
+}
+
+} // toml
+#endif// TOML11_EVENT_PARSER_HPP
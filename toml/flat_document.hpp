@@ -0,0 +1,661 @@
+//     Copyright Toru Niina 2017.
+// Distributed under the MIT License.
+#ifndef TOML11_FLAT_DOCUMENT_HPP
+#define TOML11_FLAT_DOCUMENT_HPP
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "binary.hpp"
+#include "mapped_file.hpp"
+#include "parser.hpp"
+#include "value.hpp"
+
+namespace toml
+{
+
+// A read-only format that can be queried without deserialization.
+//
+// Unlike save_binary, the values are stored as fixed-size nodes that point to
+// their contents by offsets, so a file can be mapped into memory and read in
+// place. Processes that map the same file share the pages in the page cache.
+//
+// layout (all the integers are little endian, offsets are from the beginning):
+//
+// ```
+// header := magic(8 bytes) version(u32) reserved(u32) size(u64) root(node)
+// node   := type(u8) kind(u8) reserved(u16) count(u32) payload(u64)
+// ```
+//
+// | type            | count           | payload                           |
+// |:----------------|:----------------|:----------------------------------|
+// | boolean         | -               | 0 or 1                            |
+// | integer         | -               | the value (two's complement)      |
+// | floating        | -               | IEEE 754 binary64                 |
+// | string          | length          | offset to the bytes               |
+// | datetime kinds  | -               | offset to a datetime record       |
+// | array           | # of elements   | offset to the nodes               |
+// | table           | # of entries    | offset to the entries, by key     |
+//
+// ```
+// entry    := key_length(u32) reserved(u32) key_offset(u64) value(node)
+// datetime := year(i16) month(u8) day(u8) hour(u8) minute(u8) second(u8)
+//             reserved(u8) millisecond(u16) microsecond(u16) nanosecond(u16)
+//             offset_hour(i8) offset_minute(i8)
+// ```
+//
+// The entries of a table are sorted by key, and found by binary search.
+// Comments and source regions are not stored.
+constexpr std::uint32_t flat_format_version = 1;
+
+namespace detail
+{
+constexpr std::size_t flat_magic_size    = 8;
+constexpr std::size_t flat_header_size   = 24;
+constexpr std::size_t flat_node_size     = 16;
+constexpr std::size_t flat_entry_size    = 32;
+constexpr std::size_t flat_datetime_size = 16;
+inline const char* flat_magic() noexcept {return "TOML11F\n";}
+
+inline std::uint64_t load_le(const char* p, const std::size_t n) noexcept
+{
+    std::uint64_t x = 0;
+    for(std::size_t i=0; i<n; ++i)
+    {
+        x |= static_cast<std::uint64_t>(static_cast<unsigned char>(p[i])) << (8 * i);
+    }
+    return x;
+}
+inline void store_le(char* p, const std::uint64_t x, const std::size_t n) noexcept
+{
+    for(std::size_t i=0; i<n; ++i)
+    {
+        p[i] = static_cast<char>(static_cast<unsigned char>(x >> (8 * i)));
+    }
+    return;
+}
+
+struct flat_writer
+{
+    // appends `n` zero bytes aligned to 8 bytes, and returns the offset.
+    std::size_t reserve(const std::size_t n)
+    {
+        buf_.resize((buf_.size() + 7) / 8 * 8);
+        const auto offset = buf_.size();
+        buf_.resize(offset + n, '\0');
+        return offset;
+    }
+    std::size_t append(const std::string& s)
+    {
+        const auto offset = buf_.size();
+        buf_.append(s);
+        return offset;
+    }
+
+    void datetime(const std::size_t at, const local_date& d, const local_time& t,
+                  const time_offset& o)
+    {
+        store_le(&buf_[at +  0], static_cast<std::uint16_t>(d.year), 2);
+        store_le(&buf_[at +  2], d.month,       1);
+        store_le(&buf_[at +  3], d.day,         1);
+        store_le(&buf_[at +  4], t.hour,        1);
+        store_le(&buf_[at +  5], t.minute,      1);
+        store_le(&buf_[at +  6], t.second,      1);
+        store_le(&buf_[at +  8], t.millisecond, 2);
+        store_le(&buf_[at + 10], t.microsecond, 2);
+        store_le(&buf_[at + 12], t.nanosecond,  2);
+        store_le(&buf_[at + 14], static_cast<std::uint8_t>(o.hour),   1);
+        store_le(&buf_[at + 15], static_cast<std::uint8_t>(o.minute), 1);
+    }
+
+    // writes the contents of `v` and the node at `at`.
+    template<typename Value>
+    void value(const std::size_t at, const Value& v)
+    {
+        std::uint8_t  kind    = 0;
+        std::uint64_t count   = 0;
+        std::uint64_t payload = 0;
+        switch(v.type())
+        {
+            case value_t::boolean : {payload = v.as_boolean() ? 1 : 0; break;}
+            case value_t::integer :
+            {
+                payload = static_cast<std::uint64_t>(v.as_integer());
+                break;
+            }
+            case value_t::floating:
+            {
+                const double f = v.as_floating();
+                static_assert(sizeof(f) == sizeof(payload), "double should be 64-bit");
+                std::memcpy(&payload, &f, sizeof(payload));
+                break;
+            }
+            case value_t::string:
+            {
+                kind    = static_cast<std::uint8_t>(v.as_string().kind);
+                count   = v.as_string().str.size();
+                payload = this->append(v.as_string().str);
+                break;
+            }
+            case value_t::offset_datetime:
+            {
+                const auto& odt = v.as_offset_datetime();
+                payload = this->reserve(flat_datetime_size);
+                this->datetime(payload, odt.date, odt.time, odt.offset);
+                break;
+            }
+            case value_t::local_datetime:
+            {
+                const auto& ldt = v.as_local_datetime();
+                payload = this->reserve(flat_datetime_size);
+                this->datetime(payload, ldt.date, ldt.time, time_offset());
+                break;
+            }
+            case value_t::local_date:
+            {
+                payload = this->reserve(flat_datetime_size);
+                this->datetime(payload, v.as_local_date(), local_time(), time_offset());
+                break;
+            }
+            case value_t::local_time:
+            {
+                payload = this->reserve(flat_datetime_size);
+                this->datetime(payload, local_date(), v.as_local_time(), time_offset());
+                break;
+            }
+            case value_t::array:
+            {
+                const auto& ary = v.as_array();
+                count   = ary.size();
+                payload = this->reserve(flat_node_size * ary.size());
+                std::size_t i = 0;
+                for(const auto& elem : ary)
+                {
+                    this->value(payload + flat_node_size * i++, elem);
+                }
+                break;
+            }
+            case value_t::table:
+            {
+                std::vector<const typename Value::table_type::value_type*> entries;
+                for(const auto& kv : v.as_table())
+                {
+                    entries.push_back(std::addressof(kv));
+                }
+                std::sort(entries.begin(), entries.end(),
+                    [](const typename Value::table_type::value_type* lhs,
+                       const typename Value::table_type::value_type* rhs) {
+                        return lhs->first < rhs->first;
+                    });
+
+                count   = entries.size();
+                payload = this->reserve(flat_entry_size * entries.size());
+                for(std::size_t i=0; i<entries.size(); ++i)
+                {
+                    const auto entry = payload + flat_entry_size * i;
+                    const auto key_offset = this->append(entries[i]->first);
+                    store_le(&buf_[entry + 0], entries[i]->first.size(), 4);
+                    store_le(&buf_[entry + 8], key_offset, 8);
+                    this->value(entry + 16, entries[i]->second);
+                }
+                break;
+            }
+            default: {break;}
+        }
+        if(0xFFFFFFFFu < count)
+        {
+            throw std::length_error("toml::save_flat: too many elements");
+        }
+        store_le(&buf_[at + 0], static_cast<std::uint8_t>(v.type()), 1);
+        store_le(&buf_[at + 1], kind,    1);
+        store_le(&buf_[at + 4], count,   4);
+        store_le(&buf_[at + 8], payload, 8);
+        return;
+    }
+
+    template<typename Value>
+    std::string write(const Value& v)
+    {
+        buf_.assign(flat_magic(), flat_magic_size);
+        this->reserve(flat_header_size - flat_magic_size + flat_node_size);
+        store_le(&buf_[8], flat_format_version, 4);
+        this->value(flat_header_size, v);
+        store_le(&buf_[16], buf_.size(), 8);
+        return std::move(buf_);
+    }
+
+  private:
+    std::string buf_;
+};
+} // detail
+
+// A view of a value in a flat document. It is valid while the document is
+// alive. All the accessors read the mapped bytes directly.
+class flat_value
+{
+  public:
+
+    flat_value(const char* first, const std::size_t size, const std::size_t node)
+        : first_(first), size_(size), node_(node)
+    {}
+
+    value_t type() const noexcept
+    {
+        const auto t = detail::load_le(first_ + node_, 1);
+        return (t <= static_cast<std::uint64_t>(value_t::table)) ?
+            static_cast<value_t>(t) : value_t::empty;
+    }
+    bool is_boolean()         const noexcept {return this->is(value_t::boolean        );}
+    bool is_integer()         const noexcept {return this->is(value_t::integer        );}
+    bool is_floating()        const noexcept {return this->is(value_t::floating       );}
+    bool is_string()          const noexcept {return this->is(value_t::string         );}
+    bool is_offset_datetime() const noexcept {return this->is(value_t::offset_datetime);}
+    bool is_local_datetime()  const noexcept {return this->is(value_t::local_datetime );}
+    bool is_local_date()      const noexcept {return this->is(value_t::local_date     );}
+    bool is_local_time()      const noexcept {return this->is(value_t::local_time     );}
+    bool is_array()           const noexcept {return this->is(value_t::array          );}
+    bool is_table()           const noexcept {return this->is(value_t::table          );}
+
+    boolean as_boolean() const
+    {
+        this->check_type(value_t::boolean, "as_boolean");
+        return this->payload() != 0;
+    }
+    integer as_integer() const
+    {
+        this->check_type(value_t::integer, "as_integer");
+        return static_cast<integer>(this->payload());
+    }
+    floating as_floating() const
+    {
+        this->check_type(value_t::floating, "as_floating");
+        const std::uint64_t bits = this->payload();
+        double f = 0.0;
+        std::memcpy(&f, &bits, sizeof(f));
+        return f;
+    }
+
+    // the string is not copied. The pointer refers to the document.
+    const char* string_data() const
+    {
+        this->check_type(value_t::string, "string_data");
+        return first_ + this->checked_range(this->payload(), this->count());
+    }
+    std::size_t string_size() const
+    {
+        this->check_type(value_t::string, "string_size");
+        return this->count();
+    }
+    std::string as_string() const
+    {
+        return std::string(this->string_data(), this->string_size());
+    }
+    string_t string_kind() const
+    {
+        this->check_type(value_t::string, "string_kind");
+        return static_cast<string_t>(detail::load_le(first_ + node_ + 1, 1));
+    }
+
+    offset_datetime as_offset_datetime() const
+    {
+        this->check_type(value_t::offset_datetime, "as_offset_datetime");
+        return offset_datetime(this->date(), this->time(), this->offset());
+    }
+    local_datetime as_local_datetime() const
+    {
+        this->check_type(value_t::local_datetime, "as_local_datetime");
+        return local_datetime(this->date(), this->time());
+    }
+    local_date as_local_date() const
+    {
+        this->check_type(value_t::local_date, "as_local_date");
+        return this->date();
+    }
+    local_time as_local_time() const
+    {
+        this->check_type(value_t::local_time, "as_local_time");
+        return this->time();
+    }
+
+    // the number of elements in an array or a table.
+    std::size_t size() const
+    {
+        if(!this->is_array() && !this->is_table())
+        {
+            this->throw_bad_cast(value_t::array, "size");
+        }
+        return this->count();
+    }
+
+    flat_value at(const std::size_t idx) const
+    {
+        this->check_type(value_t::array, "at");
+        if(this->count() <= idx)
+        {
+            throw std::out_of_range(concat_to_string("toml::flat_value::at: index ",
+                idx, " is out of range (size: ", this->count(), ")"));
+        }
+        const auto first = this->checked_range(this->payload(),
+                detail::flat_node_size * this->count());
+        return flat_value(first_, size_, first + detail::flat_node_size * idx);
+    }
+
+    flat_value at(const key& k) const
+    {
+        std::size_t node = 0;
+        if(!this->find_entry(k, node))
+        {
+            throw std::out_of_range(concat_to_string(
+                "toml::flat_value::at: key \"", k, "\" not found"));
+        }
+        return flat_value(first_, size_, node);
+    }
+    bool contains(const key& k) const
+    {
+        std::size_t node = 0;
+        return this->find_entry(k, node);
+    }
+    std::size_t count(const key& k) const
+    {
+        return this->contains(k) ? 1 : 0;
+    }
+
+    // to iterate over the entries of a table, sorted by key.
+    std::string key_at(const std::size_t idx) const
+    {
+        const auto entry = this->entry_at(idx);
+        const auto len   = detail::load_le(first_ + entry, 4);
+        const auto ofs   = this->checked_range(detail::load_le(first_ + entry + 8, 8), len);
+        return std::string(first_ + ofs, static_cast<std::size_t>(len));
+    }
+    flat_value value_at(const std::size_t idx) const
+    {
+        return flat_value(first_, size_, this->entry_at(idx) + 16);
+    }
+
+  private:
+
+    bool is(const value_t t) const noexcept {return this->type() == t;}
+
+    std::uint32_t count() const noexcept
+    {
+        return static_cast<std::uint32_t>(detail::load_le(first_ + node_ + 4, 4));
+    }
+    std::uint64_t payload() const noexcept
+    {
+        return detail::load_le(first_ + node_ + 8, 8);
+    }
+
+    // checks that [offset, offset+len) is in the document.
+    std::size_t checked_range(const std::uint64_t offset, const std::uint64_t len) const
+    {
+        if(size_ < offset || size_ - offset < len)
+        {
+            throw binary_format_error("toml::flat_value: broken document");
+        }
+        return static_cast<std::size_t>(offset);
+    }
+
+    std::size_t entry_at(const std::size_t idx) const
+    {
+        this->check_type(value_t::table, "key_at");
+        if(this->count() <= idx)
+        {
+            throw std::out_of_range(concat_to_string("toml::flat_value: index ",
+                idx, " is out of range (size: ", this->count(), ")"));
+        }
+        const auto first = this->checked_range(this->payload(),
+                detail::flat_entry_size * this->count());
+        return first + detail::flat_entry_size * idx;
+    }
+
+    bool find_entry(const key& k, std::size_t& node) const
+    {
+        this->check_type(value_t::table, "at");
+        const auto first = this->checked_range(this->payload(),
+                detail::flat_entry_size * this->count());
+
+        std::size_t lo = 0;
+        std::size_t hi = this->count();
+        while(lo < hi)
+        {
+            const auto mid   = lo + (hi - lo) / 2;
+            const auto entry = first + detail::flat_entry_size * mid;
+            const auto len   = detail::load_le(first_ + entry, 4);
+            const auto ofs   = this->checked_range(
+                    detail::load_le(first_ + entry + 8, 8), len);
+            const int cmp = k.compare(0, k.size(), first_ + ofs,
+                                      static_cast<std::size_t>(len));
+            if(cmp == 0)
+            {
+                node = entry + 16;
+                return true;
+            }
+            if(cmp < 0) {hi = mid;} else {lo = mid + 1;}
+        }
+        return false;
+    }
+
+    void check_type(const value_t expected, const char* func) const
+    {
+        if(!this->is(expected))
+        {
+            this->throw_bad_cast(expected, func);
+        }
+    }
+    [[noreturn]] void throw_bad_cast(const value_t expected, const char* func) const
+    {
+        throw type_error(concat_to_string("toml::flat_value::", func,
+            ": bad_cast to ", expected, ", the actual type is ", this->type()),
+            source_location());
+    }
+
+    std::size_t record() const
+    {
+        return this->checked_range(this->payload(), detail::flat_datetime_size);
+    }
+    local_date date() const
+    {
+        const char* p = first_ + this->record();
+        local_date d;
+        d.year  = static_cast<std::int16_t>(detail::load_le(p, 2));
+        d.month = static_cast<std::uint8_t>(detail::load_le(p + 2, 1));
+        d.day   = static_cast<std::uint8_t>(detail::load_le(p + 3, 1));
+        return d;
+    }
+    local_time time() const
+    {
+        const char* p = first_ + this->record();
+        local_time t;
+        t.hour        = static_cast<std::uint8_t >(detail::load_le(p +  4, 1));
+        t.minute      = static_cast<std::uint8_t >(detail::load_le(p +  5, 1));
+        t.second      = static_cast<std::uint8_t >(detail::load_le(p +  6, 1));
+        t.millisecond = static_cast<std::uint16_t>(detail::load_le(p +  8, 2));
+        t.microsecond = static_cast<std::uint16_t>(detail::load_le(p + 10, 2));
+        t.nanosecond  = static_cast<std::uint16_t>(detail::load_le(p + 12, 2));
+        return t;
+    }
+    time_offset offset() const
+    {
+        const char* p = first_ + this->record();
+        time_offset o;
+        o.hour   = static_cast<std::int8_t>(detail::load_le(p + 14, 1));
+        o.minute = static_cast<std::int8_t>(detail::load_le(p + 15, 1));
+        return o;
+    }
+
+  private:
+    const char* first_;
+    std::size_t size_;
+    std::size_t node_;
+};
+
+// A document in the flat format. It owns the bytes (or the mapping).
+class flat_document
+{
+  public:
+
+    // the file is mapped into memory if possible.
+    explicit flat_document(const std::string& fname)
+        : flat_document(open_file(fname), fname)
+    {}
+    flat_document(std::istream& is, const std::string& fname = "unknown file")
+        : flat_document(std::make_shared<detail::vector_source>(
+                    detail::read_stream(is)), fname)
+    {}
+
+    flat_value root() const
+    {
+        return flat_value(source_->begin(), this->size(), detail::flat_header_size);
+    }
+
+  private:
+
+    flat_document(std::shared_ptr<const detail::source_base> src,
+                  const std::string& fname)
+        : source_(std::move(src))
+    {
+        const char* p = source_->begin();
+        if(this->size() < detail::flat_header_size + detail::flat_node_size ||
+           !std::equal(p, p + detail::flat_magic_size, detail::flat_magic()))
+        {
+            throw binary_format_error("toml::flat_document: not a flat document \"" +
+                                      fname + "\"");
+        }
+        const auto version = detail::load_le(p + 8, 4);
+        if(version != flat_format_version)
+        {
+            throw binary_format_error(concat_to_string("toml::flat_document: "
+                "unsupported version ", version, " in \"", fname, "\""));
+        }
+        if(detail::load_le(p + 16, 8) != this->size())
+        {
+            throw binary_format_error("toml::flat_document: broken document \"" +
+                                      fname + "\"");
+        }
+    }
+
+    static std::shared_ptr<const detail::source_base>
+    open_file(const std::string& fname)
+    {
+#ifdef TOML11_HAS_MMAP
+        return std::make_shared<detail::mapped_file_source>(fname);
+#else
+        std::ifstream ifs(fname, std::ios_base::binary);
+        if(!ifs.good())
+        {
+            throw std::ios_base::failure(
+                    "toml::flat_document: Error opening file \"" + fname + "\"");
+        }
+        ifs.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+        return std::make_shared<detail::vector_source>(detail::read_stream(ifs));
+#endif
+    }
+
+    std::size_t size() const noexcept
+    {
+        return static_cast<std::size_t>(source_->end() - source_->begin());
+    }
+
+  private:
+    std::shared_ptr<const detail::source_base> source_;
+};
+
+// ----------------------------------------------------------------------------
+// find(flat_value, keys...) in the same way as find(basic_value, keys...)
+
+inline flat_value find(const flat_value& v, const key& ky)
+{
+    return v.at(ky);
+}
+inline flat_value find(const flat_value& v, const std::size_t idx)
+{
+    return v.at(idx);
+}
+template<typename Key1, typename Key2, typename ... Keys>
+flat_value find(const flat_value& v, Key1&& k1, Key2&& k2, Keys&& ... keys)
+{
+    return find(find(v, std::forward<Key1>(k1)),
+                std::forward<Key2>(k2), std::forward<Keys>(keys)...);
+}
+
+namespace detail
+{
+template<typename T>
+struct flat_getter;
+
+template<> struct flat_getter<boolean>
+{static boolean get(const flat_value& v) {return v.as_boolean();}};
+template<> struct flat_getter<floating>
+{static floating get(const flat_value& v) {return v.as_floating();}};
+template<> struct flat_getter<std::string>
+{static std::string get(const flat_value& v) {return v.as_string();}};
+template<> struct flat_getter<offset_datetime>
+{static offset_datetime get(const flat_value& v) {return v.as_offset_datetime();}};
+template<> struct flat_getter<local_datetime>
+{static local_datetime get(const flat_value& v) {return v.as_local_datetime();}};
+template<> struct flat_getter<local_date>
+{static local_date get(const flat_value& v) {return v.as_local_date();}};
+template<> struct flat_getter<local_time>
+{static local_time get(const flat_value& v) {return v.as_local_time();}};
+template<> struct flat_getter<flat_value>
+{static flat_value get(const flat_value& v) {return v;}};
+} // detail
+
+// find<T>(flat_value, keys...). T is one of boolean, integral types, floating,
+// std::string, datetime types or flat_value.
+template<typename T, typename ... Keys>
+typename std::enable_if<std::is_integral<T>::value &&
+    !std::is_same<T, boolean>::value, T>::type
+find(const flat_value& v, Keys&& ... keys)
+{
+    const auto i = find(v, std::forward<Keys>(keys)...).as_integer();
+    if(i < static_cast<integer>((std::numeric_limits<T>::min)()) ||
+       static_cast<integer>((std::numeric_limits<T>::max)()) < i)
+    {
+        throw std::out_of_range(concat_to_string(
+            "toml::find: integer ", i, " is out of range of the requested type"));
+    }
+    return static_cast<T>(i);
+}
+template<typename T, typename ... Keys>
+typename std::enable_if<!std::is_integral<T>::value ||
+    std::is_same<T, boolean>::value, T>::type
+find(const flat_value& v, Keys&& ... keys)
+{
+    return detail::flat_getter<T>::get(find(v, std::forward<Keys>(keys)...));
+}
+
+// Writes a value in the flat format.
+template<typename C, template<typename ...> class M, template<typename ...> class V>
+void save_flat(std::ostream& os, const basic_value<C, M, V>& v)
+{
+    const auto buf = detail::flat_writer().write(v);
+    os.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+    return;
+}
+
+template<typename C, template<typename ...> class M, template<typename ...> class V>
+void save_flat(const basic_value<C, M, V>& v, const std::string& fname)
+{
+    std::ofstream ofs(fname, std::ios_base::binary);
+    if(!ofs.good())
+    {
+        throw std::ios_base::failure(
+                "toml::save_flat: Error opening file \"" + fname + "\"");
+    }
+    ofs.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+    save_flat(ofs, v);
+    return;
+}
+
+} // toml
+#endif// TOML11_FLAT_DOCUMENT_HPP
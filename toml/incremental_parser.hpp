@@ -0,0 +1,355 @@
+//     Copyright Toru Niina 2017.
+// Distributed under the MIT License.
+#ifndef TOML11_INCREMENTAL_PARSER_HPP
+#define TOML11_INCREMENTAL_PARSER_HPP
+#include <algorithm>
+#include <fstream>
+#include <istream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "parallel_parser.hpp"
+#include "parser.hpp"
+
+namespace toml
+{
+namespace detail
+{
+
+// moves a region onto the source of `to`. The bytes of the region should be
+// found `shift` bytes after the same offset in `to`.
+inline region rebase_region(const region& reg, const location& to,
+                            const std::ptrdiff_t shift)
+{
+    const auto first = to.begin() + (reg.first() - reg.begin()) + shift;
+    return region(to, first, first + (reg.last() - reg.first()));
+}
+
+// moves the regions in a value that refer to `from` onto the source of `to`,
+// so that the value does not keep the previous content alive.
+template<typename Value>
+void rebase_regions(Value& v, const source_base* from, const location& to,
+                    const std::ptrdiff_t shift)
+{
+    if(const auto reg = dynamic_cast<const region*>(get_region(v)))
+    {
+        if(reg->source().get() == from)
+        {
+            change_region(v, rebase_region(*reg, to, shift));
+        }
+    }
+    if(v.is_array())
+    {
+        for(auto& elem : v.as_array()) {rebase_regions(elem, from, to, shift);}
+    }
+    else if(v.is_table())
+    {
+        for(auto& kv : v.as_table()) {rebase_regions(kv.second, from, to, shift);}
+    }
+    return;
+}
+
+} // detail
+
+// A document that can be updated by reparsing only the edited part.
+//
+// It keeps the root table and each [table] and [[array.of.tables]] section as
+// they were parsed, in addition to the merged value. When the content is
+// updated, the sections before the first changed byte and the sections after
+// the last changed byte are reused, and the parser runs only between them.
+// The sections are merged again in the same way as toml::parse, so the result
+// and the errors are the same as parsing the new content from scratch. The
+// reused sections are moved onto the new content, so the line numbers in
+// error messages about them are also up to date.
+//
+// ```cpp
+// auto doc = toml::parse_incremental("large.toml");
+// // ... the file is edited ...
+// doc.update(read_file("large.toml")); // finds changed part by comparing
+// const auto& v = doc.value();
+// ```
+//
+// Note that the merged value is built from copies of the sections on every
+// update. It is much faster than parsing them, but not free. A section is not
+// reused if the comments above its header were changed.
+template<typename                     Comment = TOML11_DEFAULT_COMMENT_STRATEGY,
+         template<typename ...> class Table   = std::unordered_map,
+         template<typename ...> class Array   = std::vector>
+class incremental_document
+{
+  public:
+    using value_type = basic_value<Comment, Table, Array>;
+    using table_type = typename value_type::table_type;
+
+    // [first, last) in bytes.
+    using byte_range = std::pair<std::size_t, std::size_t>;
+
+  public:
+
+    explicit incremental_document(detail::location loc)
+        : loc_(loc), root_last_(0)
+    {
+        this->reparse(std::move(loc), 0, 0);
+    }
+
+    incremental_document(const incremental_document&) = default;
+    incremental_document(incremental_document&&)      = default;
+    incremental_document& operator=(const incremental_document&) = default;
+    incremental_document& operator=(incremental_document&&)      = default;
+    ~incremental_document() = default;
+
+    value_type const& value() const noexcept {return value_;}
+
+    // replaces the content. The changed part is found by comparing the new
+    // content with the current one.
+    //
+    // If the new content has a syntax error, it throws toml::syntax_error and
+    // the document is not modified.
+    void update(std::string content)
+    {
+        detail::location loc(loc_.name(),
+            std::make_shared<detail::string_source>(std::move(content)));
+
+        const auto old_size = static_cast<std::size_t>(loc_.end() - loc_.begin());
+        const auto new_size = static_cast<std::size_t>(loc.end()  - loc.begin());
+        const auto n = std::min(old_size, new_size);
+
+        const auto prefix = static_cast<std::size_t>(std::mismatch(
+            loc_.begin(), loc_.begin() + n, loc.begin()).first - loc_.begin());
+
+        using reverse_iterator = std::reverse_iterator<const char*>;
+        const reverse_iterator old_rbegin(loc_.end());
+        const reverse_iterator new_rbegin(loc.end());
+        const auto suffix = static_cast<std::size_t>(std::mismatch(
+            old_rbegin, old_rbegin + static_cast<std::ptrdiff_t>(n - prefix),
+            new_rbegin).first - old_rbegin);
+
+        this->reparse(std::move(loc), prefix, suffix);
+    }
+
+    // replaces the content. The ranges are the parts of the new content that
+    // are different from the current one, e.g. the lines edited by a user.
+    // All the changed bytes should be covered; the bytes before the first
+    // range and after the last range are assumed to be the same as before.
+    void update(std::string content, const std::vector<byte_range>& changed)
+    {
+        detail::location loc(loc_.name(),
+            std::make_shared<detail::string_source>(std::move(content)));
+
+        const auto old_size = static_cast<std::size_t>(loc_.end() - loc_.begin());
+        const auto new_size = static_cast<std::size_t>(loc.end()  - loc.begin());
+        const auto n = std::min(old_size, new_size);
+
+        std::size_t first = new_size;
+        std::size_t last  = 0;
+        for(const auto& range : changed)
+        {
+            first = std::min(first, range.first);
+            last  = std::max(last,  range.second);
+        }
+        const auto prefix = std::min(first, n);
+        const auto suffix = std::min(new_size - std::min(last, new_size), n - prefix);
+
+        this->reparse(std::move(loc), prefix, suffix);
+    }
+
+  private:
+
+    // parses `loc` reusing the sections in the first `prefix` bytes and the
+    // last `suffix` bytes that are common to the current and the new content.
+    void reparse(detail::location loc, const std::size_t prefix,
+                 const std::size_t suffix)
+    {
+        const auto old_size = static_cast<std::size_t>(loc_.end() - loc_.begin());
+        const auto new_size = static_cast<std::size_t>(loc.end()  - loc.begin());
+        const auto offset = [&loc](const char* iter) -> std::size_t {
+            return static_cast<std::size_t>(iter - loc.begin());
+        };
+
+        detail::skip_bom(loc);
+        const auto first = loc.iter();
+        if(first == loc.end())
+        {
+            this->value_ = value_type(table_type{}, detail::region(loc, first, first),
+                                      std::vector<std::string>{});
+            this->loc_       = std::move(loc);
+            this->root_      = table_type{};
+            this->root_last_ = 0;
+            this->sections_.clear();
+            this->ranges_.clear();
+            return;
+        }
+        const detail::region file(loc, first, std::next(loc.iter()));
+        std::vector<std::string> comments = detail::parse_file_comments(loc);
+
+        // To find the end of a table, parse_ml_table reads the next header
+        // line. So a table can be reused only if the next line is unchanged.
+        const auto is_reusable = [this, prefix](const std::size_t last) {
+            const auto nl = std::find(loc_.begin() + last, loc_.end(), '\n');
+            return nl != loc_.end() &&
+                   static_cast<std::size_t>(nl - loc_.begin()) < prefix;
+        };
+
+        // the reused values are moved onto the new content. `shift` is the
+        // distance between the same bytes in the current and the new content.
+        const detail::source_base* const current = this->loc_.source().get();
+        const auto reuse = [&](const std::size_t idx, const std::ptrdiff_t shift)
+            -> detail::parsed_section<value_type>
+        {
+            auto sec = this->sections_.at(idx);
+            sec.reg = detail::rebase_region(sec.reg, loc, shift);
+            for(auto& kv : sec.table)
+            {
+                detail::rebase_regions(kv.second, current, loc, shift);
+            }
+            return sec;
+        };
+
+        table_type root;
+        if(is_reusable(this->root_last_))
+        {
+            root = this->root_;
+            for(auto& kv : root)
+            {
+                detail::rebase_regions(kv.second, current, loc, 0);
+            }
+            loc.reset(loc.begin() + this->root_last_);
+        }
+        else
+        {
+            auto tab = detail::parse_ml_table<value_type>(loc);
+            if(!tab)
+            {
+                throw syntax_error(tab.unwrap_err(), source_location(loc));
+            }
+            root = std::move(tab.unwrap());
+        }
+        const std::size_t root_last = offset(loc.iter());
+
+        std::vector<detail::parsed_section<value_type>> sections;
+        std::vector<byte_range>                         ranges;
+        std::size_t i = 0;
+        for(; i < sections_.size() && is_reusable(ranges_.at(i).second); ++i)
+        {
+            sections.push_back(reuse(i, 0));
+            ranges.push_back(ranges_.at(i));
+        }
+        if(!ranges.empty())
+        {
+            loc.reset(loc.begin() + ranges.back().second);
+        }
+
+        // the sections that start after the changed part can be reused if the
+        // parser reaches the beginning of them.
+        const auto suffix_first = old_size - suffix;
+        while(i < sections_.size() && ranges_.at(i).first < suffix_first)
+        {
+            ++i;
+        }
+        const auto shifted = [old_size, new_size](const std::size_t pos) {
+            return new_size - (old_size - pos);
+        };
+
+        // the comments of a header are the comment lines just above it, and
+        // they are read from the source when the sections are merged. They
+        // are parsed as a part of the previous section, so a section in the
+        // suffix can be reused only if those lines, and the line above them
+        // that ends the comments, are unchanged.
+        const auto comments_first = [&loc](const char* header) -> const char* {
+            using reverse_iterator = std::reverse_iterator<const char*>;
+            const char* line = std::find(reverse_iterator(header),
+                    reverse_iterator(loc.begin()), '\n').base();
+            while(line != loc.begin())
+            {
+                const char* const prev_last = std::prev(line);
+                line = std::find(reverse_iterator(prev_last),
+                        reverse_iterator(loc.begin()), '\n').base();
+                const char* const c = std::find_if(line, prev_last,
+                        [](const char ch) {return ch != ' ' && ch != '\t';});
+                if(c == prev_last || *c != '#')
+                {
+                    break;
+                }
+            }
+            return line;
+        };
+        const auto suffix_first_new = new_size - suffix;
+
+        while(loc.iter() != loc.end())
+        {
+            const auto pos = offset(loc.iter());
+            while(i < sections_.size() && shifted(ranges_.at(i).first) < pos)
+            {
+                ++i;
+            }
+            if(i < sections_.size() && shifted(ranges_.at(i).first) == pos &&
+               suffix_first_new <= offset(comments_first(loc.iter())))
+            {
+                const auto shift = static_cast<std::ptrdiff_t>(new_size) -
+                                   static_cast<std::ptrdiff_t>(old_size);
+                for(; i < sections_.size(); ++i)
+                {
+                    sections.push_back(reuse(i, shift));
+                    ranges.emplace_back(shifted(ranges_.at(i).first),
+                                        shifted(ranges_.at(i).second));
+                }
+                break;
+            }
+            sections.push_back(detail::parse_section<value_type>(loc));
+            ranges.emplace_back(pos, offset(loc.iter()));
+        }
+
+        table_type data(root);
+        detail::insert_sections<value_type>(data, sections, loc);
+
+        this->value_     = value_type(std::move(data), file, comments);
+        this->loc_       = std::move(loc);
+        this->root_      = std::move(root);
+        this->root_last_ = root_last;
+        this->sections_  = std::move(sections);
+        this->ranges_    = std::move(ranges);
+        return;
+    }
+
+  private:
+
+    detail::location loc_;
+    value_type       value_;
+
+    table_type  root_;
+    std::size_t root_last_; // the end of the root table
+    std::vector<detail::parsed_section<value_type>> sections_;
+    std::vector<byte_range>                         ranges_;
+};
+
+template<typename                     Comment = TOML11_DEFAULT_COMMENT_STRATEGY,
+         template<typename ...> class Table   = std::unordered_map,
+         template<typename ...> class Array   = std::vector>
+incremental_document<Comment, Table, Array>
+parse_incremental(std::istream& is, std::string fname = "unknown file")
+{
+    return incremental_document<Comment, Table, Array>(
+        detail::location(std::move(fname), detail::read_stream(is)));
+}
+
+// the file is read into a buffer instead of being mapped into memory, because
+// it is expected to be modified while the document is alive.
+template<typename                     Comment = TOML11_DEFAULT_COMMENT_STRATEGY,
+         template<typename ...> class Table   = std::unordered_map,
+         template<typename ...> class Array   = std::vector>
+incremental_document<Comment, Table, Array>
+parse_incremental(const std::string& fname)
+{
+    std::ifstream ifs(fname, std::ios_base::binary);
+    if(!ifs.good())
+    {
+        throw std::ios_base::failure(
+                "toml::parse: Error opening file \"" + fname + "\"");
+    }
+    ifs.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+    return parse_incremental<Comment, Table, Array>(ifs, fname);
+}
+
+} // toml
+#endif// TOML11_INCREMENTAL_PARSER_HPP
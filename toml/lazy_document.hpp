@@ -0,0 +1,247 @@
+//     Copyright Toru Niina 2017.
+// Distributed under the MIT License.
+#ifndef TOML11_LAZY_DOCUMENT_HPP
+#define TOML11_LAZY_DOCUMENT_HPP
+#include <fstream>
+#include <istream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "get.hpp"
+#include "parser.hpp"
+#include "scanner.hpp"
+
+namespace toml
+{
+
+// A document that parses values on the first access.
+//
+// toml::parse_lazy only scans the file for [table] and [[array.of.tables]]
+// headers. When a top-level key is accessed by `at` or `find`, it parses the
+// root table and the sections whose header starts with the key, and merges
+// them in the same way as toml::parse. So the cost depends on the amount of
+// the tables you read, not the size of the file.
+//
+// Syntax errors in a section are reported when the section is parsed, and the
+// errors in sections that are never accessed are not reported at all.
+// The accessors modify the cache, so it is not thread-safe.
+template<typename                     Comment = TOML11_DEFAULT_COMMENT_STRATEGY,
+         template<typename ...> class Table   = std::unordered_map,
+         template<typename ...> class Array   = std::vector>
+class lazy_document
+{
+  public:
+    using value_type = basic_value<Comment, Table, Array>;
+    using table_type = typename value_type::table_type;
+
+  public:
+
+    explicit lazy_document(detail::location loc)
+        : loc_(std::move(loc)), root_parsed_(false)
+    {
+        detail::skip_bom(loc_);
+        this->root_ = loc_.iter();
+
+        const char* iter = detail::find_table_header(loc_.iter(), loc_.end());
+        while(iter != loc_.end())
+        {
+            loc_.reset(iter);
+            if(auto aot = detail::parse_array_table_key(loc_))
+            {
+                sections_.push_back(section{iter,
+                        std::move(aot.unwrap().first), true});
+            }
+            else if(auto tab = detail::parse_table_key(loc_))
+            {
+                sections_.push_back(section{iter,
+                        std::move(tab.unwrap().first), false});
+            }
+            else
+            {
+                throw syntax_error(tab.unwrap_err(), source_location(loc_));
+            }
+            iter = detail::find_table_header(loc_.iter(), loc_.end());
+        }
+    }
+
+    lazy_document(const lazy_document&) = default;
+    lazy_document(lazy_document&&)      = default;
+    lazy_document& operator=(const lazy_document&) = default;
+    lazy_document& operator=(lazy_document&&)      = default;
+    ~lazy_document() = default;
+
+    bool contains(const key& k) const
+    {
+        for(const auto& sec : sections_)
+        {
+            if(sec.keys.front() == k) {return true;}
+        }
+        return this->root_table().count(k) != 0;
+    }
+    std::size_t count(const key& k) const
+    {
+        return this->contains(k) ? 1 : 0;
+    }
+
+    // parses the value corresponding to the top-level key on the first call.
+    value_type const& at(const key& k) const
+    {
+        const auto found = cache_.find(k);
+        if(found != cache_.end())
+        {
+            return found->second;
+        }
+
+        table_type tab;
+        const auto& root = this->root_table();
+        if(root.count(k) != 0)
+        {
+            tab[k] = root.at(k);
+        }
+
+        bool is_found = !tab.empty();
+        for(const auto& sec : sections_)
+        {
+            if(sec.keys.front() != k)
+            {
+                continue;
+            }
+            is_found = true;
+
+            loc_.reset(sec.first);
+            auto tabkey = sec.is_array_table ?
+                detail::parse_array_table_key(loc_) : detail::parse_table_key(loc_);
+            const auto& reg = tabkey.unwrap().second;
+
+            const auto body = detail::parse_ml_table<value_type>(loc_);
+            if(!body)
+            {
+                throw syntax_error(body.unwrap_err(), source_location(loc_));
+            }
+            const auto inserted = detail::insert_nested_key(tab,
+                    value_type(body.unwrap(), reg, reg.comments()),
+                    sec.keys.begin(), sec.keys.end(), reg, sec.is_array_table);
+            if(!inserted)
+            {
+                throw syntax_error(inserted.unwrap_err(), source_location(loc_));
+            }
+        }
+        if(!is_found)
+        {
+            loc_.reset(loc_.begin());
+            throw std::out_of_range(detail::format_underline(concat_to_string(
+                "key \"", k, "\" not found in the top-level table"), {
+                    {source_location(loc_), "in this file"}
+                }));
+        }
+        return cache_.emplace(k, std::move(tab.at(k))).first->second;
+    }
+
+  private:
+
+    table_type const& root_table() const
+    {
+        if(!root_parsed_)
+        {
+            loc_.reset(root_);
+            auto tab = detail::parse_ml_table<value_type>(loc_);
+            if(!tab)
+            {
+                throw syntax_error(tab.unwrap_err(), source_location(loc_));
+            }
+            root_table_  = std::move(tab.unwrap());
+            root_parsed_ = true;
+        }
+        return root_table_;
+    }
+
+  private:
+
+    struct section
+    {
+        const char*      first; // `[`
+        std::vector<key> keys;
+        bool             is_array_table;
+    };
+
+    mutable detail::location loc_;
+    const char*              root_;
+    std::vector<section>     sections_;
+
+    mutable bool             root_parsed_;
+    mutable table_type       root_table_;
+    // std::unordered_map does not invalidate references on insertion
+    mutable std::unordered_map<key, value_type> cache_;
+};
+
+template<typename                     Comment = TOML11_DEFAULT_COMMENT_STRATEGY,
+         template<typename ...> class Table   = std::unordered_map,
+         template<typename ...> class Array   = std::vector>
+lazy_document<Comment, Table, Array>
+parse_lazy(std::istream& is, std::string fname = "unknown file")
+{
+    return lazy_document<Comment, Table, Array>(
+        detail::location(std::move(fname), detail::read_stream(is)));
+}
+
+// the file is mapped into memory if possible.
+template<typename                     Comment = TOML11_DEFAULT_COMMENT_STRATEGY,
+         template<typename ...> class Table   = std::unordered_map,
+         template<typename ...> class Array   = std::vector>
+lazy_document<Comment, Table, Array> parse_lazy(const std::string& fname)
+{
+#ifdef TOML11_HAS_MMAP
+    return lazy_document<Comment, Table, Array>(detail::location(fname,
+            std::make_shared<detail::mapped_file_source>(fname)));
+#else
+    std::ifstream ifs(fname, std::ios_base::binary);
+    if(!ifs.good())
+    {
+        throw std::ios_base::failure(
+                "toml::parse: Error opening file \"" + fname + "\"");
+    }
+    ifs.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+    return parse_lazy<Comment, Table, Array>(ifs, fname);
+#endif
+}
+
+// ----------------------------------------------------------------------------
+// find(lazy_document, keys...) is the same as find(doc.at(key), keys...).
+
+template<typename C,
+         template<typename ...> class M, template<typename ...> class V>
+basic_value<C, M, V> const& find(const lazy_document<C, M, V>& doc, const key& ky)
+{
+    return doc.at(ky);
+}
+
+template<typename C,
+         template<typename ...> class M, template<typename ...> class V,
+         typename K1, typename ... Ks>
+basic_value<C, M, V> const&
+find(const lazy_document<C, M, V>& doc, const key& ky, K1&& k1, Ks&& ... keys)
+{
+    return ::toml::find(doc.at(ky), std::forward<K1>(k1), std::forward<Ks>(keys)...);
+}
+
+template<typename T, typename C,
+         template<typename ...> class M, template<typename ...> class V>
+decltype(::toml::get<T>(std::declval<basic_value<C, M, V> const&>()))
+find(const lazy_document<C, M, V>& doc, const key& ky)
+{
+    return ::toml::get<T>(doc.at(ky));
+}
+
+template<typename T, typename C,
+         template<typename ...> class M, template<typename ...> class V,
+         typename K1, typename ... Ks>
+decltype(::toml::get<T>(std::declval<basic_value<C, M, V> const&>()))
+find(const lazy_document<C, M, V>& doc, const key& ky, K1&& k1, Ks&& ... keys)
+{
+    return ::toml::find<T>(doc.at(ky), std::forward<K1>(k1), std::forward<Ks>(keys)...);
+}
+
+} // toml
+#endif// TOML11_LAZY_DOCUMENT_HPP
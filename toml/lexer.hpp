@@ -7,6 +7,7 @@
 #include <stdexcept>
 
 #include "combinator.hpp"
+#include "simd.hpp"
 
 namespace toml
 {
@@ -17,18 +18,80 @@ namespace detail
 // and extract a region that matches their own pattern.
 // to see the implementation of each component, see combinator.hpp.
 
+// repeat<Elem, unlimited> that skips the characters in `Class` by a SIMD kernel
+// (see simd.hpp) and tries `Elem` only where the kernel stops. Every character
+// in `Class` should be matched by `Elem` one by one.
+template<typename Elem, typename Class>
+struct repeat_skipping
+{
+    static result<span, none_t>
+    scan(location& loc)
+    {
+        const auto first = loc.iter();
+        while(true)
+        {
+            const auto skipped = skip_class<Class>(loc.iter(), loc.end());
+            loc.advance(skipped - loc.iter());
+            if(Elem::scan(loc).is_err())
+            {
+                return ok(span{first, loc.iter()});
+            }
+        }
+    }
+    static result<region, none_t>
+    invoke(location& loc)
+    {
+        return to_region(loc, scan(loc));
+    }
+};
+
 using lex_wschar  = either<character<' '>, character<'\t'>>;
+
+// a run of whitespaces is skipped by a SIMD kernel (see simd.hpp).
+template<>
+struct repeat<lex_wschar, at_least<1>>
+{
+    static result<span, none_t>
+    scan(location& loc)
+    {
+        const auto first = loc.iter();
+        const auto last  = skip_ws(first, loc.end());
+        if(first == last)
+        {
+            return none();
+        }
+        loc.advance(last - first); // no newline in between
+        return ok(span{first, last});
+    }
+    static result<region, none_t>
+    invoke(location& loc)
+    {
+        return to_region(loc, scan(loc));
+    }
+};
 using lex_ws      = repeat<lex_wschar, at_least<1>>;
 using lex_newline = either<character<'\n'>,
                            sequence<character<'\r'>, character<'\n'>>>;
+// the end of a line. the last line of a file may end without a newline.
+using lex_line_end = either<lex_newline, end_of_file>;
 using lex_lower   = in_range<'a', 'z'>;
 using lex_upper   = in_range<'A', 'Z'>;
-using lex_alpha   = either<lex_lower, lex_upper>;
+using lex_alpha   = char_in_class<char_class_alpha>;
 using lex_digit   = in_range<'0', '9'>;
 using lex_nonzero = in_range<'1', '9'>;
 using lex_oct_dig = in_range<'0', '7'>;
 using lex_bin_dig = in_range<'0', '1'>;
-using lex_hex_dig = either<lex_digit, in_range<'A', 'F'>, in_range<'a', 'f'>>;
+using lex_hex_dig = char_in_class<char_class_hex>;
+
+// N*(digit | _ digit), and so on.
+template<std::size_t N>
+using lex_dec_digits = char_class_run<char_class_digit, true, N>;
+template<std::size_t N>
+using lex_hex_digits = char_class_run<char_class_hex, true, N>;
+template<std::size_t N>
+using lex_oct_digits = char_class_run<char_class_oct, true, N>;
+template<std::size_t N>
+using lex_bin_digits = char_class_run<char_class_bin, true, N>;
 
 using lex_hex_prefix = sequence<character<'0'>, character<'x'>>;
 using lex_oct_prefix = sequence<character<'0'>, character<'o'>>;
@@ -39,21 +102,17 @@ using lex_minus      = character<'-'>;
 using lex_sign       = either<lex_plus, lex_minus>;
 
 // digit | nonzero 1*(digit | _ digit)
-using lex_unsigned_dec_int = either<sequence<lex_nonzero, repeat<
-    either<lex_digit, sequence<lex_underscore, lex_digit>>, at_least<1>>>,
-    lex_digit>;
+using lex_unsigned_dec_int = either<sequence<lex_nonzero, lex_dec_digits<1>>,
+                                    lex_digit>;
 // (+|-)? unsigned_dec_int
 using lex_dec_int = sequence<maybe<lex_sign>, lex_unsigned_dec_int>;
 
 // hex_prefix hex_dig *(hex_dig | _ hex_dig)
-using lex_hex_int = sequence<lex_hex_prefix, sequence<lex_hex_dig, repeat<
-    either<lex_hex_dig, sequence<lex_underscore, lex_hex_dig>>, unlimited>>>;
+using lex_hex_int = sequence<lex_hex_prefix, lex_hex_dig, lex_hex_digits<0>>;
 // oct_prefix oct_dig *(oct_dig | _ oct_dig)
-using lex_oct_int = sequence<lex_oct_prefix, sequence<lex_oct_dig, repeat<
-    either<lex_oct_dig, sequence<lex_underscore, lex_oct_dig>>, unlimited>>>;
+using lex_oct_int = sequence<lex_oct_prefix, lex_oct_dig, lex_oct_digits<0>>;
 // bin_prefix bin_dig *(bin_dig | _ bin_dig)
-using lex_bin_int = sequence<lex_bin_prefix, sequence<lex_bin_dig, repeat<
-    either<lex_bin_dig, sequence<lex_underscore, lex_bin_dig>>, unlimited>>>;
+using lex_bin_int = sequence<lex_bin_prefix, lex_bin_dig, lex_bin_digits<0>>;
 
 // (dec_int | hex_int | oct_int | bin_int)
 using lex_integer = either<lex_bin_int, lex_oct_int, lex_hex_int, lex_dec_int>;
@@ -64,8 +123,7 @@ using lex_inf = sequence<character<'i'>, character<'n'>, character<'f'>>;
 using lex_nan = sequence<character<'n'>, character<'a'>, character<'n'>>;
 using lex_special_float = sequence<maybe<lex_sign>, either<lex_inf, lex_nan>>;
 
-using lex_zero_prefixable_int = sequence<lex_digit, repeat<either<lex_digit,
-    sequence<lex_underscore, lex_digit>>, unlimited>>;
+using lex_zero_prefixable_int = sequence<lex_digit, lex_dec_digits<0>>;
 
 using lex_fractional_part = sequence<character<'.'>, lex_zero_prefixable_int>;
 
@@ -140,6 +198,10 @@ using lex_escape_seq_char = either<character<'"'>, character<'\\'>,
                                    >;
 using lex_escaped      = sequence<lex_escape, lex_escape_seq_char>;
 using lex_basic_char   = either<lex_basic_unescaped, lex_escaped>;
+template<>
+struct repeat<lex_basic_char, unlimited>
+    : repeat_skipping<lex_basic_char, basic_string_body_class>
+{};
 using lex_basic_string = sequence<lex_quotation_mark,
                                   repeat<lex_basic_char, unlimited>,
                                   lex_quotation_mark>;
@@ -191,15 +253,23 @@ using lex_ml_basic_escaped_newline = sequence<
         repeat<either<lex_ws, lex_newline>, unlimited>>;
 
 using lex_ml_basic_char = either<lex_ml_basic_unescaped, lex_escaped>;
-using lex_ml_basic_body = repeat<either<lex_ml_basic_char, lex_newline,
-                                        lex_ml_basic_escaped_newline>,
-                                 unlimited>;
+using lex_ml_basic_body_char = either<lex_ml_basic_char, lex_newline,
+                                     lex_ml_basic_escaped_newline>;
+template<>
+struct repeat<lex_ml_basic_body_char, unlimited>
+    : repeat_skipping<lex_ml_basic_body_char, ml_basic_string_body_class>
+{};
+using lex_ml_basic_body = repeat<lex_ml_basic_body_char, unlimited>;
 using lex_ml_basic_string = sequence<lex_ml_basic_string_open,
                                      lex_ml_basic_body,
                                      lex_ml_basic_string_close>;
 
 using lex_literal_char = exclude<either<in_range<0x00, 0x08>, in_range<0x0A, 0x1F>,
                                         character<0x7F>, character<0x27>>>;
+template<>
+struct repeat<lex_literal_char, unlimited>
+    : repeat_skipping<lex_literal_char, literal_string_body_class>
+{};
 using lex_apostrophe = character<'\''>;
 using lex_literal_string = sequence<lex_apostrophe,
                                     repeat<lex_literal_char, unlimited>,
@@ -217,8 +287,12 @@ using lex_ml_literal_char = exclude<either<in_range<0x00, 0x08>,
                                            in_range<0x0A, 0x1F>,
                                            character<0x7F>,
                                            lex_ml_literal_string_delim>>;
-using lex_ml_literal_body = repeat<either<lex_ml_literal_char, lex_newline>,
-                                   unlimited>;
+using lex_ml_literal_body_char = either<lex_ml_literal_char, lex_newline>;
+template<>
+struct repeat<lex_ml_literal_body_char, unlimited>
+    : repeat_skipping<lex_ml_literal_body_char, ml_literal_string_body_class>
+{};
+using lex_ml_literal_body = repeat<lex_ml_literal_body_char, unlimited>;
 using lex_ml_literal_string = sequence<lex_ml_literal_string_open,
                                        lex_ml_literal_body,
                                        lex_ml_literal_string_close>;
@@ -229,9 +303,8 @@ using lex_string = either<lex_ml_basic_string,   lex_basic_string,
 // ===========================================================================
 using lex_dot_sep = sequence<maybe<lex_ws>, character<'.'>, maybe<lex_ws>>;
 
-using lex_unquoted_key = repeat<either<lex_alpha, lex_digit,
-                                       character<'-'>, character<'_'>>,
-                                at_least<1>>;
+// 1*(alpha | digit | - | _)
+using lex_unquoted_key = char_class_run<char_class_bare_key, false, 1>;
 using lex_quoted_key = either<lex_basic_string, lex_literal_string>;
 using lex_simple_key = either<lex_unquoted_key, lex_quoted_key>;
 using lex_dotted_key = sequence<lex_simple_key,
@@ -286,8 +359,58 @@ using lex_utf8_code = either<
 
 using lex_comment_start_symbol = character<'#'>;
 using lex_non_eol_ascii = either<character<0x09>, in_range<0x20, 0x7E>>;
-using lex_comment = sequence<lex_comment_start_symbol, repeat<either<
-    lex_non_eol_ascii, lex_utf8_2byte, lex_utf8_3byte, lex_utf8_4byte>, unlimited>>;
+using lex_comment_char = either<
+    lex_non_eol_ascii, lex_utf8_2byte, lex_utf8_3byte, lex_utf8_4byte>;
+
+// the body of a comment is found by a SIMD kernel and validated as UTF-8 at
+// once. It stops at the first invalid sequence, as lex_comment_char does.
+template<>
+struct repeat<lex_comment_char, unlimited>
+{
+    static result<span, none_t>
+    scan(location& loc)
+    {
+        const auto first = loc.iter();
+        const auto last  = validate_utf8(first,
+                skip_class<comment_class>(first, loc.end()));
+        loc.advance(last - first); // no newline in between
+        return ok(span{first, last});
+    }
+    static result<region, none_t>
+    invoke(location& loc)
+    {
+        return to_region(loc, scan(loc));
+    }
+};
+using lex_comment = sequence<lex_comment_start_symbol,
+                             repeat<lex_comment_char, unlimited>>;
+
+// ===========================================================================
+// The combinator grammar of the lexers that are implemented by table lookups.
+// They are not used by the parser; they are kept as the reference to test the
+// fast lexers against.
+namespace reference
+{
+using lex_alpha   = either<lex_lower, lex_upper>;
+using lex_hex_dig = either<lex_digit, in_range<'A', 'F'>, in_range<'a', 'f'>>;
+
+template<std::size_t N>
+using lex_dec_digits = repeat<either<lex_digit,
+    sequence<lex_underscore, lex_digit>>, at_least<N>>;
+template<std::size_t N>
+using lex_hex_digits = repeat<either<reference::lex_hex_dig,
+    sequence<lex_underscore, reference::lex_hex_dig>>, at_least<N>>;
+template<std::size_t N>
+using lex_oct_digits = repeat<either<lex_oct_dig,
+    sequence<lex_underscore, lex_oct_dig>>, at_least<N>>;
+template<std::size_t N>
+using lex_bin_digits = repeat<either<lex_bin_dig,
+    sequence<lex_underscore, lex_bin_dig>>, at_least<N>>;
+
+using lex_unquoted_key = repeat<either<reference::lex_alpha, lex_digit,
+                                       character<'-'>, character<'_'>>,
+                                at_least<1>>;
+} // reference
 
 } // detail
 } // toml
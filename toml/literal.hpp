@@ -23,12 +23,12 @@ literal_internal_impl(::toml::detail::location loc)
             ::toml::detail::maybe<::toml::detail::lex_comment>,
             ::toml::detail::lex_newline
         >, ::toml::detail::at_least<1>>;
-    skip_line::invoke(loc);
+    skip_line::scan(loc);
 
     // if there are some whitespaces before a value, skip them.
     using skip_ws = ::toml::detail::repeat<
         ::toml::detail::lex_ws, ::toml::detail::at_least<1>>;
-    skip_ws::invoke(loc);
+    skip_ws::scan(loc);
 
     // to distinguish arrays and tables, first check it is a table or not.
     //
@@ -44,10 +44,10 @@ literal_internal_impl(::toml::detail::location loc)
 
     const auto the_front = loc.iter();
 
-    const bool is_table_key = ::toml::detail::lex_std_table::invoke(loc);
+    const bool is_table_key = ::toml::detail::lex_std_table::scan(loc);
     loc.reset(the_front);
 
-    const bool is_aots_key  = ::toml::detail::lex_array_table::invoke(loc);
+    const bool is_aots_key  = ::toml::detail::lex_array_table::scan(loc);
     loc.reset(the_front);
 
     // If it is neither a table-key or a array-of-table-key, it may be a value.
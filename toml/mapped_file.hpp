@@ -0,0 +1,132 @@
+//     Copyright Toru Niina 2017.
+// Distributed under the MIT License.
+#ifndef TOML11_MAPPED_FILE_HPP
+#define TOML11_MAPPED_FILE_HPP
+#include <cerrno>
+#include <ios>
+#include <string>
+#include <vector>
+
+#include "exception.hpp"
+#include "region.hpp"
+
+#ifndef TOML11_DISABLE_MMAP
+#if defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))
+#include <unistd.h>
+#if defined(_POSIX_MAPPED_FILES) && _POSIX_MAPPED_FILES > 0
+#define TOML11_HAS_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif // _POSIX_MAPPED_FILES
+#endif // unix
+#endif // TOML11_DISABLE_MMAP
+
+namespace toml
+{
+namespace detail
+{
+
+#ifdef TOML11_HAS_MMAP
+
+// a source that maps a whole file into memory, read-only.
+//
+// The pages are shared with the page cache, so no byte is copied before the
+// lexer touches it. Only a regular file is mapped. FIFOs, character devices
+// and files in /proc or /sys report a size of 0, so they are read into an
+// owned buffer until EOF instead. Note that the file should not be truncated while a value
+// that is parsed from it is alive because the regions in the value keep
+// pointing to the mapped pages.
+struct mapped_file_source final : public source_base
+{
+    explicit mapped_file_source(const std::string& fname)
+        : addr_(nullptr), length_(0)
+    {
+        const int fd = ::open(fname.c_str(), O_RDONLY);
+        if(fd == -1)
+        {
+            throw std::ios_base::failure(
+                    "toml::parse: Error opening file \"" + fname + "\"");
+        }
+
+        struct stat st;
+        if(::fstat(fd, &st) != 0)
+        {
+            const int errnum = errno;
+            ::close(fd);
+            throw file_io_error(errnum, "Failed to access", fname);
+        }
+        if(!S_ISREG(st.st_mode))
+        {
+            read_all(fd, fname);
+            ::close(fd);
+            this->set_range(buffer_.data(), buffer_.data() + buffer_.size());
+            return;
+        }
+        length_ = static_cast<std::size_t>(st.st_size);
+
+        // mmap does not accept zero length. An empty file is an empty range.
+        if(length_ != 0)
+        {
+            void* addr = ::mmap(nullptr, length_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if(addr == MAP_FAILED)
+            {
+                const int errnum = errno;
+                ::close(fd);
+                throw file_io_error(errnum, "Failed to map", fname);
+            }
+            addr_ = addr;
+#if defined(MADV_SEQUENTIAL)
+            // the parser reads a file from the beginning to the end.
+            ::madvise(addr_, length_, MADV_SEQUENTIAL);
+#endif
+        }
+        ::close(fd); // the mapping is still valid after closing fd.
+
+        const char* first = static_cast<const char*>(addr_);
+        this->set_range(first, first + length_);
+    }
+    ~mapped_file_source() override
+    {
+        if(addr_ != nullptr)
+        {
+            ::munmap(addr_, length_);
+        }
+    }
+
+  private:
+
+    // read the rest of fd by chunks, the same way as read_by_chunks does.
+    void read_all(const int fd, const std::string& fname)
+    {
+        constexpr std::size_t chunk_size = 64 * 1024;
+        std::size_t size = 0;
+        while(true)
+        {
+            buffer_.resize(size + chunk_size);
+            const auto n = ::read(fd, buffer_.data() + size, chunk_size);
+            if(n < 0)
+            {
+                const int errnum = errno;
+                if(errnum == EINTR) {continue;}
+                ::close(fd);
+                throw file_io_error(errnum, "Failed to read", fname);
+            }
+            if(n == 0) {break;}
+            size += static_cast<std::size_t>(n);
+        }
+        buffer_.resize(size);
+    }
+
+  private:
+    void*             addr_;
+    std::size_t       length_;
+    std::vector<char> buffer_; // used if the file cannot be mapped
+};
+
+#endif // TOML11_HAS_MMAP
+
+} // detail
+} // toml
+#endif// TOML11_MAPPED_FILE_HPP
@@ -0,0 +1,373 @@
+//     Copyright Toru Niina 2017.
+// Distributed under the MIT License.
+#ifndef TOML11_PARALLEL_PARSER_HPP
+#define TOML11_PARALLEL_PARSER_HPP
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <fstream>
+#include <istream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "parser.hpp"
+#include "scanner.hpp"
+
+namespace toml
+{
+namespace detail
+{
+
+template<typename Value>
+struct parsed_section
+{
+    std::vector<key>           keys;
+    region                     reg;
+    typename Value::table_type table;
+    bool                       is_array_table;
+};
+
+template<typename Value>
+struct parsed_chunk
+{
+    const char*                        first; // where the chunk begins
+    const char*                        last;  // where the parser stopped
+    std::vector<parsed_section<Value>> sections;
+    std::exception_ptr                 error;
+};
+
+// joins the started workers on every exit path. A joinable std::thread that
+// is destroyed calls std::terminate, so an exception thrown by the calling
+// thread (or by the constructor of a later std::thread) must not unwind
+// through the workers.
+struct thread_joiner
+{
+    explicit thread_joiner(std::vector<std::thread>& threads) noexcept
+        : threads_(threads)
+    {}
+    ~thread_joiner()
+    {
+        for(auto& thread : threads_)
+        {
+            if(thread.joinable())
+            {
+                thread.join();
+            }
+        }
+    }
+    thread_joiner(const thread_joiner&) = delete;
+    thread_joiner& operator=(const thread_joiner&) = delete;
+
+  private:
+    std::vector<std::thread>& threads_;
+};
+
+// parses a [table] or [[array.of.tables]] that starts at loc.iter(). The
+// table is not inserted into the root table here.
+template<typename Value>
+parsed_section<Value> parse_section(location& loc)
+{
+    bool is_array_table = true;
+    auto tabkey = parse_array_table_key(loc);
+    if(!tabkey)
+    {
+        is_array_table = false;
+        tabkey = parse_table_key(loc);
+    }
+    if(!tabkey)
+    {
+        throw syntax_error(format_underline("toml::parse_toml_file: "
+            "unknown line appeared", {{source_location(loc), "unknown format"}}),
+            source_location(loc));
+    }
+    auto tab = parse_ml_table<Value>(loc);
+    if(!tab)
+    {
+        throw syntax_error(tab.unwrap_err(), source_location(loc));
+    }
+    return parsed_section<Value>{
+        std::move(tabkey.unwrap().first), std::move(tabkey.unwrap().second),
+        std::move(tab.unwrap()), is_array_table
+    };
+}
+
+// parses sections from loc.iter() until it reaches `last`.
+template<typename Value>
+void parse_sections(location& loc, const char* last,
+                    std::vector<parsed_section<Value>>& sections)
+{
+    while(loc.iter() != loc.end() && loc.iter() < last)
+    {
+        sections.push_back(parse_section<Value>(loc));
+    }
+    return;
+}
+
+template<typename Value>
+void insert_sections(typename Value::table_type& data,
+                     const std::vector<parsed_section<Value>>& sections,
+                     const location& loc)
+{
+    for(const auto& sec : sections)
+    {
+        const auto inserted = insert_nested_key(data,
+                Value(sec.table, sec.reg, sec.reg.comments()),
+                sec.keys.begin(), sec.keys.end(), sec.reg, sec.is_array_table);
+        if(!inserted)
+        {
+            throw syntax_error(inserted.unwrap_err(), source_location(loc));
+        }
+    }
+    return;
+}
+
+// Splits the file at table headers, parses the chunks in parallel, and merges
+// the sections in the order of appearance in the same way as parse_toml_file.
+//
+// The split points are found by a scanner (find_table_header). If a chunk does
+// not begin where the previous one actually ended, the split point was wrong
+// (e.g. because of an invalid input), and the rest is parsed sequentially.
+template<typename Value>
+Value parse_parallel(location& loc, std::size_t num_threads)
+{
+    using value_type = Value;
+    using table_type = typename value_type::table_type;
+
+    skip_bom(loc);
+    const auto first = loc.iter();
+    if(first == loc.end())
+    {
+        return value_type(table_type{}, region(loc, first, first),
+                          std::vector<std::string>{});
+    }
+    const region file(loc, first, std::next(loc.iter()));
+    std::vector<std::string> comments = parse_file_comments(loc);
+
+    // the beginnings of the sections
+    std::vector<const char*> headers;
+    for(const char* iter = find_table_header(loc.iter(), loc.end());
+        iter != loc.end();
+        iter = find_table_header(std::find(iter, loc.end(), '\n'), loc.end()))
+    {
+        headers.push_back(iter);
+    }
+
+    // split the sections into chunks that have almost the same size
+    std::vector<parsed_chunk<value_type>> chunks;
+    std::vector<const char*> bounds;
+    const std::size_t num_chunks = std::min(num_threads, headers.size());
+    if(num_chunks > 1)
+    {
+        const auto target = static_cast<std::size_t>(loc.end() - headers.front()) / num_chunks;
+        for(const char* header : headers)
+        {
+            if(bounds.empty() || (bounds.size() < num_chunks &&
+               target <= static_cast<std::size_t>(header - bounds.back())))
+            {
+                bounds.push_back(header);
+            }
+        }
+        bounds.push_back(loc.end());
+        chunks.resize(bounds.size() - 1);
+    }
+
+    const location base(loc);
+    std::vector<std::thread> workers;
+    workers.reserve(chunks.size());
+    thread_joiner joiner(workers);
+    for(std::size_t i=0; i<chunks.size(); ++i)
+    {
+        parsed_chunk<value_type>& chunk = chunks.at(i);
+        chunk.first = bounds.at(i);
+        chunk.last  = bounds.at(i);
+        const char* const chunk_last = bounds.at(i+1);
+        workers.emplace_back([&base, &chunk, chunk_last]() {
+            try
+            {
+                location chunk_loc(base);
+                chunk_loc.reset(chunk.first);
+                parse_sections<value_type>(chunk_loc, chunk_last, chunk.sections);
+                chunk.last = chunk_loc.iter();
+            }
+            catch(...)
+            {
+                chunk.error = std::current_exception();
+            }
+        });
+    }
+
+    // root table is parsed by this thread while the workers parse sections.
+    // if it throws, `joiner` waits for the workers before it propagates.
+    auto root = parse_ml_table<value_type>(loc);
+    for(auto& worker : workers)
+    {
+        worker.join();
+    }
+    if(!root)
+    {
+        throw syntax_error(root.unwrap_err(), source_location(loc));
+    }
+
+    table_type data = std::move(root.unwrap());
+    for(const auto& chunk : chunks)
+    {
+        if(chunk.first != loc.iter())
+        {
+            break; // wrong split point. parse the rest sequentially.
+        }
+        insert_sections<value_type>(data, chunk.sections, loc);
+        if(chunk.error)
+        {
+            std::rethrow_exception(chunk.error);
+        }
+        loc.reset(chunk.last);
+    }
+    if(loc.iter() != loc.end())
+    {
+        std::vector<parsed_section<value_type>> rest;
+        parse_sections<value_type>(loc, loc.end(), rest);
+        insert_sections<value_type>(data, rest, loc);
+    }
+    return value_type(std::move(data), file, comments);
+}
+
+} // detail
+
+// Parses a file using multiple threads. The result is the same as toml::parse.
+// The file is split at [table] and [[array.of.tables]] headers, and the
+// chunks are parsed in parallel. It helps only if the file has many tables.
+// If `num_threads` is 0, std::thread::hardware_concurrency() is used.
+template<typename                     Comment = TOML11_DEFAULT_COMMENT_STRATEGY,
+         template<typename ...> class Table   = std::unordered_map,
+         template<typename ...> class Array   = std::vector>
+basic_value<Comment, Table, Array>
+parse_parallel(std::istream& is, std::size_t num_threads = 0,
+               std::string fname = "unknown file")
+{
+    if(num_threads == 0)
+    {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    detail::location loc(std::move(fname), detail::read_stream(is));
+    return detail::parse_parallel<basic_value<Comment, Table, Array>>(
+            loc, num_threads);
+}
+
+// the file is mapped into memory if possible.
+template<typename                     Comment = TOML11_DEFAULT_COMMENT_STRATEGY,
+         template<typename ...> class Table   = std::unordered_map,
+         template<typename ...> class Array   = std::vector>
+basic_value<Comment, Table, Array>
+parse_parallel(const std::string& fname, std::size_t num_threads = 0)
+{
+#ifdef TOML11_HAS_MMAP
+    if(num_threads == 0)
+    {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    detail::location loc(fname,
+            std::make_shared<detail::mapped_file_source>(fname));
+    return detail::parse_parallel<basic_value<Comment, Table, Array>>(
+            loc, num_threads);
+#else
+    std::ifstream ifs(fname, std::ios_base::binary);
+    if(!ifs.good())
+    {
+        throw std::ios_base::failure(
+                "toml::parse: Error opening file \"" + fname + "\"");
+    }
+    ifs.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+    return parse_parallel<Comment, Table, Array>(ifs, num_threads, fname);
+#endif
+}
+
+struct parse_many_options
+{
+    // the number of worker threads. If it is 0, hardware_concurrency() is used.
+    // It never exceeds the number of files.
+    std::size_t num_threads = 0;
+};
+
+// Parses many files using a fixed number of worker threads. Each worker takes
+// the next file from the list until all the files are parsed, so the I/O of a
+// file overlaps with the parsing of the others.
+//
+// Unlike toml::parse, it does not throw when a file could not be read or
+// parsed. The i-th result corresponds to paths[i], and contains the value or
+// the message of the exception that toml::parse would throw.
+template<typename                     Comment = TOML11_DEFAULT_COMMENT_STRATEGY,
+         template<typename ...> class Table   = std::unordered_map,
+         template<typename ...> class Array   = std::vector>
+std::vector<result<basic_value<Comment, Table, Array>, std::string>>
+parse_many(const std::vector<std::string>& paths,
+           const parse_many_options& options = parse_many_options())
+{
+    using value_type  = basic_value<Comment, Table, Array>;
+    using result_type = result<value_type, std::string>;
+
+    std::size_t num_threads = options.num_threads;
+    if(num_threads == 0)
+    {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    num_threads = std::min(num_threads, paths.size());
+
+    std::vector<value_type>  values(paths.size());
+    std::vector<std::string> errors(paths.size());
+    std::vector<char>        failed(paths.size(), 0);
+
+    std::atomic<std::size_t> next_index(0);
+    const auto work = [&]() {
+        while(true)
+        {
+            const std::size_t i = next_index.fetch_add(1);
+            if(paths.size() <= i)
+            {
+                return;
+            }
+            try
+            {
+                // files are read instead of mapped. For small files, mmap
+                // costs more, and munmap flushes TLBs of the other workers.
+                values[i] = parse<Comment, Table, Array>(paths[i]);
+            }
+            catch(const std::exception& e)
+            {
+                errors[i] = e.what();
+                failed[i] = 1;
+            }
+        }
+    };
+
+    // the calling thread is also one of the workers
+    std::vector<std::thread> workers;
+    detail::thread_joiner joiner(workers);
+    for(std::size_t i=1; i<num_threads; ++i)
+    {
+        workers.emplace_back(work);
+    }
+    work();
+    for(auto& worker : workers)
+    {
+        worker.join();
+    }
+
+    std::vector<result_type> results;
+    results.reserve(paths.size());
+    for(std::size_t i=0; i<paths.size(); ++i)
+    {
+        if(failed[i])
+        {
+            results.push_back(err(std::move(errors[i])));
+        }
+        else
+        {
+            results.push_back(ok(std::move(values[i])));
+        }
+    }
+    return results;
+}
+
+} // toml
+#endif// TOML11_PARALLEL_PARSER_HPP
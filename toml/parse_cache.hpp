@@ -0,0 +1,193 @@
+//     Copyright Toru Niina 2017.
+// Distributed under the MIT License.
+#ifndef TOML11_PARSE_CACHE_HPP
+#define TOML11_PARSE_CACHE_HPP
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "binary.hpp"
+#include "comments.hpp"
+#include "parser.hpp"
+
+namespace toml
+{
+namespace detail
+{
+
+// 64-bit FNV-1a. It is not cryptographic; the key only detects a change.
+constexpr std::uint64_t fnv1a_offset_basis = 0xcbf29ce484222325ull;
+constexpr std::uint64_t fnv1a_prime        = 0x00000100000001b3ull;
+
+inline std::uint64_t fnv1a(const char* first, const char* last,
+                           std::uint64_t h = fnv1a_offset_basis) noexcept
+{
+    for(; first != last; ++first)
+    {
+        h ^= static_cast<std::uint64_t>(static_cast<unsigned char>(*first));
+        h *= fnv1a_prime;
+    }
+    return h;
+}
+
+// The cached value depends on the content, the file name (stored in the
+// regions), whether the comments are kept, and the version of the format.
+inline std::string parse_cache_path(const std::string& cache_dir,
+        const std::string& fname, const std::vector<char>& letters,
+        const bool with_comments)
+{
+    const std::string tag = fname + '\0' + (with_comments ? 'c' : 'd') +
+                            std::to_string(binary_format_version);
+    std::uint64_t h = fnv1a(tag.data(), tag.data() + tag.size());
+    h = fnv1a(letters.data(), letters.data() + letters.size(), h);
+
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(h));
+
+    std::string path(cache_dir);
+    if(!path.empty() && path.back() != '/')
+    {
+        path += '/';
+    }
+    return path + hex + '-' + std::to_string(letters.size()) + ".toml11b";
+}
+
+// The key is only a 64-bit hash, so two contents could share an entry by a
+// collision. An entry has the name and the content of the source file with the
+// regions, so they are compared with the file before the value is used.
+// It returns false if they differ, and throws if the entry is broken.
+template<typename C, template<typename ...> class M, template<typename ...> class V>
+bool load_parse_cache(const std::string& path, const std::string& fname,
+                      const std::vector<char>& letters, basic_value<C, M, V>& v)
+{
+    std::ifstream ifs(path, std::ios_base::binary);
+    if(!ifs.good())
+    {
+        return false;
+    }
+    ifs.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+    const auto entry = read_stream(ifs);
+
+    binary_reader reader(entry.data(), entry.data() + entry.size(), path);
+    auto loaded = reader.read<basic_value<C, M, V>>();
+    if(reader.sources().empty())
+    {
+        return false;
+    }
+    for(const auto& src : reader.sources())
+    {
+        if(src.name() != fname ||
+           static_cast<std::size_t>(src.end() - src.begin()) != letters.size() ||
+           !std::equal(src.begin(), src.end(), letters.begin()))
+        {
+            return false;
+        }
+    }
+    v = std::move(loaded);
+    return true;
+}
+
+// the id of the current process, to make the name of a temporary file unique
+// among the processes that share a cache directory.
+inline long current_process_id() noexcept
+{
+#if defined(_WIN32)
+    return static_cast<long>(::_getpid());
+#else
+    return static_cast<long>(::getpid());
+#endif
+}
+
+// writes to a temporary file and renames it, so that another process never
+// reads a half-written entry. A failure is ignored; the cache is optional.
+//
+// The name of the temporary file consists of the process id, a counter and
+// the time, so that the writers in different processes or threads never share
+// a file.
+template<typename Value>
+void store_parse_cache(const Value& v, const std::string& path)
+{
+    static std::atomic<std::uint64_t> counter(0);
+    const std::string tmp = path + ".tmp" +
+        std::to_string(current_process_id()) + '-' +
+        std::to_string(counter.fetch_add(1, std::memory_order_relaxed)) + '-' +
+        std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+    try
+    {
+        save_binary(v, tmp, /*with_regions = */ true);
+    }
+    catch(const std::exception&)
+    {
+        std::remove(tmp.c_str());
+        return;
+    }
+    if(std::rename(tmp.c_str(), path.c_str()) != 0)
+    {
+        std::remove(tmp.c_str());
+    }
+    return;
+}
+
+} // detail
+
+// Parses a file like toml::parse, but keeps the parsed value in `cache_dir`.
+//
+// The key of an entry is a hash of the file content, so the next call with the
+// same content loads the value by toml::load_binary instead of parsing, and a
+// modified file is parsed again. The source is also stored, so the error
+// messages about the values are the same as the ones returned by toml::parse.
+// Before an entry is used, the stored source is compared with the file, so a
+// hash collision does not return the value of another content.
+//
+// `cache_dir` should already exist. If the cache cannot be read or written, it
+// is silently ignored. Old entries are not removed.
+template<typename                     Comment = TOML11_DEFAULT_COMMENT_STRATEGY,
+         template<typename ...> class Table   = std::unordered_map,
+         template<typename ...> class Array   = std::vector>
+basic_value<Comment, Table, Array>
+parse_cached(const std::string& fname, const std::string& cache_dir)
+{
+    std::ifstream ifs(fname, std::ios_base::binary);
+    if(!ifs.good())
+    {
+        throw std::ios_base::failure(
+                "toml::parse: Error opening file \"" + fname + "\"");
+    }
+    ifs.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+    auto letters = detail::read_stream(ifs);
+
+    using value_type = basic_value<Comment, Table, Array>;
+    const auto path = detail::parse_cache_path(cache_dir, fname, letters,
+            !std::is_same<Comment, discard_comments>::value);
+    try
+    {
+        value_type cached;
+        if(detail::load_parse_cache(path, fname, letters, cached))
+        {
+            return cached;
+        }
+    }
+    catch(const std::exception&)
+    {
+        // broken or written by another version. parse it again.
+    }
+
+    const auto v = detail::parse<Comment, Table, Array>(letters, fname);
+    detail::store_parse_cache(v, path);
+    return v;
+}
+
+} // toml
+#endif// TOML11_PARSE_CACHE_HPP
@@ -7,9 +7,12 @@
 #include <sstream>
 
 #include "combinator.hpp"
+#include "dfa.hpp"
 #include "lexer.hpp"
+#include "mapped_file.hpp"
 #include "region.hpp"
 #include "result.hpp"
+#include "strtod.hpp"
 #include "types.hpp"
 #include "value.hpp"
 
@@ -49,136 +52,194 @@ parse_boolean(location& loc)
                {{source_location(loc), "the next token is not a boolean"}}));
 }
 
-inline result<std::pair<integer, region>, std::string>
-parse_binary_integer(location& loc)
+// reads the digits in [first, last) in `base`, skipping underscores, directly
+// from the source. the digits are already checked by the lexer. It returns
+// false if the value does not fit in `integer`.
+inline bool read_integer_digits(const char* first, const char* last,
+        const std::uint64_t base, const bool negative, integer& retval) noexcept
 {
-    const auto first = loc.iter();
-    if(const auto token = lex_bin_int::invoke(loc))
-    {
-        auto str = token.unwrap().str();
-        assert(str.size() > 2); // minimum -> 0b1
-        assert(str.at(0) == '0' && str.at(1) == 'b');
+    // -(min) is larger than max by one.
+    const auto limit = static_cast<std::uint64_t>(
+        (std::numeric_limits<integer>::max)()) + (negative ? 1u : 0u);
 
-        // skip all the zeros and `_` locating at the MSB
-        str.erase(str.begin(), std::find_if(
-                str.begin() + 2, // to skip prefix `0b`
-                str.end(),
-                [](const char c) { return c == '1'; })
-            );
-        assert(str.empty() || str.front() == '1');
+    std::uint64_t value = 0;
+    for(; first != last; ++first)
+    {
+        const char c = *first;
+        if(c == '_') {continue;}
 
-        // since toml11 uses int64_t, 64bit (unsigned) input cannot be read.
-        const auto max_length = 63 + std::count(str.begin(), str.end(), '_');
-        if(static_cast<std::string::size_type>(max_length) < str.size())
+        const auto digit = static_cast<std::uint64_t>(c <= '9' ? c - '0' :
+                (c | 0x20) - 'a' + 10); // [0-9A-Fa-f]
+        if(value > (limit - digit) / base)
         {
-            loc.reset(first);
-            return err(format_underline("toml::parse_binary_integer: "
-                "only signed 64bit integer is available",
-               {{source_location(loc), "too large input (> int64_t)"}}));
+            return false;
         }
+        value = value * base + digit;
+    }
+    if(negative)
+    {
+        // the value can be -(max)-1, that is not a negation of an integer.
+        retval = (value == 0) ? 0 : -static_cast<integer>(value - 1) - 1;
+    }
+    else
+    {
+        retval = static_cast<integer>(value);
+    }
+    return true;
+}
 
-        integer retval(0), base(1);
-        for(auto i(str.rbegin()), e(str.rend()); i!=e; ++i)
-        {
-            assert(base != 0); // means overflow, checked in the above code
-            if(*i == '1')
-            {
-                retval += base;
-                if( (std::numeric_limits<integer>::max)() / 2 < base )
-                {
-                    base = 0;
-                }
-                base *= 2;
-            }
-            else if(*i == '0')
-            {
-                if( (std::numeric_limits<integer>::max)() / 2 < base )
-                {
-                    base = 0;
-                }
-                base *= 2;
-            }
-            else if(*i == '_')
-            {
-                // do nothing.
-            }
-            else // should be detected by lex_bin_int. [[unlikely]]
-            {
-                throw internal_error(format_underline(
-                    "toml::parse_binary_integer: internal error",
-                    {{source_location(token.unwrap()), "invalid token"}}),
-                    source_location(loc));
-            }
-        }
-        return ok(std::make_pair(retval, token.unwrap()));
+// converts a token that is already lexed as an integer `0b...`.
+// `loc` points the next character of the token.
+inline result<std::pair<integer, region>, std::string>
+parse_binary_integer_token(location& loc, const region& token)
+{
+    assert(token.size() > 2); // minimum -> 0b1
+    assert(token.first()[0] == '0' && token.first()[1] == 'b');
+
+    // since toml11 uses int64_t, 64bit (unsigned) input cannot be read.
+    integer retval(0);
+    if(!read_integer_digits(token.first() + 2, token.last(), 2, false, retval))
+    {
+        loc.reset(token.first());
+        return err(format_underline("toml::parse_binary_integer: "
+            "only signed 64bit integer is available",
+           {{source_location(loc), "too large input (> int64_t)"}}));
+    }
+    return ok(std::make_pair(retval, token));
+}
+
+inline result<std::pair<integer, region>, std::string>
+parse_binary_integer(location& loc)
+{
+    const auto first = loc.iter();
+    if(const auto token = lex_bin_int::invoke(loc))
+    {
+        return parse_binary_integer_token(loc, token.unwrap());
     }
     loc.reset(first);
     return err(format_underline("toml::parse_binary_integer:",
                {{source_location(loc), "the next token is not an integer"}}));
 }
 
+// converts a token that is already lexed as an integer `0o...`.
+// `loc` points the next character of the token.
+inline result<std::pair<integer, region>, std::string>
+parse_octal_integer_token(location& loc, const region& token)
+{
+    integer retval(0);
+    if(!read_integer_digits(token.first() + 2, token.last(), 8, false, retval))
+    {
+        loc.reset(token.first());
+        return err(format_underline("toml::parse_octal_integer:",
+                   {{source_location(loc), "out of range"}}));
+    }
+    return ok(std::make_pair(retval, token));
+}
+
 inline result<std::pair<integer, region>, std::string>
 parse_octal_integer(location& loc)
 {
     const auto first = loc.iter();
     if(const auto token = lex_oct_int::invoke(loc))
     {
-        auto str = token.unwrap().str();
-        str.erase(std::remove(str.begin(), str.end(), '_'), str.end());
-        str.erase(str.begin()); str.erase(str.begin()); // remove `0o` prefix
-
-        std::istringstream iss(str);
-        integer retval(0);
-        iss >> std::oct >> retval;
-        if(iss.fail())
-        {
-            // `istream` sets `failbit` if internally-called `std::num_get::get`
-            // fails.
-            // `std::num_get::get` calls `std::strtoll` if the argument type is
-            // signed.
-            // `std::strtoll` fails if
-            //  - the value is out_of_range or
-            //  - no conversion is possible.
-            // since we already checked that the string is valid octal integer,
-            // so the error reason is out_of_range.
-            loc.reset(first);
-            return err(format_underline("toml::parse_octal_integer:",
-                       {{source_location(loc), "out of range"}}));
-        }
-        return ok(std::make_pair(retval, token.unwrap()));
+        return parse_octal_integer_token(loc, token.unwrap());
     }
     loc.reset(first);
     return err(format_underline("toml::parse_octal_integer:",
                {{source_location(loc), "the next token is not an integer"}}));
 }
 
+// converts a token that is already lexed as an integer `0x...`.
+// `loc` points the next character of the token.
+inline result<std::pair<integer, region>, std::string>
+parse_hexadecimal_integer_token(location& loc, const region& token)
+{
+    integer retval(0);
+    if(!read_integer_digits(token.first() + 2, token.last(), 16, false, retval))
+    {
+        loc.reset(token.first());
+        return err(format_underline("toml::parse_hexadecimal_integer:",
+                   {{source_location(loc), "out of range"}}));
+    }
+    return ok(std::make_pair(retval, token));
+}
+
 inline result<std::pair<integer, region>, std::string>
 parse_hexadecimal_integer(location& loc)
 {
     const auto first = loc.iter();
     if(const auto token = lex_hex_int::invoke(loc))
     {
-        auto str = token.unwrap().str();
-        str.erase(std::remove(str.begin(), str.end(), '_'), str.end());
-        str.erase(str.begin()); str.erase(str.begin()); // remove `0x` prefix
-
-        std::istringstream iss(str);
-        integer retval(0);
-        iss >> std::hex >> retval;
-        if(iss.fail())
-        {
-            // see parse_octal_integer for detail of this error message.
-            loc.reset(first);
-            return err(format_underline("toml::parse_hexadecimal_integer:",
-                       {{source_location(loc), "out of range"}}));
-        }
-        return ok(std::make_pair(retval, token.unwrap()));
+        return parse_hexadecimal_integer_token(loc, token.unwrap());
     }
     loc.reset(first);
     return err(format_underline("toml::parse_hexadecimal_integer",
                {{source_location(loc), "the next token is not an integer"}}));
 }
 
+// converts a token that is already lexed as a decimal integer.
+// `loc` points the next character of the token.
+inline result<std::pair<integer, region>, std::string>
+parse_decimal_integer_token(location& loc, const region& token)
+{
+    auto first = token.first();
+    const bool negative = (*first == '-');
+    if(*first == '+' || *first == '-')
+    {
+        ++first;
+    }
+    integer retval(0);
+    if(!read_integer_digits(first, token.last(), 10, negative, retval))
+    {
+        loc.reset(token.first());
+        return err(format_underline("toml::parse_integer:",
+                   {{source_location(loc), "out of range"}}));
+    }
+    return ok(std::make_pair(retval, token));
+}
+
+// converts a token in [first, last) that is already lexed as one of the
+// integers. It returns false if the value is out of range, and then
+// parse_integer_token makes the error message.
+inline bool read_integer_token(const char* first, const char* last,
+                               integer& retval) noexcept
+{
+    if(last - first > 2 && *first == '0')
+    {
+        switch(first[1])
+        {
+            case 'b': {return read_integer_digits(first + 2, last,  2, false, retval);}
+            case 'o': {return read_integer_digits(first + 2, last,  8, false, retval);}
+            case 'x': {return read_integer_digits(first + 2, last, 16, false, retval);}
+            default : {break;}
+        }
+    }
+    const bool negative = (*first == '-');
+    if(*first == '+' || *first == '-')
+    {
+        ++first;
+    }
+    return read_integer_digits(first, last, 10, negative, retval);
+}
+
+// converts a token that is already lexed as one of the integers.
+// `loc` points the next character of the token.
+inline result<std::pair<integer, region>, std::string>
+parse_integer_token(location& loc, const region& token)
+{
+    if(token.size() > 2 && *token.first() == '0')
+    {
+        switch(*std::next(token.first()))
+        {
+            case 'b': {return parse_binary_integer_token     (loc, token);}
+            case 'o': {return parse_octal_integer_token      (loc, token);}
+            case 'x': {return parse_hexadecimal_integer_token(loc, token);}
+            default : {break;}
+        }
+    }
+    return parse_decimal_integer_token(loc, token);
+}
+
 inline result<std::pair<integer, region>, std::string>
 parse_integer(location& loc)
 {
@@ -212,115 +273,84 @@ parse_integer(location& loc)
 
     if(const auto token = lex_dec_int::invoke(loc))
     {
-        auto str = token.unwrap().str();
-        str.erase(std::remove(str.begin(), str.end(), '_'), str.end());
-
-        std::istringstream iss(str);
-        integer retval(0);
-        iss >> retval;
-        if(iss.fail())
-        {
-            // see parse_octal_integer for detail of this error message.
-            loc.reset(first);
-            return err(format_underline("toml::parse_integer:",
-                       {{source_location(loc), "out of range"}}));
-        }
-        return ok(std::make_pair(retval, token.unwrap()));
+        return parse_decimal_integer_token(loc, token.unwrap());
     }
     loc.reset(first);
     return err(format_underline("toml::parse_integer: ",
                {{source_location(loc), "the next token is not an integer"}}));
 }
 
+// converts a token in [first, last) that is already lexed as a float. It
+// returns false if the value is out of range.
+inline bool read_floating_token(const char* first, const char* last, floating& v)
+{
+    // a number ends with a digit. otherwise, it is [+-]?(inf|nan).
+    const auto back = *(last - 1);
+    if('0' <= back && back <= '9')
+    {
+        return read_floating_digits(first, last, v);
+    }
+    const bool negative = (*first == '-');
+    if(*first == '+' || *first == '-')
+    {
+        ++first;
+    }
+    if(*first == 'i')
+    {
+        if(!std::numeric_limits<floating>::has_infinity)
+        {
+            throw std::domain_error("toml::parse_floating: inf value found"
+                " but the current environment does not support inf. Please"
+                " make sure that the floating-point implementation conforms"
+                " IEEE 754/ISO 60559 international standard.");
+        }
+        v = std::numeric_limits<floating>::infinity();
+    }
+    else if(std::numeric_limits<floating>::has_quiet_NaN)
+    {
+        v = std::numeric_limits<floating>::quiet_NaN();
+    }
+    else if(std::numeric_limits<floating>::has_signaling_NaN)
+    {
+        v = std::numeric_limits<floating>::signaling_NaN();
+    }
+    else
+    {
+        throw std::domain_error("toml::parse_floating: NaN value found"
+            " but the current environment does not support NaN. Please"
+            " make sure that the floating-point implementation conforms"
+            " IEEE 754/ISO 60559 international standard.");
+    }
+    if(negative)
+    {
+        v = -v;
+    }
+    return true;
+}
+
+// converts a token that is already lexed as a float.
+// `loc` points the next character of the token.
+inline result<std::pair<floating, region>, std::string>
+parse_floating_token(location& loc, const region& token)
+{
+    floating v(0.0);
+    if(!read_floating_token(token.first(), token.last(), v))
+    {
+        // see parse_octal_integer for detail of this error message.
+        loc.reset(token.first());
+        return err(format_underline("toml::parse_floating:",
+                   {{source_location(loc), "out of range"}}));
+    }
+    return ok(std::make_pair(v, token));
+}
+
 inline result<std::pair<floating, region>, std::string>
 parse_floating(location& loc)
 {
     const auto first = loc.iter();
-    if(const auto token = lex_float::invoke(loc))
+    if(const auto token = dfa<lex_float>::invoke(loc))
     {
-        auto str = token.unwrap().str();
-        if(str == "inf" || str == "+inf")
-        {
-            if(std::numeric_limits<floating>::has_infinity)
-            {
-                return ok(std::make_pair(
-                    std::numeric_limits<floating>::infinity(), token.unwrap()));
-            }
-            else
-            {
-                throw std::domain_error("toml::parse_floating: inf value found"
-                    " but the current environment does not support inf. Please"
-                    " make sure that the floating-point implementation conforms"
-                    " IEEE 754/ISO 60559 international standard.");
-            }
-        }
-        else if(str == "-inf")
-        {
-            if(std::numeric_limits<floating>::has_infinity)
-            {
-                return ok(std::make_pair(
-                    -std::numeric_limits<floating>::infinity(), token.unwrap()));
-            }
-            else
-            {
-                throw std::domain_error("toml::parse_floating: inf value found"
-                    " but the current environment does not support inf. Please"
-                    " make sure that the floating-point implementation conforms"
-                    " IEEE 754/ISO 60559 international standard.");
-            }
-        }
-        else if(str == "nan" || str == "+nan")
-        {
-            if(std::numeric_limits<floating>::has_quiet_NaN)
-            {
-                return ok(std::make_pair(
-                    std::numeric_limits<floating>::quiet_NaN(), token.unwrap()));
-            }
-            else if(std::numeric_limits<floating>::has_signaling_NaN)
-            {
-                return ok(std::make_pair(
-                    std::numeric_limits<floating>::signaling_NaN(), token.unwrap()));
-            }
-            else
-            {
-                throw std::domain_error("toml::parse_floating: NaN value found"
-                    " but the current environment does not support NaN. Please"
-                    " make sure that the floating-point implementation conforms"
-                    " IEEE 754/ISO 60559 international standard.");
-            }
-        }
-        else if(str == "-nan")
-        {
-            if(std::numeric_limits<floating>::has_quiet_NaN)
-            {
-                return ok(std::make_pair(
-                    -std::numeric_limits<floating>::quiet_NaN(), token.unwrap()));
-            }
-            else if(std::numeric_limits<floating>::has_signaling_NaN)
-            {
-                return ok(std::make_pair(
-                    -std::numeric_limits<floating>::signaling_NaN(), token.unwrap()));
-            }
-            else
-            {
-                throw std::domain_error("toml::parse_floating: NaN value found"
-                    " but the current environment does not support NaN. Please"
-                    " make sure that the floating-point implementation conforms"
-                    " IEEE 754/ISO 60559 international standard.");
-            }
-        }
-        str.erase(std::remove(str.begin(), str.end(), '_'), str.end());
-        std::istringstream iss(str);
-        floating v(0.0);
-        iss >> v;
-        if(iss.fail())
-        {
-            // see parse_octal_integer for detail of this error message.
-            loc.reset(first);
-            return err(format_underline("toml::parse_floating:",
-                       {{source_location(loc), "out of range"}}));
-        }
-        return ok(std::make_pair(v, token.unwrap()));
+        return parse_floating_token(loc, token.unwrap());
     }
     loc.reset(first);
     return err(format_underline("toml::parse_floating: ",
@@ -442,17 +472,34 @@ inline result<std::string, std::string> parse_escape_sequence(location& loc)
     return err(msg);
 }
 
-inline std::ptrdiff_t check_utf8_validity(const std::string& reg)
+// returns the offset of the first invalid UTF-8 sequence in [first, last), or
+// -1 if there is none. It accepts the same sequences as lex_utf8_code.
+inline std::ptrdiff_t check_utf8_validity(const char* first, const char* last)
+{
+    const auto invalid = validate_utf8(first, last);
+    return (invalid == last) ? -1 : std::distance(first, invalid);
+}
+
+// appends the characters in a string body that are not escaped. Runs of the
+// characters in `Class` are found by a SIMD kernel (see simd.hpp) and copied at
+// once. `Lexer` reads the others, e.g. a `"` that is not a delimiter.
+template<typename Class, typename Lexer>
+void append_unescaped(location& loc, std::string& str)
 {
-    location loc("tmp", reg);
-    const auto u8 = repeat<lex_utf8_code, unlimited>::invoke(loc);
-    if(!u8 || loc.iter() != loc.end())
+    while(true)
     {
-        const auto error_location = std::distance(loc.begin(), loc.iter());
-        assert(0 <= error_location);
-        return error_location;
+        const auto first = loc.iter();
+        const auto last  = skip_class<Class>(first, loc.end());
+        str.append(first, last);
+        loc.advance(last - first);
+
+        const auto rest = Lexer::scan(loc);
+        if(!rest)
+        {
+            return;
+        }
+        str.append(rest.as_ok().first, rest.as_ok().last);
     }
-    return -1;
 }
 
 inline result<std::pair<toml::string, region>, std::string>
@@ -481,12 +528,8 @@ parse_ml_basic_string(location& loc)
         delim = none();
         while(!delim)
         {
-            using lex_unescaped_seq = repeat<
-                either<lex_ml_basic_unescaped, lex_newline>, unlimited>;
-            if(auto unescaped = lex_unescaped_seq::invoke(inner_loc))
-            {
-                retval += unescaped.unwrap().str();
-            }
+            append_unescaped<ml_basic_string_body_class,
+                either<lex_ml_basic_unescaped, lex_newline>>(inner_loc, retval);
             if(auto escaped = parse_escape_sequence(inner_loc))
             {
                 retval += escaped.unwrap();
@@ -524,7 +567,8 @@ parse_ml_basic_string(location& loc)
             }
         }
 
-        const auto err_loc = check_utf8_validity(token.unwrap().str());
+        const auto err_loc = check_utf8_validity(
+                token.unwrap().first(), token.unwrap().last());
         if(err_loc == -1)
         {
             return ok(std::make_pair(toml::string(retval), token.unwrap()));
@@ -571,11 +615,8 @@ parse_basic_string(location& loc)
         quot = none();
         while(!quot)
         {
-            using lex_unescaped_seq = repeat<lex_basic_unescaped, unlimited>;
-            if(auto unescaped = lex_unescaped_seq::invoke(inner_loc))
-            {
-                retval += unescaped.unwrap().str();
-            }
+            append_unescaped<basic_string_body_class, lex_basic_unescaped>(
+                    inner_loc, retval);
             if(auto escaped = parse_escape_sequence(inner_loc))
             {
                 retval += escaped.unwrap();
@@ -590,7 +631,8 @@ parse_basic_string(location& loc)
             quot = lex_quotation_mark::invoke(inner_loc);
         }
 
-        const auto err_loc = check_utf8_validity(token.unwrap().str());
+        const auto err_loc = check_utf8_validity(
+                token.unwrap().first(), token.unwrap().last());
         if(err_loc == -1)
         {
             return ok(std::make_pair(toml::string(retval), token.unwrap()));
@@ -666,7 +708,8 @@ parse_ml_literal_string(location& loc)
             }
         }
 
-        const auto err_loc = check_utf8_validity(token.unwrap().str());
+        const auto err_loc = check_utf8_validity(
+                token.unwrap().first(), token.unwrap().last());
         if(err_loc == -1)
         {
             return ok(std::make_pair(toml::string(retval, toml::string_t::literal),
@@ -720,7 +763,8 @@ parse_literal_string(location& loc)
                 source_location(inner_loc));
         }
 
-        const auto err_loc = check_utf8_validity(token.unwrap().str());
+        const auto err_loc = check_utf8_validity(
+                token.unwrap().first(), token.unwrap().last());
         if(err_loc == -1)
         {
             return ok(std::make_pair(
@@ -777,70 +821,251 @@ parse_string(location& loc)
                 {{source_location(loc), "the next token is not a string"}}));
 }
 
-inline result<std::pair<local_date, region>, std::string>
-parse_local_date(location& loc)
+// reads a one-line string that needs no unescaping, i.e. a literal string or a
+// basic string without `\`, into `str`. The content is assigned, so the buffer
+// of `str` is reused. Otherwise, including an invalid string, it returns false
+// without moving `loc`, and parse_string should be used.
+inline bool read_plain_string(location& loc, std::string& str, string_t& kind)
 {
     const auto first = loc.iter();
-    if(const auto token = lex_local_date::invoke(loc))
+    const auto last  = loc.end();
+    if(first == last || (*first != '"' && *first != '\'') ||
+       (last - first >= 3 && first[1] == *first && first[2] == *first))
     {
-        location inner_loc(loc.name(), token.unwrap().str());
+        return false;
+    }
+    const bool is_basic = (*first == '"');
+    if(!(is_basic ? lex_basic_string::scan(loc) : lex_literal_string::scan(loc)))
+    {
+        loc.reset(first);
+        return false;
+    }
+    const auto body_first = std::next(first);
+    const auto body_last  = std::prev(loc.iter());
+    if((is_basic && std::find(body_first, body_last, '\\') != body_last) ||
+       check_utf8_validity(first, loc.iter()) != -1)
+    {
+        loc.reset(first);
+        return false;
+    }
+    str.assign(body_first, body_last);
+    kind = is_basic ? string_t::basic : string_t::literal;
+    return true;
+}
 
-        const auto y = lex_date_fullyear::invoke(inner_loc);
-        if(!y || inner_loc.iter() == inner_loc.end() || *inner_loc.iter() != '-')
-        {
-            throw internal_error(format_underline(
-                "toml::parse_local_date: invalid year format",
-                {{source_location(inner_loc), "should be `-`"}}),
-                source_location(inner_loc));
-        }
-        inner_loc.advance();
-        const auto m = lex_date_month::invoke(inner_loc);
-        if(!m || inner_loc.iter() == inner_loc.end() || *inner_loc.iter() != '-')
-        {
-            throw internal_error(format_underline(
-                "toml::parse_local_date: invalid month format",
-                {{source_location(inner_loc), "should be `-`"}}),
-                source_location(inner_loc));
-        }
-        inner_loc.advance();
-        const auto d = lex_date_mday::invoke(inner_loc);
-        if(!d)
+// ----------------------------------------------------------------------------
+// RFC 3339 fields have a fixed width. The date `YYYY-MM-` and the time
+// `HH:MM:SS` are exactly 8 bytes, so they are checked and converted in a
+// uint64_t at once (SWAR) directly from the source.
+
+// reads 8 bytes as a little-endian integer; the first byte is the lowest.
+inline std::uint64_t load_uint64_le(const char* p) noexcept
+{
+    std::uint64_t v = 0;
+    std::memcpy(&v, p, sizeof(v));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    return v;
+}
+
+// `x` is 8 bytes xor-ed with a pattern that has '0' at the digits and the
+// delimiters as they are. the delimiters must be 0 and the digits 0-9.
+inline bool is_swar_digits(const std::uint64_t x, const std::uint64_t digits) noexcept
+{
+    // a byte that has the higher nibble is not a digit. For the rest, + 6
+    // carries into 0x10 only if it is 10-15.
+    const std::uint64_t high = x & (~digits | (digits & 0xF0F0F0F0F0F0F0F0u));
+    const std::uint64_t low  = (x + (digits & 0x0606060606060606u)) &
+                                    (digits & 0x1010101010101010u);
+    return (high | low) == 0;
+}
+
+// each byte becomes the 2-digit number that starts from that byte.
+inline std::uint64_t swar_digit_pairs(const std::uint64_t x) noexcept
+{
+    return x * 10 + (x >> 8);
+}
+
+inline bool is_digit_char(const char c) noexcept
+{
+    return '0' <= c && c <= '9';
+}
+
+// reads `YYYY-MM-DD` at `p`.
+inline bool read_date_digits(const char* p, int& year, int& month, int& day) noexcept
+{
+    // "0000-00-"
+    const std::uint64_t x = load_uint64_le(p) ^ 0x2D30302D30303030u;
+    if(!is_swar_digits(x, 0x00FFFF00FFFFFFFFu) ||
+       !is_digit_char(p[8]) || !is_digit_char(p[9]))
+    {
+        return false;
+    }
+    const std::uint64_t pairs = swar_digit_pairs(x);
+    year  = static_cast<int>((pairs & 0xFF) * 100 + ((pairs >> 16) & 0xFF));
+    month = static_cast<int>((pairs >> 40) & 0xFF);
+    day   = (p[8] - '0') * 10 + (p[9] - '0');
+    return true;
+}
+
+// reads `HH:MM:SS` at `p`.
+inline bool read_time_digits(const char* p, int& hour, int& minute, int& second) noexcept
+{
+    // "00:00:00"
+    const std::uint64_t x = load_uint64_le(p) ^ 0x30303A30303A3030u;
+    if(!is_swar_digits(x, 0xFFFF00FFFF00FFFFu))
+    {
+        return false;
+    }
+    const std::uint64_t pairs = swar_digit_pairs(x);
+    hour   = static_cast<int>( pairs        & 0xFF);
+    minute = static_cast<int>((pairs >> 24) & 0xFF);
+    second = static_cast<int>((pairs >> 48) & 0xFF);
+    return true;
+}
+
+// reads the digits of a fraction of a second in [first, last) as
+// nanoseconds. The digits after the 9th are ignored.
+inline bool read_secfrac_digits(const char* first, const char* last,
+                                std::uint32_t& nanosecond) noexcept
+{
+    const auto len = static_cast<std::size_t>(last - first);
+    if(len == 0) {return false;}
+
+    // pad with '0' to 8 digits, as `.5` means 500'000'000 ns.
+    char buf[8] = {'0', '0', '0', '0', '0', '0', '0', '0'};
+    std::memcpy(buf, first, (std::min)(len, sizeof(buf)));
+    std::uint64_t x = load_uint64_le(buf) ^ 0x3030303030303030u;
+    if(!is_swar_digits(x, 0xFFFFFFFFFFFFFFFFu) ||
+       (len > 8 && !is_digit_char(first[8])))
+    {
+        return false;
+    }
+    // 8 digits -> 4 pairs -> 2 quads -> 1 number
+    x = swar_digit_pairs(x);
+    x = (((x & 0x000000FF000000FFu) * (100 + (std::uint64_t(1000000) << 32))) +
+         (((x >> 16) & 0x000000FF000000FFu) * (1 + (std::uint64_t(10000) << 32)))) >> 32;
+    nanosecond = static_cast<std::uint32_t>(x) * 10 +
+                 ((len > 8) ? static_cast<std::uint32_t>(first[8] - '0') : 0u);
+    for(std::size_t i=9; i<len; ++i)
+    {
+        if(!is_digit_char(first[i])) {return false;}
+    }
+    return true;
+}
+
+// converts `YYYY-MM-DD` at the beginning of a token [first, last). `loc`
+// points the next character of the token. The converters below take the range
+// instead of a region, so that toml::reader can call them without making a
+// region; it is made only to report an error.
+inline local_date read_local_date(const location& loc,
+                                  const char* first, const char* last)
+{
+    int year = 0, month = 0, day = 0;
+    if(last - first < 10 || !read_date_digits(first, year, month, day))
+    {
+        const region token(loc, first, last);
+        throw internal_error(format_underline(
+            "toml::parse_local_date: invalid date format",
+            {{source_location(token), "should be `YYYY-MM-DD`"}}),
+            source_location(token));
+    }
+
+    // We briefly check whether the input date is valid or not. But here, we
+    // only check if the RFC3339 compliance.
+    //     Actually there are several special date that does not exist,
+    // because of historical reasons, such as 1582/10/5-1582/10/14 (only in
+    // several countries). But here, we do not care about such a complicated
+    // rule. It makes the code complicated and there is only low probability
+    // that such a specific date is needed in practice. If someone need to
+    // validate date accurately, that means that the one need a specialized
+    // library for their purpose in a different layer.
+    {
+        const bool is_leap = (year % 4 == 0) && ((year % 100 != 0) || (year % 400 == 0));
+        const auto max_day = (month == 2) ? (is_leap ? 29 : 28) :
+            ((month == 4 || month == 6 || month == 9 || month == 11) ? 30 : 31);
+
+        if((month < 1 || 12 < month) || (day < 1 || max_day < day))
+        {
+            // point the end of the date, not the end of the token
+            location field(loc);
+            field.reset(first + 10);
+            throw syntax_error(format_underline("toml::parse_date: "
+                "invalid date: it does not conform RFC3339.", {{
+                source_location(field), "month should be 01-12, day should be"
+                " 01-28,29,30,31, depending on month/year."
+                }}), source_location(region(loc, first, first + 10)));
+        }
+    }
+    return local_date(year, static_cast<month_t>(month - 1), day);
+}
+
+// converts `HH:MM:SS(.fraction)?` in [first, last), that is a part of a token
+// [token_first, token_last).
+inline local_time read_local_time(const location& loc,
+        const char* token_first, const char* token_last,
+        const char* first, const char* last)
+{
+    int hour = 0, minute = 0, second = 0;
+    if(last - first < 8 || !read_time_digits(first, hour, minute, second))
+    {
+        const region token(loc, token_first, token_last);
+        throw internal_error(format_underline(
+            "toml::parse_local_time: invalid time format",
+            {{source_location(token), "should be `HH:MM:SS`"}}),
+            source_location(token));
+    }
+    if((hour   < 0 || 23 < hour) || (minute < 0 || 59 < minute) ||
+       (second < 0 || 60 < second)) // it may be leap second
+    {
+        // point the end of the time, not the end of the token
+        location field(loc);
+        field.reset(last);
+        throw syntax_error(format_underline("toml::parse_local_time: "
+            "invalid time: it does not conform RFC3339.", {{
+            source_location(field), "hour should be 00-23, minute should be"
+            " 00-59, second should be 00-60 (depending on the leap"
+            " second rules.)"}}), source_location(region(loc, first, last)));
+    }
+
+    local_time time(hour, minute, second, 0, 0);
+
+    first += 8;
+    if(first != last)
+    {
+        std::uint32_t nanosecond = 0;
+        if(*first != '.' || !read_secfrac_digits(first + 1, last, nanosecond))
         {
+            const region token(loc, token_first, token_last);
             throw internal_error(format_underline(
-                "toml::parse_local_date: invalid day format",
-                {{source_location(inner_loc), "here"}}),
-                source_location(inner_loc));
+                "toml::parse_local_time: invalid subsecond format",
+                {{source_location(token), "here"}}),
+                source_location(token));
         }
+        time.millisecond = static_cast<std::uint16_t>(nanosecond / 1000000u);
+        time.microsecond = static_cast<std::uint16_t>(nanosecond / 1000u % 1000u);
+        time.nanosecond  = static_cast<std::uint16_t>(nanosecond % 1000u);
+    }
+    return time;
+}
 
-        const auto year  = static_cast<std::int16_t>(from_string<int>(y.unwrap().str(), 0));
-        const auto month = static_cast<std::int8_t >(from_string<int>(m.unwrap().str(), 0));
-        const auto day   = static_cast<std::int8_t >(from_string<int>(d.unwrap().str(), 0));
-
-        // We briefly check whether the input date is valid or not. But here, we
-        // only check if the RFC3339 compliance.
-        //     Actually there are several special date that does not exist,
-        // because of historical reasons, such as 1582/10/5-1582/10/14 (only in
-        // several countries). But here, we do not care about such a complicated
-        // rule. It makes the code complicated and there is only low probability
-        // that such a specific date is needed in practice. If someone need to
-        // validate date accurately, that means that the one need a specialized
-        // library for their purpose in a different layer.
-        {
-            const bool is_leap = (year % 4 == 0) && ((year % 100 != 0) || (year % 400 == 0));
-            const auto max_day = (month == 2) ? (is_leap ? 29 : 28) :
-                ((month == 4 || month == 6 || month == 9 || month == 11) ? 30 : 31);
+// converts a token that is already lexed as a local_date.
+// `loc` points the next character of the token.
+inline result<std::pair<local_date, region>, std::string>
+parse_local_date_token(location& loc, const region& token)
+{
+    return ok(std::make_pair(
+        read_local_date(loc, token.first(), token.last()), token));
+}
 
-            if((month < 1 || 12 < month) || (day < 1 || max_day < day))
-            {
-                throw syntax_error(format_underline("toml::parse_date: "
-                    "invalid date: it does not conform RFC3339.", {{
-                    source_location(loc), "month should be 01-12, day should be"
-                    " 01-28,29,30,31, depending on month/year."
-                    }}), source_location(inner_loc));
-            }
-        }
-        return ok(std::make_pair(local_date(year, static_cast<month_t>(month - 1), day),
-                                 token.unwrap()));
+inline result<std::pair<local_date, region>, std::string>
+parse_local_date(location& loc)
+{
+    const auto first = loc.iter();
+    if(const auto token = lex_local_date::invoke(loc))
+    {
+        return parse_local_date_token(loc, token.unwrap());
     }
     else
     {
@@ -850,97 +1075,22 @@ parse_local_date(location& loc)
     }
 }
 
+// converts a token that is already lexed as a local_time.
+// `loc` points the next character of the token.
+inline result<std::pair<local_time, region>, std::string>
+parse_local_time_token(location& loc, const region& token)
+{
+    return ok(std::make_pair(read_local_time(loc,
+        token.first(), token.last(), token.first(), token.last()), token));
+}
+
 inline result<std::pair<local_time, region>, std::string>
 parse_local_time(location& loc)
 {
     const auto first = loc.iter();
     if(const auto token = lex_local_time::invoke(loc))
     {
-        location inner_loc(loc.name(), token.unwrap().str());
-
-        const auto h = lex_time_hour::invoke(inner_loc);
-        if(!h || inner_loc.iter() == inner_loc.end() || *inner_loc.iter() != ':')
-        {
-            throw internal_error(format_underline(
-                "toml::parse_local_time: invalid year format",
-                {{source_location(inner_loc), "should be `:`"}}),
-                source_location(inner_loc));
-        }
-        inner_loc.advance();
-        const auto m = lex_time_minute::invoke(inner_loc);
-        if(!m || inner_loc.iter() == inner_loc.end() || *inner_loc.iter() != ':')
-        {
-            throw internal_error(format_underline(
-                "toml::parse_local_time: invalid month format",
-                {{source_location(inner_loc), "should be `:`"}}),
-                source_location(inner_loc));
-        }
-        inner_loc.advance();
-        const auto s = lex_time_second::invoke(inner_loc);
-        if(!s)
-        {
-            throw internal_error(format_underline(
-                "toml::parse_local_time: invalid second format",
-                {{source_location(inner_loc), "here"}}),
-                source_location(inner_loc));
-        }
-
-        const int hour   = from_string<int>(h.unwrap().str(), 0);
-        const int minute = from_string<int>(m.unwrap().str(), 0);
-        const int second = from_string<int>(s.unwrap().str(), 0);
-
-        if((hour   < 0 || 23 < hour) || (minute < 0 || 59 < minute) ||
-           (second < 0 || 60 < second)) // it may be leap second
-        {
-            throw syntax_error(format_underline("toml::parse_local_time: "
-                "invalid time: it does not conform RFC3339.", {{
-                source_location(loc), "hour should be 00-23, minute should be"
-                " 00-59, second should be 00-60 (depending on the leap"
-                " second rules.)"}}), source_location(inner_loc));
-        }
-
-        local_time time(hour, minute, second, 0, 0);
-
-        const auto before_secfrac = inner_loc.iter();
-        if(const auto secfrac = lex_time_secfrac::invoke(inner_loc))
-        {
-            auto sf = secfrac.unwrap().str();
-            sf.erase(sf.begin()); // sf.front() == '.'
-            switch(sf.size() % 3)
-            {
-                case 2:  sf += '0';  break;
-                case 1:  sf += "00"; break;
-                case 0:  break;
-                default: break;
-            }
-            if(sf.size() >= 9)
-            {
-                time.millisecond = from_string<std::uint16_t>(sf.substr(0, 3), 0u);
-                time.microsecond = from_string<std::uint16_t>(sf.substr(3, 3), 0u);
-                time.nanosecond  = from_string<std::uint16_t>(sf.substr(6, 3), 0u);
-            }
-            else if(sf.size() >= 6)
-            {
-                time.millisecond = from_string<std::uint16_t>(sf.substr(0, 3), 0u);
-                time.microsecond = from_string<std::uint16_t>(sf.substr(3, 3), 0u);
-            }
-            else if(sf.size() >= 3)
-            {
-                time.millisecond = from_string<std::uint16_t>(sf, 0u);
-                time.microsecond = 0u;
-            }
-        }
-        else
-        {
-            if(before_secfrac != inner_loc.iter())
-            {
-                throw internal_error(format_underline(
-                    "toml::parse_local_time: invalid subsecond format",
-                    {{source_location(inner_loc), "here"}}),
-                source_location(inner_loc));
-            }
-        }
-        return ok(std::make_pair(time, token.unwrap()));
+        return parse_local_time_token(loc, token.unwrap());
     }
     else
     {
@@ -950,41 +1100,39 @@ parse_local_time(location& loc)
     }
 }
 
+// converts `YYYY-MM-DD[Tt ]HH:MM:SS(.fraction)?` in [first, last).
+inline local_datetime read_local_datetime(const location& loc,
+                                          const char* first, const char* last)
+{
+    const auto date = read_local_date(loc, first, last);
+    if(last - first < 11 || (first[10] != 'T' && first[10] != 't' && first[10] != ' '))
+    {
+        const region token(loc, first, last);
+        throw internal_error(format_underline(
+            "toml::parse_local_datetime: invalid datetime format",
+            {{source_location(token), "should be `T` or ` ` (space)"}}),
+            source_location(token));
+    }
+    const auto time = read_local_time(loc, first, last, first + 11, last);
+    return local_datetime(date, time);
+}
+
+// converts a token that is already lexed as a local_datetime.
+// `loc` points the next character of the token.
+inline result<std::pair<local_datetime, region>, std::string>
+parse_local_datetime_token(location& loc, const region& token)
+{
+    return ok(std::make_pair(
+        read_local_datetime(loc, token.first(), token.last()), token));
+}
+
 inline result<std::pair<local_datetime, region>, std::string>
 parse_local_datetime(location& loc)
 {
     const auto first = loc.iter();
     if(const auto token = lex_local_date_time::invoke(loc))
     {
-        location inner_loc(loc.name(), token.unwrap().str());
-        const auto date = parse_local_date(inner_loc);
-        if(!date || inner_loc.iter() == inner_loc.end())
-        {
-            throw internal_error(format_underline(
-                "toml::parse_local_datetime: invalid datetime format",
-                {{source_location(inner_loc), "date, not datetime"}}),
-                source_location(inner_loc));
-        }
-        const char delim = *(inner_loc.iter());
-        if(delim != 'T' && delim != 't' && delim != ' ')
-        {
-            throw internal_error(format_underline(
-                "toml::parse_local_datetime: invalid datetime format",
-                {{source_location(inner_loc), "should be `T` or ` ` (space)"}}),
-                source_location(inner_loc));
-        }
-        inner_loc.advance();
-        const auto time = parse_local_time(inner_loc);
-        if(!time)
-        {
-            throw internal_error(format_underline(
-                "toml::parse_local_datetime: invalid datetime format",
-                {{source_location(inner_loc), "invalid time format"}}),
-                source_location(inner_loc));
-        }
-        return ok(std::make_pair(
-            local_datetime(date.unwrap().first, time.unwrap().first),
-            token.unwrap()));
+        return parse_local_datetime_token(loc, token.unwrap());
     }
     else
     {
@@ -994,56 +1142,83 @@ parse_local_datetime(location& loc)
     }
 }
 
-inline result<std::pair<offset_datetime, region>, std::string>
-parse_offset_datetime(location& loc)
+// converts `YYYY-MM-DD[Tt ]HH:MM:SS(.fraction)?([Zz]|[+-]HH:MM)` in
+// [first, last).
+inline offset_datetime read_offset_datetime(const location& loc,
+                                            const char* first, const char* last)
 {
-    const auto first = loc.iter();
-    if(const auto token = lex_offset_date_time::invoke(loc))
+    const auto date = read_local_date(loc, first, last);
+    if(last - first < 20 || (first[10] != 'T' && first[10] != 't' && first[10] != ' '))
     {
-        location inner_loc(loc.name(), token.unwrap().str());
-        const auto datetime = parse_local_datetime(inner_loc);
-        if(!datetime || inner_loc.iter() == inner_loc.end())
-        {
-            throw internal_error(format_underline(
-                "toml::parse_offset_datetime: invalid datetime format",
-                {{source_location(inner_loc), "date, not datetime"}}),
-                source_location(inner_loc));
-        }
-        time_offset offset(0, 0);
-        if(const auto ofs = lex_time_numoffset::invoke(inner_loc))
-        {
-            const auto str = ofs.unwrap().str();
+        const region token(loc, first, last);
+        throw internal_error(format_underline(
+            "toml::parse_offset_datetime: invalid datetime format",
+            {{source_location(token), "should be `T` or ` ` (space)"}}),
+            source_location(token));
+    }
+    auto time_last = first + 19;
+    if(*time_last == '.')
+    {
+        time_last = std::find_if(time_last + 1, last,
+                                 [](const char c) {return !is_digit_char(c);});
+    }
+    const auto time = read_local_time(loc, first, last, first + 11, time_last);
 
-            const auto hour   = from_string<int>(str.substr(1,2), 0);
-            const auto minute = from_string<int>(str.substr(4,2), 0);
+    time_offset offset(0, 0);
+    const auto rest = last - time_last;
+    if(rest == 6 && (*time_last == '+' || *time_last == '-') &&
+       is_digit_char(time_last[1]) && is_digit_char(time_last[2]) &&
+       time_last[3] == ':' &&
+       is_digit_char(time_last[4]) && is_digit_char(time_last[5]))
+    {
+        const auto hour   = (time_last[1] - '0') * 10 + (time_last[2] - '0');
+        const auto minute = (time_last[4] - '0') * 10 + (time_last[5] - '0');
 
-            if((hour < 0 || 23 < hour) || (minute < 0 || 59 < minute))
-            {
-                throw syntax_error(format_underline("toml::parse_offset_datetime: "
-                    "invalid offset: it does not conform RFC3339.", {{
-                    source_location(loc), "month should be 01-12, day should be"
-                    " 01-28,29,30,31, depending on month/year."
-                    }}), source_location(inner_loc));
-            }
+        if((hour < 0 || 23 < hour) || (minute < 0 || 59 < minute))
+        {
+            throw syntax_error(format_underline("toml::parse_offset_datetime: "
+                "invalid offset: it does not conform RFC3339.", {{
+                source_location(loc), "month should be 01-12, day should be"
+                " 01-28,29,30,31, depending on month/year."
+                }}), source_location(region(loc, first, last)));
+        }
 
-            if(str.front() == '+')
-            {
-                offset = time_offset(hour, minute);
-            }
-            else
-            {
-                offset = time_offset(-hour, -minute);
-            }
+        if(*time_last == '+')
+        {
+            offset = time_offset(hour, minute);
         }
-        else if(*inner_loc.iter() != 'Z' && *inner_loc.iter() != 'z')
+        else
         {
-            throw internal_error(format_underline(
-                "toml::parse_offset_datetime: invalid datetime format",
-                {{source_location(inner_loc), "should be `Z` or `+HH:MM`"}}),
-                source_location(inner_loc));
+            offset = time_offset(-hour, -minute);
         }
-        return ok(std::make_pair(offset_datetime(datetime.unwrap().first, offset),
-                                 token.unwrap()));
+    }
+    else if(rest != 1 || (*time_last != 'Z' && *time_last != 'z'))
+    {
+        const region token(loc, first, last);
+        throw internal_error(format_underline(
+            "toml::parse_offset_datetime: invalid datetime format",
+            {{source_location(token), "should be `Z` or `+HH:MM`"}}),
+            source_location(token));
+    }
+    return offset_datetime(local_datetime(date, time), offset);
+}
+
+// converts a token that is already lexed as an offset_datetime.
+// `loc` points the next character of the token.
+inline result<std::pair<offset_datetime, region>, std::string>
+parse_offset_datetime_token(location& loc, const region& token)
+{
+    return ok(std::make_pair(
+        read_offset_datetime(loc, token.first(), token.last()), token));
+}
+
+inline result<std::pair<offset_datetime, region>, std::string>
+parse_offset_datetime(location& loc)
+{
+    const auto first = loc.iter();
+    if(const auto token = lex_offset_date_time::invoke(loc))
+    {
+        return parse_offset_datetime_token(loc, token.unwrap());
     }
     else
     {
@@ -1088,7 +1263,7 @@ parse_key(location& loc)
 
         while(inner_loc.iter() != inner_loc.end())
         {
-            lex_ws::invoke(inner_loc);
+            lex_ws::scan(inner_loc);
             if(const auto k = parse_simple_key(inner_loc))
             {
                 keys.push_back(k.unwrap().first);
@@ -1101,7 +1276,7 @@ parse_key(location& loc)
                     source_location(inner_loc));
             }
 
-            lex_ws::invoke(inner_loc);
+            lex_ws::scan(inner_loc);
             if(inner_loc.iter() == inner_loc.end())
             {
                 break;
@@ -1136,6 +1311,48 @@ parse_key(location& loc)
                 }));
 }
 
+// reads a key into `keys` in the same way as parse_key, but it reuses the
+// strings in `keys` and does not make a region. The range of the key is
+// [first, loc.iter()). If the key has an escape sequence or is invalid, it
+// returns false without moving `loc`, and parse_key should be used.
+inline bool read_key_parts(location& loc, std::vector<key>& keys)
+{
+    const auto first = loc.iter();
+    std::size_t n = 0;
+    while(true)
+    {
+        if(keys.size() == n)
+        {
+            keys.emplace_back();
+        }
+        string_t kind;
+        if(!read_plain_string(loc, keys[n], kind))
+        {
+            const auto part_first = loc.iter();
+            if(!lex_unquoted_key::scan(loc))
+            {
+                loc.reset(first);
+                return false;
+            }
+            keys[n].assign(part_first, loc.iter());
+        }
+        ++n;
+
+        // a dot and the next part. whitespace before `=` is left.
+        const auto part_last = loc.iter();
+        lex_ws::scan(loc);
+        if(loc.iter() == loc.end() || *loc.iter() != '.')
+        {
+            loc.reset(part_last);
+            break;
+        }
+        loc.advance();
+        lex_ws::scan(loc);
+    }
+    keys.resize(n);
+    return true;
+}
+
 // forward-decl to implement parse_array and parse_table
 template<typename Value>
 result<Value, std::string> parse_value(location&);
@@ -1159,12 +1376,12 @@ parse_array(location& loc)
     loc.advance();
 
     using lex_ws_comment_newline = repeat<
-        either<lex_wschar, lex_newline, lex_comment>, unlimited>;
+        either<lex_ws, lex_newline, lex_comment>, unlimited>;
 
     array_type retval;
     while(loc.iter() != loc.end())
     {
-        lex_ws_comment_newline::invoke(loc); // skip
+        lex_ws_comment_newline::scan(loc); // skip
 
         if(loc.iter() != loc.end() && *loc.iter() == ']')
         {
@@ -1218,7 +1435,7 @@ parse_array(location& loc)
         const auto sp = lex_array_separator::invoke(loc);
         if(!sp)
         {
-            lex_ws_comment_newline::invoke(loc);
+            lex_ws_comment_newline::scan(loc);
             if(loc.iter() != loc.end() && *loc.iter() == ']')
             {
                 loc.advance(); // skip ']'
@@ -1300,7 +1517,7 @@ parse_key_value_pair(location& loc)
         std::string msg;
         loc.reset(after_kvsp);
         // check there is something not a comment/whitespace after `=`
-        if(sequence<maybe<lex_ws>, maybe<lex_comment>, lex_newline>::invoke(loc))
+        if(sequence<maybe<lex_ws>, maybe<lex_comment>, lex_line_end>::scan(loc))
         {
             loc.reset(after_kvsp);
             msg = format_underline("toml::parse_key_value_pair: "
@@ -1825,7 +2042,7 @@ parse_inline_table(location& loc)
     loc.advance();
 
     // check if the inline table is an empty table = { }
-    maybe<lex_ws>::invoke(loc);
+    maybe<lex_ws>::scan(loc);
     if(loc.iter() != loc.end() && *loc.iter() == '}')
     {
         loc.advance(); // skip `}`
@@ -1860,7 +2077,7 @@ parse_inline_table(location& loc)
 
         if(!sp)
         {
-            maybe<lex_ws>::invoke(loc);
+            maybe<lex_ws>::scan(loc);
 
             if(loc.iter() == loc.end())
             {
@@ -1892,7 +2109,7 @@ parse_inline_table(location& loc)
         }
         else // `,` is found
         {
-            maybe<lex_ws>::invoke(loc);
+            maybe<lex_ws>::scan(loc);
             if(loc.iter() != loc.end() && *loc.iter() == '}')
             {
                 throw syntax_error(format_underline(
@@ -1910,7 +2127,21 @@ parse_inline_table(location& loc)
             source_location(loc));
 }
 
-inline result<value_t, std::string> guess_number_type(const location& l)
+// the kind of a value and, if the classifier found it, the end of the token.
+// if `last` is nullptr, the parser of the kind finds the end by itself.
+struct value_token
+{
+    value_t     type;
+    const char* last;
+};
+
+// the lexers that a value starting with a digit or a sign can match. They run
+// at once, in a single pass, and the first one that matches is taken.
+using number_classifier = dfa_classifier<
+    lex_offset_date_time, lex_local_date_time, lex_local_date, lex_local_time,
+    lex_float, lex_bin_int, lex_oct_int, lex_hex_int, lex_dec_int>;
+
+inline result<value_token, std::string> classify_number(const location& l)
 {
     // This function tries to find some (common) mistakes by checking characters
     // that follows the last character of a value. But it is often difficult
@@ -1918,149 +2149,179 @@ inline result<value_t, std::string> guess_number_type(const location& l)
     // spaces, tabs, commas (in an array or inline table), closing brackets
     // (of an array or inline table), comment-sign (#). Since this function
     // does not parse further, those characters are always allowed to be there.
-    location loc = l;
+    enum : std::size_t
+    {
+        offset_datetime = 0, local_datetime, local_date, local_time,
+        floating, bin_int, oct_int, hex_int, dec_int
+    };
+    const auto ends = number_classifier::scan(l.iter(), l.end());
 
-    if(lex_offset_date_time::invoke(loc)) {return ok(value_t::offset_datetime);}
-    loc.reset(l.iter());
+    // a location is copied only to make an error message.
+    const auto error_at = [&l](const char* iter) -> location {
+        location loc(l);
+        loc.reset(iter);
+        return loc;
+    };
 
-    if(lex_local_date_time::invoke(loc))
+    if(const auto last = ends[offset_datetime])
+    {
+        return ok(value_token{value_t::offset_datetime, last});
+    }
+    if(const auto last = ends[local_datetime])
     {
         // bad offset may appear after this.
-        if(loc.iter() != loc.end() && (*loc.iter() == '+' || *loc.iter() == '-'
-                    || *loc.iter() == 'Z' || *loc.iter() == 'z'))
+        if(last != l.end() && (*last == '+' || *last == '-' ||
+                               *last == 'Z' || *last == 'z'))
         {
             return err(format_underline("bad offset: should be [+-]HH:MM or Z",
-                        {{source_location(loc), "[+-]HH:MM or Z"}},
+                        {{source_location(error_at(last)), "[+-]HH:MM or Z"}},
                         {"pass: +09:00, -05:30", "fail: +9:00, -5:30"}));
         }
-        return ok(value_t::local_datetime);
+        return ok(value_token{value_t::local_datetime, last});
     }
-    loc.reset(l.iter());
-
-    if(lex_local_date::invoke(loc))
+    if(const auto last = ends[local_date])
     {
         // bad time may appear after this.
         // A space is allowed as a delimiter between local time. But there are
         // both cases in which a space becomes valid or invalid.
         // - invalid: 2019-06-16 7:00:00
         // - valid  : 2019-06-16 07:00:00
-        if(loc.iter() != loc.end())
+        if(last != l.end())
         {
-            const auto c = *loc.iter();
+            const auto c = *last;
             if(c == 'T' || c == 't')
             {
                 return err(format_underline("bad time: should be HH:MM:SS.subsec",
-                        {{source_location(loc), "HH:MM:SS.subsec"}},
+                        {{source_location(error_at(last)), "HH:MM:SS.subsec"}},
                         {"pass: 1979-05-27T07:32:00, 1979-05-27 07:32:00.999999",
                          "fail: 1979-05-27T7:32:00, 1979-05-27 17:32"}));
             }
             if('0' <= c && c <= '9')
             {
                 return err(format_underline("bad time: missing T",
-                        {{source_location(loc), "T or space required here"}},
+                        {{source_location(error_at(last)), "T or space required here"}},
                         {"pass: 1979-05-27T07:32:00, 1979-05-27 07:32:00.999999",
                          "fail: 1979-05-27T7:32:00, 1979-05-27 7:32"}));
             }
-            if(c == ' ' && std::next(loc.iter()) != loc.end() &&
-                ('0' <= *std::next(loc.iter()) && *std::next(loc.iter())<= '9'))
+            if(c == ' ' && std::next(last) != l.end() &&
+                ('0' <= *std::next(last) && *std::next(last) <= '9'))
             {
-                loc.advance();
                 return err(format_underline("bad time: should be HH:MM:SS.subsec",
-                        {{source_location(loc), "HH:MM:SS.subsec"}},
+                        {{source_location(error_at(std::next(last))), "HH:MM:SS.subsec"}},
                         {"pass: 1979-05-27T07:32:00, 1979-05-27 07:32:00.999999",
                          "fail: 1979-05-27T7:32:00, 1979-05-27 7:32"}));
             }
         }
-        return ok(value_t::local_date);
+        return ok(value_token{value_t::local_date, last});
     }
-    loc.reset(l.iter());
-
-    if(lex_local_time::invoke(loc)) {return ok(value_t::local_time);}
-    loc.reset(l.iter());
-
-    if(lex_float::invoke(loc))
+    if(const auto last = ends[local_time])
+    {
+        return ok(value_token{value_t::local_time, last});
+    }
+    if(const auto last = ends[floating])
     {
-        if(loc.iter() != loc.end() && *loc.iter() == '_')
+        if(last != l.end() && *last == '_')
         {
             return err(format_underline("bad float: `_` should be surrounded by digits",
-                        {{source_location(loc), "here"}},
+                        {{source_location(error_at(last)), "here"}},
                         {"pass: +1.0, -2e-2, 3.141_592_653_589, inf, nan",
                          "fail: .0, 1., _1.0, 1.0_, 1_.0, 1.0__0"}));
         }
-        return ok(value_t::floating);
+        return ok(value_token{value_t::floating, last});
     }
-    loc.reset(l.iter());
 
-    if(lex_integer::invoke(loc))
+    // the same as lex_integer = either<bin_int, oct_int, hex_int, dec_int>.
+    const char* last = nullptr;
+    for(const auto kind : {bin_int, oct_int, hex_int, dec_int})
     {
-        if(loc.iter() != loc.end())
+        if(ends[kind]) {last = ends[kind]; break;}
+    }
+    if(last)
+    {
+        if(last != l.end())
         {
-            const auto c = *loc.iter();
+            const auto c = *last;
             if(c == '_')
             {
                 return err(format_underline("bad integer: `_` should be surrounded by digits",
-                            {{source_location(loc), "here"}},
+                            {{source_location(error_at(last)), "here"}},
                             {"pass: -42, 1_000, 1_2_3_4_5, 0xC0FFEE, 0b0010, 0o755",
                              "fail: 1__000, 0123"}));
             }
             if('0' <= c && c <= '9')
             {
                 // leading zero. point '0'
-                loc.retrace();
                 return err(format_underline("bad integer: leading zero",
-                            {{source_location(loc), "here"}},
+                            {{source_location(error_at(std::prev(last))), "here"}},
                             {"pass: -42, 1_000, 1_2_3_4_5, 0xC0FFEE, 0b0010, 0o755",
                              "fail: 1__000, 0123"}));
             }
             if(c == ':' || c == '-')
             {
                 return err(format_underline("bad datetime: invalid format",
-                            {{source_location(loc), "here"}},
+                            {{source_location(error_at(last)), "here"}},
                             {"pass: 1979-05-27T07:32:00-07:00, 1979-05-27 07:32:00.999999Z",
                              "fail: 1979-05-27T7:32:00-7:00, 1979-05-27 7:32-00:30"}));
             }
             if(c == '.' || c == 'e' || c == 'E')
             {
                 return err(format_underline("bad float: invalid format",
-                            {{source_location(loc), "here"}},
+                            {{source_location(error_at(last)), "here"}},
                             {"pass: +1.0, -2e-2, 3.141_592_653_589, inf, nan",
                              "fail: .0, 1., _1.0, 1.0_, 1_.0, 1.0__0"}));
             }
+            if(std::next(l.iter()) == last && *l.iter() == '0' &&
+               (('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z')))
+            {
+                // a broken prefix like 0xg1 or 0n12. leave the token to
+                // parse_integer that reports which prefix is wrong.
+                return ok(value_token{value_t::integer, nullptr});
+            }
         }
-        return ok(value_t::integer);
+        return ok(value_token{value_t::integer, last});
     }
-    if(loc.iter() != loc.end() && *loc.iter() == '.')
+    if(l.iter() != l.end() && *l.iter() == '.')
     {
         return err(format_underline("bad float: invalid format",
-                {{source_location(loc), "integer part required before this"}},
+                {{source_location(l), "integer part required before this"}},
                 {"pass: +1.0, -2e-2, 3.141_592_653_589, inf, nan",
                  "fail: .0, 1., _1.0, 1.0_, 1_.0, 1.0__0"}));
     }
-    if(loc.iter() != loc.end() && *loc.iter() == '_')
+    if(l.iter() != l.end() && *l.iter() == '_')
     {
         return err(format_underline("bad number: `_` should be surrounded by digits",
-                {{source_location(loc), "`_` is not surrounded by digits"}},
+                {{source_location(l), "`_` is not surrounded by digits"}},
                 {"pass: -42, 1_000, 1_2_3_4_5, 0xC0FFEE, 0b0010, 0o755",
                  "fail: 1__000, 0123"}));
     }
     return err(format_underline("bad format: unknown value appeared",
-                {{source_location(loc), "here"}}));
+                {{source_location(l), "here"}}));
 }
 
-inline result<value_t, std::string> guess_value_type(const location& loc)
+inline result<value_token, std::string> classify_value(const location& loc)
 {
     switch(*loc.iter())
     {
-        case '"' : {return ok(value_t::string);  }
-        case '\'': {return ok(value_t::string);  }
-        case 't' : {return ok(value_t::boolean); }
-        case 'f' : {return ok(value_t::boolean); }
-        case '[' : {return ok(value_t::array);   }
-        case '{' : {return ok(value_t::table);   }
-        case 'i' : {return ok(value_t::floating);} // inf.
-        case 'n' : {return ok(value_t::floating);} // nan.
-        default  : {return guess_number_type(loc);}
+        case '"' : {return ok(value_token{value_t::string,   nullptr});}
+        case '\'': {return ok(value_token{value_t::string,   nullptr});}
+        case 't' : {return ok(value_token{value_t::boolean,  nullptr});}
+        case 'f' : {return ok(value_token{value_t::boolean,  nullptr});}
+        case '[' : {return ok(value_token{value_t::array,    nullptr});}
+        case '{' : {return ok(value_token{value_t::table,    nullptr});}
+        case 'i' : {return ok(value_token{value_t::floating, nullptr});} // inf.
+        case 'n' : {return ok(value_token{value_t::floating, nullptr});} // nan.
+        default  : {return classify_number(loc);}
+    }
+}
+
+inline result<value_t, std::string> guess_value_type(const location& loc)
+{
+    const auto token = classify_value(loc);
+    if(!token)
+    {
+        return err(token.unwrap_err());
     }
+    return ok(token.unwrap().type);
 }
 
 template<typename Value, typename T>
@@ -2088,13 +2349,30 @@ result<Value, std::string> parse_value(location& loc)
                    {{source_location(loc), ""}}));
     }
 
-    const auto type = guess_value_type(loc);
-    if(!type)
+    const auto classified = classify_value(loc);
+    if(!classified)
     {
-        return err(type.unwrap_err());
+        return err(classified.unwrap_err());
+    }
+
+    // if the classifier has found the token, pass it to the converter.
+    if(const auto last = classified.unwrap().last)
+    {
+        loc.advance(last - first);
+        const region token(loc, first, last);
+        switch(classified.unwrap().type)
+        {
+            case value_t::integer        : {return parse_value_helper<Value>(parse_integer_token        (loc, token));}
+            case value_t::floating       : {return parse_value_helper<Value>(parse_floating_token       (loc, token));}
+            case value_t::offset_datetime: {return parse_value_helper<Value>(parse_offset_datetime_token(loc, token));}
+            case value_t::local_datetime : {return parse_value_helper<Value>(parse_local_datetime_token (loc, token));}
+            case value_t::local_date     : {return parse_value_helper<Value>(parse_local_date_token     (loc, token));}
+            case value_t::local_time     : {return parse_value_helper<Value>(parse_local_time_token     (loc, token));}
+            default: {loc.reset(first); break;} // the other parsers find the end.
+        }
     }
 
-    switch(type.unwrap())
+    switch(classified.unwrap().type)
     {
         case value_t::boolean        : {return parse_value_helper<Value>(parse_boolean(loc)            );}
         case value_t::integer        : {return parse_value_helper<Value>(parse_integer(loc)            );}
@@ -2133,7 +2411,7 @@ parse_table_key(location& loc)
         }
         // to skip [ a . b . c ]
         //          ^----------- this whitespace
-        lex_ws::invoke(inner_loc);
+        lex_ws::scan(inner_loc);
         const auto keys = parse_key(inner_loc);
         if(!keys)
         {
@@ -2144,7 +2422,7 @@ parse_table_key(location& loc)
         }
         // to skip [ a . b . c ]
         //                    ^-- this whitespace
-        lex_ws::invoke(inner_loc);
+        lex_ws::scan(inner_loc);
         const auto close = lex_std_table_close::invoke(inner_loc);
         if(!close)
         {
@@ -2158,7 +2436,7 @@ parse_table_key(location& loc)
         if(loc.iter() != loc.end())
         {
             using lex_newline_after_table_key =
-                sequence<maybe<lex_ws>, maybe<lex_comment>, lex_newline>;
+                sequence<maybe<lex_ws>, maybe<lex_comment>, lex_line_end>;
             const auto nl = lex_newline_after_table_key::invoke(loc);
             if(!nl)
             {
@@ -2192,7 +2470,7 @@ parse_array_table_key(location& loc)
                 {{source_location(inner_loc), "should be `[[`"}}),
                 source_location(inner_loc));
         }
-        lex_ws::invoke(inner_loc);
+        lex_ws::scan(inner_loc);
         const auto keys = parse_key(inner_loc);
         if(!keys)
         {
@@ -2201,7 +2479,7 @@ parse_array_table_key(location& loc)
                 {{source_location(inner_loc), "not a key"}}),
                 source_location(inner_loc));
         }
-        lex_ws::invoke(inner_loc);
+        lex_ws::scan(inner_loc);
         const auto close = lex_array_table_close::invoke(inner_loc);
         if(!close)
         {
@@ -2215,7 +2493,7 @@ parse_array_table_key(location& loc)
         if(loc.iter() != loc.end())
         {
             using lex_newline_after_table_key =
-                sequence<maybe<lex_ws>, maybe<lex_comment>, lex_newline>;
+                sequence<maybe<lex_ws>, maybe<lex_comment>, lex_line_end>;
             const auto nl = lex_newline_after_table_key::invoke(loc);
             if(!nl)
             {
@@ -2251,13 +2529,15 @@ parse_ml_table(location& loc)
     // XXX at lest one newline is needed.
     using skip_line = repeat<
         sequence<maybe<lex_ws>, maybe<lex_comment>, lex_newline>, at_least<1>>;
-    skip_line::invoke(loc);
-    lex_ws::invoke(loc);
+    skip_line::scan(loc);
+    lex_ws::scan(loc);
+    // a comment on the last line that does not end with a newline.
+    lex_comment::scan(loc);
 
     table_type tab;
     while(loc.iter() != loc.end())
     {
-        lex_ws::invoke(loc);
+        lex_ws::scan(loc);
         const auto before = loc.iter();
         if(const auto tmp = parse_array_table_key(loc)) // next table found
         {
@@ -2294,8 +2574,8 @@ parse_ml_table(location& loc)
         // `skip_line` matches `ws? + comment? + newline`, not `ws` or `comment`
         // itself. To skip the last ws and/or comment, call lexers.
         // It does not matter if these fails, so the return value is discarded.
-        lex_ws::invoke(loc);
-        lex_comment::invoke(loc);
+        lex_ws::scan(loc);
+        lex_comment::scan(loc);
 
         // skip_line is (whitespace? comment? newline)_{1,}. multiple empty lines
         // and comments after the last key-value pairs are allowed.
@@ -2303,7 +2583,7 @@ parse_ml_table(location& loc)
         if(!newline && loc.iter() != loc.end())
         {
             const auto before2 = loc.iter();
-            lex_ws::invoke(loc); // skip whitespace
+            lex_ws::scan(loc); // skip whitespace
             const auto msg = format_underline("toml::parse_table: "
                 "invalid line format", {{source_location(loc), concat_to_string(
                 "expected newline, but got '", show_char(*loc.iter()), "'.")}});
@@ -2314,41 +2594,25 @@ parse_ml_table(location& loc)
         // the skip_lines only matches with lines that includes newline.
         // to skip the last line that includes comment and/or whitespace
         // but no newline, call them one more time.
-        lex_ws::invoke(loc);
-        lex_comment::invoke(loc);
+        lex_ws::scan(loc);
+        lex_comment::scan(loc);
     }
     return ok(tab);
 }
 
-template<typename Value>
-result<Value, std::string> parse_toml_file(location& loc)
+// The first successive comments that are separated from the first value
+// by an empty line are for a file itself.
+// ```toml
+// # this is a comment for a file.
+//
+// key = "the first value"
+// ```
+// ```toml
+// # this is a comment for "the first value".
+// key = "the first value"
+// ```
+inline std::vector<std::string> parse_file_comments(location& loc)
 {
-    using value_type = Value;
-    using table_type = typename value_type::table_type;
-
-    const auto first = loc.iter();
-    if(first == loc.end())
-    {
-        // For empty files, return an empty table with an empty region (zero-length).
-        // Without the region, error messages would miss the filename.
-        return ok(value_type(table_type{}, region(loc, first, first), {}));
-    }
-
-    // put the first line as a region of a file
-    // Here first != loc.end(), so taking std::next is okay
-    const region file(loc, first, std::next(loc.iter()));
-
-    // The first successive comments that are separated from the first value
-    // by an empty line are for a file itself.
-    // ```toml
-    // # this is a comment for a file.
-    //
-    // key = "the first value"
-    // ```
-    // ```toml
-    // # this is a comment for "the first value".
-    // key = "the first value"
-    // ```
     std::vector<std::string> comments;
     using lex_first_comments = sequence<
         repeat<sequence<maybe<lex_ws>, lex_comment, lex_newline>, at_least<1>>,
@@ -2359,8 +2623,8 @@ result<Value, std::string> parse_toml_file(location& loc)
         location inner_loc(loc.name(), token.unwrap().str());
         while(inner_loc.iter() != inner_loc.end())
         {
-            maybe<lex_ws>::invoke(inner_loc); // remove ws if exists
-            if(lex_newline::invoke(inner_loc))
+            maybe<lex_ws>::scan(inner_loc); // remove ws if exists
+            if(lex_newline::scan(inner_loc))
             {
                 assert(inner_loc.iter() == inner_loc.end());
                 break; // empty line found.
@@ -2368,9 +2632,31 @@ result<Value, std::string> parse_toml_file(location& loc)
             auto com = lex_comment::invoke(inner_loc).unwrap().str();
             com.erase(com.begin()); // remove # sign
             comments.push_back(std::move(com));
-            lex_newline::invoke(inner_loc);
+            lex_newline::scan(inner_loc);
         }
     }
+    return comments;
+}
+
+template<typename Value>
+result<Value, std::string> parse_toml_file(location& loc)
+{
+    using value_type = Value;
+    using table_type = typename value_type::table_type;
+
+    const auto first = loc.iter();
+    if(first == loc.end())
+    {
+        // For empty files, return an empty table with an empty region (zero-length).
+        // Without the region, error messages would miss the filename.
+        return ok(value_type(table_type{}, region(loc, first, first), {}));
+    }
+
+    // put the first line as a region of a file
+    // Here first != loc.end(), so taking std::next is okay
+    const region file(loc, first, std::next(loc.iter()));
+
+    std::vector<std::string> comments = parse_file_comments(loc);
 
     table_type data;
     // root object is also a table, but without [tablename]
@@ -2428,51 +2714,147 @@ result<Value, std::string> parse_toml_file(location& loc)
     return ok(Value(std::move(data), file, comments));
 }
 
+// skip BOM if exists.
+// XXX component of BOM (like 0xEF) exceeds the representable range of
+// signed char, so on some (actually, most) of the environment, these cannot
+// be compared to char. However, since we are always out of luck, we need to
+// check our chars are equivalent to BOM. To do this, first we need to
+// convert char to unsigned char to guarantee the comparability.
+inline void skip_bom(location& loc)
+{
+    if(loc.source()->size() >= 3)
+    {
+        std::array<unsigned char, 3> BOM;
+        std::memcpy(BOM.data(), loc.source()->data(), 3);
+        if(BOM[0] == 0xEF && BOM[1] == 0xBB && BOM[2] == 0xBF)
+        {
+            loc.advance(3); // BOM found. skip.
+        }
+    }
+    return;
+}
+
 template<typename                     Comment = TOML11_DEFAULT_COMMENT_STRATEGY,
          template<typename ...> class Table   = std::unordered_map,
          template<typename ...> class Array   = std::vector>
 basic_value<Comment, Table, Array>
-parse(std::vector<char>& letters, const std::string& fname)
+parse(location& loc)
 {
     using value_type = basic_value<Comment, Table, Array>;
 
-    // append LF.
-    // Although TOML does not require LF at the EOF, to make parsing logic
-    // simpler, we "normalize" the content by adding LF if it does not exist.
-    // It also checks if the last char is CR, to avoid changing the meaning.
-    // This is not the *best* way to deal with the last character, but is a
-    // simple and quick fix.
-    if(!letters.empty() && letters.back() != '\n' && letters.back() != '\r')
+    // TOML does not require LF at the EOF. The parser accepts the last line
+    // without a newline, so the content is used as-is. It allows us to parse
+    // a read-only content, like a memory-mapped file, without copying it.
+
+    skip_bom(loc);
+
+    if (auto data = detail::parse_toml_file<value_type>(loc))
     {
-        letters.push_back('\n');
+        return std::move(data).unwrap();
+    }
+    else
+    {
+        throw syntax_error(std::move(data).unwrap_err(), source_location(loc));
     }
+}
 
+template<typename                     Comment = TOML11_DEFAULT_COMMENT_STRATEGY,
+         template<typename ...> class Table   = std::unordered_map,
+         template<typename ...> class Array   = std::vector>
+basic_value<Comment, Table, Array>
+parse(std::vector<char>& letters, const std::string& fname)
+{
     detail::location loc(std::move(fname), std::move(letters));
+    return detail::parse<Comment, Table, Array>(loc);
+}
 
-    // skip BOM if exists.
-    // XXX component of BOM (like 0xEF) exceeds the representable range of
-    // signed char, so on some (actually, most) of the environment, these cannot
-    // be compared to char. However, since we are always out of luck, we need to
-    // check our chars are equivalent to BOM. To do this, first we need to
-    // convert char to unsigned char to guarantee the comparability.
-    if(loc.source()->size() >= 3)
+// Reads a stream that does not support seeking by fixed-size chunks until EOF.
+// The buffer grows geometrically, so the whole input is copied O(1) times
+// amortized. Since the lexer moves back and forth in the content, the chunks
+// are stored contiguously and the parsing starts after EOF.
+constexpr std::size_t read_chunk_size = 64 * 1024;
+
+inline std::vector<char> read_by_chunks(std::istream& is)
+{
+    // reaching EOF in the middle of a chunk sets failbit. to avoid throwing
+    // an exception in that case, the exception mask is cleared while reading
+    // and restored after that.
+    const auto mask = is.exceptions();
+    is.exceptions(std::ios_base::goodbit);
+
+    std::vector<char> letters;
+    std::size_t size = 0;
+    while(true)
     {
-        std::array<unsigned char, 3> BOM;
-        std::memcpy(BOM.data(), loc.source()->data(), 3);
-        if(BOM[0] == 0xEF && BOM[1] == 0xBB && BOM[2] == 0xBF)
+        letters.resize(size + read_chunk_size);
+        is.read(letters.data() + size,
+                static_cast<std::streamsize>(read_chunk_size));
+        size += static_cast<std::size_t>(is.gcount());
+
+        // is.read sets failbit without eofbit only if the stream was not
+        // readable at all (e.g. a file that could not be opened).
+        if(is.bad() || (is.fail() && !is.eof()))
         {
-            loc.advance(3); // BOM found. skip.
+            // if the bit is in the mask, this throws std::ios_base::failure.
+            is.exceptions(mask);
+            throw std::ios_base::failure(
+                    "toml::parse: Error reading a non-seekable stream");
+        }
+        if(is.eof())
+        {
+            // EOF is not a failure. keep eofbit only.
+            is.clear(std::ios_base::eofbit);
+            is.exceptions(mask);
+            break;
         }
     }
+    letters.resize(size);
+    return letters;
+}
 
-    if (auto data = detail::parse_toml_file<value_type>(loc))
+inline std::vector<char> read_by_chunks(FILE* file, const std::string& fname)
+{
+    std::vector<char> letters;
+    std::size_t size = 0;
+    while(true)
     {
-        return std::move(data).unwrap();
+        letters.resize(size + read_chunk_size);
+        const auto n = std::fread(letters.data() + size, sizeof(char),
+                                  read_chunk_size, file);
+        size += n;
+        if(n < read_chunk_size)
+        {
+            if(std::ferror(file))
+            {
+                throw file_io_error(errno, "Failed to read", fname);
+            }
+            break; // EOF
+        }
     }
-    else
+    letters.resize(size);
+    return letters;
+}
+
+// read the rest of the stream as a sequence of char
+inline std::vector<char> read_stream(std::istream& is)
+{
+    const auto beg = is.tellg();
+    if(beg == std::istream::pos_type(-1))
     {
-        throw syntax_error(std::move(data).unwrap_err(), source_location(loc));
+        // the stream is not seekable (pipe, stdin, socket, ...). read it by
+        // chunks until EOF.
+        return read_by_chunks(is);
     }
+    is.seekg(0, std::ios::end);
+    const auto end = is.tellg();
+    const auto fsize = end - beg;
+    is.seekg(beg);
+
+    // read whole file as a sequence of char
+    assert(fsize >= 0);
+    std::vector<char> letters(static_cast<std::size_t>(fsize));
+    is.read(letters.data(), fsize);
+    return letters;
 }
 
 } // detail
@@ -2486,7 +2868,10 @@ parse(FILE * file, const std::string& fname)
     const long beg = std::ftell(file);
     if (beg == -1l)
     {
-        throw file_io_error(errno, "Failed to access", fname);
+        // the file is not seekable (pipe, stdin, socket, ...). read it by
+        // chunks until EOF.
+        auto letters = detail::read_by_chunks(file, fname);
+        return detail::parse<Comment, Table, Array>(letters, fname);
     }
 
     const int res_seekend = std::fseek(file, 0, SEEK_END);
@@ -2523,17 +2908,7 @@ template<typename                     Comment = TOML11_DEFAULT_COMMENT_STRATEGY,
 basic_value<Comment, Table, Array>
 parse(std::istream& is, std::string fname = "unknown file")
 {
-    const auto beg = is.tellg();
-    is.seekg(0, std::ios::end);
-    const auto end = is.tellg();
-    const auto fsize = end - beg;
-    is.seekg(beg);
-
-    // read whole file as a sequence of char
-    assert(fsize >= 0);
-    std::vector<char> letters(static_cast<std::size_t>(fsize));
-    is.read(letters.data(), fsize);
-
+    auto letters = detail::read_stream(is);
     return detail::parse<Comment, Table, Array>(letters, fname);
 }
 
@@ -2552,6 +2927,68 @@ basic_value<Comment, Table, Array> parse(std::string fname)
     return parse<Comment, Table, Array>(ifs, std::move(fname));
 }
 
+// Parses the content in [first, first + len) without copying it.
+// The values returned keep referring to the buffer to generate error messages
+// and to find comments, so the caller must keep the buffer alive as long as
+// the values (and toml::source_locations obtained from them) are used. If it
+// is not possible, use `toml::parse_str` that takes a copy of the content.
+template<typename                     Comment = TOML11_DEFAULT_COMMENT_STRATEGY,
+         template<typename ...> class Table   = std::unordered_map,
+         template<typename ...> class Array   = std::vector>
+basic_value<Comment, Table, Array>
+parse(const char* first, const std::size_t len, std::string fname = "unknown file")
+{
+    detail::location loc(std::move(fname),
+            std::make_shared<detail::borrowed_source>(first, len));
+    return detail::parse<Comment, Table, Array>(loc);
+}
+
+#if defined(TOML11_USING_STRING_VIEW) && TOML11_USING_STRING_VIEW>0
+// The same as above. The name is mandatory here to distinguish it from
+// `toml::parse(std::string filename)`.
+template<typename                     Comment = TOML11_DEFAULT_COMMENT_STRATEGY,
+         template<typename ...> class Table   = std::unordered_map,
+         template<typename ...> class Array   = std::vector>
+basic_value<Comment, Table, Array>
+parse(std::string_view content, std::string fname)
+{
+    return parse<Comment, Table, Array>(content.data(), content.size(),
+                                        std::move(fname));
+}
+#endif
+
+// Parses the content of a string. Unlike `toml::parse(const char*, size_t)`,
+// the values returned own the content, so the string can be discarded after
+// parsing. Pass an rvalue to avoid copying.
+template<typename                     Comment = TOML11_DEFAULT_COMMENT_STRATEGY,
+         template<typename ...> class Table   = std::unordered_map,
+         template<typename ...> class Array   = std::vector>
+basic_value<Comment, Table, Array>
+parse_str(std::string content, std::string fname = "unknown file")
+{
+    detail::location loc(std::move(fname), std::make_shared<detail::string_source>(
+                std::move(content)));
+    return detail::parse<Comment, Table, Array>(loc);
+}
+
+// Parses a file by mapping it into memory instead of reading it into a buffer.
+// The regions in the resulting value refer to the mapped pages directly, so no
+// byte is copied before lexing. The file should not be modified while the
+// value is alive. Where mmap is not available, it reads the file as usual.
+template<typename                     Comment = TOML11_DEFAULT_COMMENT_STRATEGY,
+         template<typename ...> class Table   = std::unordered_map,
+         template<typename ...> class Array   = std::vector>
+basic_value<Comment, Table, Array> parse_mapped(const std::string& fname)
+{
+#ifdef TOML11_HAS_MMAP
+    detail::location loc(fname,
+            std::make_shared<detail::mapped_file_source>(fname));
+    return detail::parse<Comment, Table, Array>(loc);
+#else
+    return parse<Comment, Table, Array>(fname);
+#endif
+}
+
 #ifdef TOML11_HAS_STD_FILESYSTEM
 // This function just forwards `parse("filename.toml")` to std::string version
 // to avoid the ambiguity in overload resolution.
@@ -0,0 +1,797 @@
+//     Copyright Toru Niina 2017.
+// Distributed under the MIT License.
+#ifndef TOML11_READER_HPP
+#define TOML11_READER_HPP
+#include <cstdint>
+#include <fstream>
+#include <istream>
+#include <string>
+#include <vector>
+
+#include "parser.hpp"
+
+namespace toml
+{
+
+// to avoid warnings about `token_t::key` is "shadowing" toml::key in
+// GCC -Wshadow=global.
+#if defined(__GNUC__) && !defined(__clang__)
+#  pragma GCC diagnostic push
+#  if 7 <= __GNUC__
+#    pragma GCC diagnostic ignored "-Wshadow=global"
+#  else // gcc-6 or older
+#    pragma GCC diagnostic ignored "-Wshadow"
+#  endif
+#endif
+enum class token_t : std::uint8_t
+{
+    end_of_file        = 0,
+    table_header       = 1, // [a.b]
+    array_table_header = 2, // [[a.b]]
+    key                = 3, // a.b = (a value follows)
+    value              = 4, // a scalar value. see reader::type().
+    array_begin        = 5, // [
+    array_end          = 6, // ]
+    inline_table_begin = 7, // {
+    inline_table_end   = 8, // }
+};
+#if defined(__GNUC__) && !defined(__clang__)
+#  pragma GCC diagnostic pop
+#endif
+
+template<typename charT, typename traits>
+inline std::basic_ostream<charT, traits>&
+operator<<(std::basic_ostream<charT, traits>& os, token_t t)
+{
+    switch(t)
+    {
+        case token_t::end_of_file        : os << "end_of_file";        return os;
+        case token_t::table_header       : os << "table_header";       return os;
+        case token_t::array_table_header : os << "array_table_header"; return os;
+        case token_t::key                : os << "key";                return os;
+        case token_t::value              : os << "value";              return os;
+        case token_t::array_begin        : os << "array_begin";        return os;
+        case token_t::array_end          : os << "array_end";          return os;
+        case token_t::inline_table_begin : os << "inline_table_begin"; return os;
+        case token_t::inline_table_end   : os << "inline_table_end";   return os;
+        default                          : os << "unknown";            return os;
+    }
+}
+
+// A pull parser. `next()` reads the next token and returns its kind.
+// Unlike toml::parse, it does not construct toml::value.
+//
+// ```cpp
+// toml::reader r("example.toml");
+// while(r.next() != toml::token_t::end_of_file)
+// {
+//     if(r.kind() == toml::token_t::key && r.keys().front() == "large_array")
+//     {
+//         r.skip(); // skip the value without converting it
+//     }
+//     else if(r.kind() == toml::token_t::value && r.type() == toml::value_t::integer)
+//     {
+//         std::cout << r.as_integer() << std::endl;
+//     }
+// }
+// ```
+//
+// Since it does not have a table, it does not check that a key or a table is
+// defined twice. Syntax errors are reported by throwing toml::syntax_error
+// with the same message as toml::parse.
+class reader
+{
+  public:
+
+    // the file is mapped into memory if possible.
+    explicit reader(const std::string& fname)
+        : reader(open_file(fname))
+    {}
+    explicit reader(std::istream& is, std::string fname = "unknown file")
+        : reader(detail::location(std::move(fname), detail::read_stream(is)))
+    {}
+    // the buffer is not copied. It should be alive while reading.
+    reader(const char* first, const std::size_t len,
+           std::string fname = "unknown file")
+        : reader(detail::location(std::move(fname),
+                 std::make_shared<detail::borrowed_source>(first, len)))
+    {}
+    explicit reader(detail::location loc)
+        : loc_(std::move(loc)), state_(state_t::line_start),
+          token_(token_t::end_of_file), type_(value_t::empty),
+          skipping_(false), first_(loc_.iter()), last_(loc_.iter()),
+          boolean_(false), integer_(0), floating_(0.0), string_(),
+          offset_datetime_(), local_datetime_(), local_date_(), local_time_()
+    {
+        detail::skip_bom(loc_);
+        first_ = loc_.iter();
+        last_  = loc_.iter();
+    }
+
+    reader(const reader&) = default;
+    reader(reader&&)      = default;
+    reader& operator=(const reader&) = default;
+    reader& operator=(reader&&)      = default;
+    ~reader() = default;
+
+    // reads the next token. After the end of the file, it keeps returning
+    // token_t::end_of_file.
+    token_t next()
+    {
+        switch(state_)
+        {
+            case state_t::line_start   : {return this->read_line();}
+            case state_t::key_value    : {return this->read_value_after_key();}
+            case state_t::array_element: {return this->read_array_element();}
+            case state_t::table_open   : {return this->read_table_open();}
+            case state_t::table_key    : {return this->read_key();}
+            case state_t::after_value  : {return this->read_after_value();}
+            default                    : {return this->set_token(
+                token_t::end_of_file, loc_.iter(), loc_.iter());}
+        }
+    }
+
+    // skips the part that belongs to the current token. It only lexes the
+    // skipped values; the conversion (and the range check in it) is omitted.
+    //
+    // - key                        : the value of the key.
+    // - array_begin/inline_table_begin: the elements and the closing bracket.
+    // - table_header/array_table_header: key-value pairs until the next header.
+    // - otherwise                  : nothing.
+    void skip()
+    {
+        const bool skipping = this->skipping_;
+        this->skipping_ = true;
+        try
+        {
+            switch(token_)
+            {
+                case token_t::key:
+                {
+                    const auto t = this->next();
+                    if(t == token_t::array_begin || t == token_t::inline_table_begin)
+                    {
+                        this->skip_container();
+                    }
+                    break;
+                }
+                case token_t::array_begin       : {this->skip_container();  break;}
+                case token_t::inline_table_begin: {this->skip_container();  break;}
+                case token_t::table_header      : {this->skip_table_body(); break;}
+                case token_t::array_table_header: {this->skip_table_body(); break;}
+                default: {break;}
+            }
+        }
+        catch(...)
+        {
+            this->skipping_ = skipping;
+            throw;
+        }
+        this->skipping_ = skipping;
+        return;
+    }
+
+    token_t kind() const noexcept {return token_;}
+
+    // keys of table_header, array_table_header, and key.
+    std::vector<key> const& keys() const noexcept {return keys_;}
+
+    // type of a scalar value. value_t::array or value_t::table if it is
+    // array_begin or inline_table_begin. value_t::empty otherwise.
+    value_t type() const noexcept {return type_;}
+
+    boolean                as_boolean()         const {this->check_type(value_t::boolean        ); return boolean_;}
+    integer                as_integer()         const {this->check_type(value_t::integer        ); return integer_;}
+    floating               as_floating()        const {this->check_type(value_t::floating       ); return floating_;}
+    string          const& as_string()          const {this->check_type(value_t::string         ); return string_;}
+    offset_datetime const& as_offset_datetime() const {this->check_type(value_t::offset_datetime); return offset_datetime_;}
+    local_datetime  const& as_local_datetime()  const {this->check_type(value_t::local_datetime ); return local_datetime_;}
+    local_date      const& as_local_date()      const {this->check_type(value_t::local_date     ); return local_date_;}
+    local_time      const& as_local_time()      const {this->check_type(value_t::local_time     ); return local_time_;}
+
+    // location of the current token
+    source_location location() const
+    {
+        return source_location(detail::region(loc_, first_, last_));
+    }
+
+  private:
+
+    using const_iterator = detail::location::const_iterator;
+    using lex_ws_comment_newline = detail::repeat<detail::either<
+        detail::lex_ws, detail::lex_newline, detail::lex_comment>,
+        detail::unlimited>;
+    using skip_line = detail::repeat<detail::sequence<
+            detail::maybe<detail::lex_ws>, detail::maybe<detail::lex_comment>,
+            detail::lex_newline>, detail::at_least<1>>;
+
+    enum class state_t : std::uint8_t
+    {
+        line_start,    // at the beginning of a line in the top-level
+        key_value,     // after `key =`
+        array_element, // after `[` or `,` in an array
+        table_open,    // after `{`
+        table_key,     // after `,` in an inline table
+        after_value,   // after a value. a separator or a newline follows
+        end
+    };
+    enum class context_t : std::uint8_t {in_array, in_inline_table};
+    struct frame
+    {
+        context_t      kind;
+        const_iterator first;     // `[` or `{`
+        const_iterator key_first; // the current key in an inline table
+    };
+
+    static detail::location open_file(const std::string& fname)
+    {
+#ifdef TOML11_HAS_MMAP
+        return detail::location(fname,
+                std::make_shared<detail::mapped_file_source>(fname));
+#else
+        std::ifstream ifs(fname, std::ios_base::binary);
+        if(!ifs.good())
+        {
+            throw std::ios_base::failure(
+                    "toml::parse: Error opening file \"" + fname + "\"");
+        }
+        ifs.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+        return detail::location(fname, detail::read_stream(ifs));
+#endif
+    }
+
+    token_t set_token(const token_t t, const_iterator first, const_iterator last)
+    {
+        this->token_ = t;
+        this->first_ = first;
+        this->last_  = last;
+        if(t != token_t::value && t != token_t::array_begin &&
+           t != token_t::inline_table_begin)
+        {
+            this->type_ = value_t::empty;
+        }
+        return t;
+    }
+
+    void check_type(const value_t t) const
+    {
+        if(this->token_ != token_t::value || this->type_ != t)
+        {
+            throw type_error(detail::format_underline(concat_to_string(
+                "toml::reader: the current token is not ", t, "."), {
+                    {this->location(), concat_to_string(
+                        "the current token is ", this->token_,
+                        this->token_ == token_t::value ?
+                        concat_to_string(" (", this->type_, ")") : "")}
+                }), this->location());
+        }
+    }
+
+    // ------------------------------------------------------------------------
+    // top-level
+
+    token_t read_line()
+    {
+        skip_line::scan(loc_);
+        detail::lex_ws::scan(loc_);
+        // a comment on the last line that does not end with a newline.
+        detail::lex_comment::scan(loc_);
+
+        if(loc_.iter() == loc_.end())
+        {
+            this->state_ = state_t::end;
+            return this->set_token(token_t::end_of_file, loc_.iter(), loc_.iter());
+        }
+        if(*loc_.iter() != '[') // a key-value pair. skip the header parsers.
+        {
+            return this->read_key();
+        }
+        if(auto aot = detail::parse_array_table_key(loc_))
+        {
+            this->keys_ = std::move(aot.unwrap().first);
+            const auto& reg = aot.unwrap().second;
+            return this->set_token(token_t::array_table_header, reg.first(), reg.last());
+        }
+        if(auto tab = detail::parse_table_key(loc_))
+        {
+            this->keys_ = std::move(tab.unwrap().first);
+            const auto& reg = tab.unwrap().second;
+            return this->set_token(token_t::table_header, reg.first(), reg.last());
+        }
+        return this->read_key();
+    }
+
+    // the rest of the line after a key-value pair.
+    void finish_line()
+    {
+        detail::lex_ws::scan(loc_);
+        detail::lex_comment::scan(loc_);
+
+        const auto newline = skip_line::scan(loc_);
+        if(!newline && loc_.iter() != loc_.end())
+        {
+            const auto before = loc_.iter();
+            detail::lex_ws::scan(loc_); // skip whitespace
+            const auto msg = detail::format_underline("toml::parse_table: "
+                "invalid line format", {{source_location(loc_), concat_to_string(
+                "expected newline, but got '", detail::show_char(*loc_.iter()), "'.")}});
+            loc_.reset(before);
+            throw syntax_error(msg, source_location(loc_));
+        }
+        this->state_ = state_t::line_start;
+        return;
+    }
+
+    // ------------------------------------------------------------------------
+    // key-value pair
+
+    token_t read_key()
+    {
+        const auto first = loc_.iter();
+        if(!stack_.empty())
+        {
+            if(first == loc_.end())
+            {
+                loc_.reset(stack_.back().first);
+                throw syntax_error(detail::format_underline(
+                    "toml::parse_inline_table: inline table did not closed by `}`",
+                    {{source_location(loc_), "should be closed"}}),
+                    source_location(loc_));
+            }
+            stack_.back().key_first = first;
+        }
+
+        // the keys without escape sequences are read into the buffers in keys_.
+        if(detail::read_key_parts(loc_, this->keys_))
+        {
+            const auto last = loc_.iter();
+            if(detail::lex_keyval_sep::scan(loc_))
+            {
+                this->state_ = state_t::key_value;
+                return this->set_token(token_t::key, first, last);
+            }
+            loc_.reset(first); // let parse_key and the following generate an error
+        }
+
+        auto key_reg = detail::parse_key(loc_);
+        if(!key_reg)
+        {
+            std::string msg = std::move(key_reg.unwrap_err());
+            // if the next token is keyvalue-separator, it means that there are no
+            // key. then we need to show error as "empty key is not allowed".
+            if(const auto keyval_sep = detail::lex_keyval_sep::invoke(loc_))
+            {
+                loc_.reset(first);
+                msg = detail::format_underline("toml::parse_key_value_pair: "
+                    "empty key is not allowed.",
+                    {{source_location(loc_), "key expected before '='"}});
+            }
+            this->throw_value_error(std::move(msg), first);
+        }
+
+        const auto kvsp = detail::lex_keyval_sep::scan(loc_);
+        if(!kvsp)
+        {
+            std::string msg;
+            // if the line contains '=' after the invalid sequence, possibly the
+            // error is in the key (like, invalid character in bare key).
+            const auto line_end = std::find(loc_.iter(), loc_.end(), '\n');
+            if(std::find(loc_.iter(), line_end, '=') != line_end)
+            {
+                msg = detail::format_underline("toml::parse_key_value_pair: "
+                    "invalid format for key",
+                    {{source_location(loc_), "invalid character in key"}},
+                    {"Did you forget '.' to separate dotted-key?",
+                    "Allowed characters for bare key are [0-9a-zA-Z_-]."});
+            }
+            else // if not, the error is lack of key-value separator.
+            {
+                msg = detail::format_underline("toml::parse_key_value_pair: "
+                    "missing key-value separator `=`",
+                    {{source_location(loc_), "should be `=`"}});
+            }
+            loc_.reset(first);
+            this->throw_value_error(std::move(msg), first);
+        }
+
+        this->keys_  = std::move(key_reg.unwrap().first);
+        this->state_ = state_t::key_value;
+        const auto& reg = key_reg.unwrap().second;
+        return this->set_token(token_t::key, reg.first(), reg.last());
+    }
+
+    token_t read_value_after_key()
+    {
+        const auto after_kvsp = loc_.iter(); // err msg
+        auto val = this->read_value();
+        if(!val)
+        {
+            std::string msg;
+            loc_.reset(after_kvsp);
+            // check there is something not a comment/whitespace after `=`
+            if(detail::sequence<detail::maybe<detail::lex_ws>,
+                    detail::maybe<detail::lex_comment>, detail::lex_line_end
+                >::scan(loc_))
+            {
+                loc_.reset(after_kvsp);
+                msg = detail::format_underline("toml::parse_key_value_pair: "
+                        "missing value after key-value separator '='",
+                        {{source_location(loc_), "expected value, but got nothing"}});
+            }
+            else // there is something not a comment/whitespace, so invalid format.
+            {
+                msg = std::move(val.unwrap_err());
+            }
+            loc_.reset(after_kvsp);
+            this->throw_value_error(std::move(msg), after_kvsp);
+        }
+        return val.unwrap();
+    }
+
+    // An error in a value propagates to the enclosing array (if any) and the
+    // array reports it in the same way as toml::parse_array.
+    [[noreturn]] void throw_value_error(std::string msg, const_iterator pos)
+    {
+        for(std::size_t i = stack_.size(); i != 0; --i)
+        {
+            const frame& f = stack_.at(i-1);
+            if(f.kind != context_t::in_array)
+            {
+                continue;
+            }
+            // the element of the array that contains the error
+            loc_.reset(i == stack_.size() ? pos : stack_.at(i).key_first);
+            auto array_start_loc = loc_;
+            array_start_loc.reset(f.first);
+
+            throw syntax_error(detail::format_underline("toml::parse_array: "
+                "value having invalid format appeared in an array", {
+                    {source_location(array_start_loc), "array starts here"},
+                    {source_location(loc_), "it is not a valid value."}
+                }), source_location(loc_));
+        }
+        throw syntax_error(msg, source_location(loc_));
+    }
+
+    // ------------------------------------------------------------------------
+    // values
+
+    result<token_t, std::string> read_value()
+    {
+        const auto first = loc_.iter();
+        if(first == loc_.end())
+        {
+            return err(detail::format_underline("toml::parse_value: input is empty",
+                       {{source_location(loc_), ""}}));
+        }
+
+        const auto classified = detail::classify_value(loc_);
+        if(!classified)
+        {
+            return err(classified.unwrap_err());
+        }
+
+        if(const auto last = classified.unwrap().last)
+        {
+            switch(classified.unwrap().type)
+            {
+                case value_t::integer        :
+                case value_t::floating       :
+                case value_t::offset_datetime:
+                case value_t::local_datetime :
+                case value_t::local_date     :
+                case value_t::local_time     : {return this->read_classified(classified.unwrap().type, last);}
+                default: {break;}
+            }
+        }
+
+        switch(classified.unwrap().type)
+        {
+            case value_t::boolean:
+            {
+                if(detail::lex_boolean::scan(loc_))
+                {
+                    this->boolean_ = (*first == 't');
+                    return ok(this->set_value_token(value_t::boolean, first));
+                }
+                loc_.reset(first);
+                return this->read_scalar<detail::lex_boolean>(detail::parse_boolean, boolean_, value_t::boolean);
+            }
+            case value_t::string:
+            {
+                if(!this->skipping_ &&
+                   detail::read_plain_string(loc_, string_.str, string_.kind))
+                {
+                    return ok(this->set_value_token(value_t::string, first));
+                }
+                return this->read_scalar<detail::lex_string>(detail::parse_string, string_, value_t::string);
+            }
+            case value_t::integer        : {return this->read_scalar<detail::lex_integer         >(detail::parse_integer        , integer_        , value_t::integer        );}
+            case value_t::floating       : {return this->read_scalar<detail::lex_float           >(detail::parse_floating       , floating_       , value_t::floating       );}
+            case value_t::offset_datetime: {return this->read_scalar<detail::lex_offset_date_time>(detail::parse_offset_datetime, offset_datetime_, value_t::offset_datetime);}
+            case value_t::local_datetime : {return this->read_scalar<detail::lex_local_date_time >(detail::parse_local_datetime , local_datetime_ , value_t::local_datetime );}
+            case value_t::local_date     : {return this->read_scalar<detail::lex_local_date      >(detail::parse_local_date     , local_date_     , value_t::local_date     );}
+            case value_t::local_time     : {return this->read_scalar<detail::lex_local_time      >(detail::parse_local_time     , local_time_     , value_t::local_time     );}
+            case value_t::array:
+            {
+                loc_.advance(); // skip `[`
+                stack_.push_back(frame{context_t::in_array, first, first});
+                this->state_ = state_t::array_element;
+                this->type_  = value_t::array;
+                return ok(this->set_token(token_t::array_begin, first, loc_.iter()));
+            }
+            case value_t::table:
+            {
+                loc_.advance(); // skip `{`
+                stack_.push_back(frame{context_t::in_inline_table, first, first});
+                this->state_ = state_t::table_open;
+                this->type_  = value_t::table;
+                return ok(this->set_token(token_t::inline_table_begin, first, loc_.iter()));
+            }
+            default:
+            {
+                const auto msg = detail::format_underline("toml::parse_value: "
+                        "unknown token appeared", {{source_location(loc_), "unknown"}});
+                loc_.reset(first);
+                return err(msg);
+            }
+        }
+    }
+
+    template<typename Lexer, typename T>
+    result<token_t, std::string> read_scalar(
+        result<std::pair<T, detail::region>, std::string>(*parser)(detail::location&),
+        T& dst, const value_t t)
+    {
+        const auto first = loc_.iter();
+        if(this->skipping_)
+        {
+            if(Lexer::scan(loc_))
+            {
+                return ok(this->set_value_token(t, first));
+            }
+            loc_.reset(first); // let the parser generate an error message
+        }
+        auto val = parser(loc_);
+        if(!val)
+        {
+            return err(std::move(val.unwrap_err()));
+        }
+        dst = std::move(val.unwrap().first);
+        return ok(this->set_value_token(t, first));
+    }
+
+    // the classifier has already found the end of the token. The token is
+    // converted without making a region; the region is made only if the
+    // conversion fails, to generate the same error message as toml::parse.
+    result<token_t, std::string> read_classified(const value_t t, const_iterator last)
+    {
+        const auto first = loc_.iter();
+        loc_.advance(last - first);
+        if(this->skipping_)
+        {
+            return ok(this->set_value_token(t, first));
+        }
+        switch(t)
+        {
+            case value_t::integer:
+            {
+                if(!detail::read_integer_token(first, last, integer_))
+                {
+                    return err(detail::parse_integer_token(loc_,
+                                detail::region(loc_, first, last)).unwrap_err());
+                }
+                break;
+            }
+            case value_t::floating:
+            {
+                if(!detail::read_floating_token(first, last, floating_))
+                {
+                    return err(detail::parse_floating_token(loc_,
+                                detail::region(loc_, first, last)).unwrap_err());
+                }
+                break;
+            }
+            case value_t::offset_datetime: {offset_datetime_ = detail::read_offset_datetime(loc_, first, last); break;}
+            case value_t::local_datetime : {local_datetime_  = detail::read_local_datetime (loc_, first, last); break;}
+            case value_t::local_date     : {local_date_      = detail::read_local_date     (loc_, first, last); break;}
+            case value_t::local_time     : {local_time_      = detail::read_local_time     (loc_, first, last, first, last); break;}
+            default: {break;}
+        }
+        return ok(this->set_value_token(t, first));
+    }
+
+    token_t set_value_token(const value_t t, const_iterator first)
+    {
+        this->type_  = t;
+        this->state_ = state_t::after_value;
+        return this->set_token(token_t::value, first, loc_.iter());
+    }
+
+    token_t read_after_value()
+    {
+        if(stack_.empty())
+        {
+            this->finish_line();
+            return this->read_line();
+        }
+        if(stack_.back().kind == context_t::in_array)
+        {
+            using lex_array_separator = detail::sequence<
+                detail::maybe<lex_ws_comment_newline>, detail::character<','>>;
+            if(lex_array_separator::scan(loc_))
+            {
+                return this->read_array_element();
+            }
+            lex_ws_comment_newline::scan(loc_);
+            if(loc_.iter() != loc_.end() && *loc_.iter() == ']')
+            {
+                return this->close(token_t::array_end);
+            }
+            auto array_start_loc = loc_;
+            array_start_loc.reset(stack_.back().first);
+
+            throw syntax_error(detail::format_underline("toml::parse_array:"
+                " missing array separator `,` after a value", {
+                    {source_location(array_start_loc), "array starts here"},
+                    {source_location(loc_),            "should be `,`"}
+                }), source_location(loc_));
+        }
+
+        using lex_table_separator = detail::sequence<
+            detail::maybe<detail::lex_ws>, detail::character<','>>;
+        if(!lex_table_separator::scan(loc_))
+        {
+            detail::maybe<detail::lex_ws>::scan(loc_);
+
+            if(loc_.iter() == loc_.end())
+            {
+                throw syntax_error(detail::format_underline(
+                    "toml::parse_inline_table: missing table separator `}` ",
+                    {{source_location(loc_), "should be `}`"}}),
+                    source_location(loc_));
+            }
+            else if(*loc_.iter() == '}')
+            {
+                return this->close(token_t::inline_table_end);
+            }
+            else if(*loc_.iter() == '#' || *loc_.iter() == '\r' || *loc_.iter() == '\n')
+            {
+                throw syntax_error(detail::format_underline(
+                    "toml::parse_inline_table: missing curly brace `}`",
+                    {{source_location(loc_), "should be `}`"}}),
+                    source_location(loc_));
+            }
+            else
+            {
+                throw syntax_error(detail::format_underline(
+                    "toml::parse_inline_table: missing table separator `,` ",
+                    {{source_location(loc_), "should be `,`"}}),
+                    source_location(loc_));
+            }
+        }
+        detail::maybe<detail::lex_ws>::scan(loc_);
+        if(loc_.iter() != loc_.end() && *loc_.iter() == '}')
+        {
+            throw syntax_error(detail::format_underline(
+                "toml::parse_inline_table: trailing comma is not allowed in"
+                " an inline table",
+                {{source_location(loc_), "should be `}`"}}),
+                source_location(loc_));
+        }
+        this->state_ = state_t::table_key;
+        return this->read_key();
+    }
+
+    token_t read_array_element()
+    {
+        if(loc_.iter() == loc_.end())
+        {
+            loc_.reset(stack_.back().first);
+            throw syntax_error(detail::format_underline("toml::parse_array: "
+                    "array did not closed by `]`",
+                    {{source_location(loc_), "should be closed"}}),
+                    source_location(loc_));
+        }
+        lex_ws_comment_newline::scan(loc_); // skip
+
+        if(loc_.iter() != loc_.end() && *loc_.iter() == ']')
+        {
+            return this->close(token_t::array_end);
+        }
+        const auto first = loc_.iter();
+        auto val = this->read_value();
+        if(!val)
+        {
+            this->throw_value_error(std::move(val.unwrap_err()), first);
+        }
+        return val.unwrap();
+    }
+
+    token_t read_table_open()
+    {
+        // check if the inline table is an empty table = { }
+        detail::maybe<detail::lex_ws>::scan(loc_);
+        if(loc_.iter() != loc_.end() && *loc_.iter() == '}')
+        {
+            return this->close(token_t::inline_table_end);
+        }
+        this->state_ = state_t::table_key;
+        return this->read_key();
+    }
+
+    token_t close(const token_t t)
+    {
+        const auto first = loc_.iter();
+        loc_.advance(); // skip `]` or `}`
+        stack_.pop_back();
+        this->state_ = state_t::after_value;
+        return this->set_token(t, first, loc_.iter());
+    }
+
+    // ------------------------------------------------------------------------
+    // skip
+
+    void skip_container()
+    {
+        std::size_t depth = 1;
+        while(depth != 0)
+        {
+            switch(this->next())
+            {
+                case token_t::array_begin       : {++depth; break;}
+                case token_t::inline_table_begin: {++depth; break;}
+                case token_t::array_end         : {--depth; break;}
+                case token_t::inline_table_end  : {--depth; break;}
+                default: {break;}
+            }
+        }
+        return;
+    }
+
+    void skip_table_body()
+    {
+        while(true)
+        {
+            if(this->state_ == state_t::after_value)
+            {
+                this->finish_line();
+            }
+            skip_line::scan(loc_);
+            detail::lex_ws::scan(loc_);
+            detail::lex_comment::scan(loc_);
+
+            // a line that starts with `[` is always a table header.
+            if(loc_.iter() == loc_.end() || *loc_.iter() == '[')
+            {
+                return;
+            }
+            this->next(); // key
+            this->skip(); // value
+        }
+    }
+
+  private:
+
+    detail::location   loc_;
+    state_t            state_;
+    token_t            token_;
+    value_t            type_;
+    bool               skipping_;
+    const_iterator     first_; // range of the current token
+    const_iterator     last_;
+    std::vector<key>   keys_;
+    std::vector<frame> stack_;
+
+    boolean            boolean_;
+    integer            integer_;
+    floating           floating_;
+    string             string_;
+    offset_datetime    offset_datetime_;
+    local_datetime     local_datetime_;
+    local_date         local_date_;
+    local_time         local_time_;
+};
+
+} // toml
+#endif// TOML11_READER_HPP
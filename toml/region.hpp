@@ -2,7 +2,10 @@
 // Distributed under the MIT License.
 #ifndef TOML11_REGION_HPP
 #define TOML11_REGION_HPP
+#include <atomic>
 #include <memory>
+#include <new>
+#include <string>
 #include <vector>
 #include <algorithm>
 #include <initializer_list>
@@ -10,6 +13,7 @@
 #include <iomanip>
 #include <cassert>
 #include "color.hpp"
+#include "simd.hpp"
 
 namespace toml
 {
@@ -62,6 +66,164 @@ struct region_base
     // ```
 };
 
+// source_base is a handle to the whole content of a file. location and region share
+// it and point characters in it by `const char*`. where the characters actually
+// live (a std::vector owned by the source, a memory-mapped file, ...) is up to
+// the derived class. the range never changes after construction.
+//
+// It also answers the line of a character by a binary search on an index of
+// the first characters of the lines. The index is built when it is first used,
+// so a source that is never asked for a line does not pay for it.
+struct source_base
+{
+    source_base(const source_base&) = delete;
+    source_base& operator=(const source_base&) = delete;
+    virtual ~source_base()
+    {
+        delete line_starts_.load(std::memory_order_acquire);
+    }
+
+    const char* begin() const noexcept {return first_;}
+    const char* end()   const noexcept {return last_;}
+    const char* data()  const noexcept {return first_;}
+    std::size_t size()  const noexcept
+    {
+        return static_cast<std::size_t>(last_ - first_);
+    }
+    bool empty() const noexcept {return first_ == last_;}
+
+    // 1-origin line number of the line that contains `p`.
+    std::size_t line_number(const char* p) const noexcept
+    {
+        const auto starts = this->line_starts();
+        if(!starts)
+        {
+            return 1 + static_cast<std::size_t>(std::count(first_, p, '\n'));
+        }
+        return static_cast<std::size_t>(std::distance(starts->begin(),
+            std::upper_bound(starts->begin(), starts->end(), this->offset(p))));
+    }
+    // the first character of the line that contains `p`.
+    const char* line_begin(const char* p) const noexcept
+    {
+        const auto starts = this->line_starts();
+        if(!starts)
+        {
+            const std::reverse_iterator<const char*> rfirst(p), rlast(first_);
+            return std::find(rfirst, rlast, '\n').base();
+        }
+        return first_ + (*starts)[this->line_number(p) - 1];
+    }
+    // the '\n' at the end of the line that contains `p`, or `end()`.
+    const char* line_end(const char* p) const noexcept
+    {
+        const auto starts = this->line_starts();
+        if(!starts)
+        {
+            return std::find(p, last_, '\n');
+        }
+        const auto line = this->line_number(p);
+        return line < starts->size() ? first_ + (*starts)[line] - 1 : last_;
+    }
+
+  protected:
+
+    source_base() noexcept
+      : first_(nullptr), last_(nullptr), line_starts_(nullptr)
+    {}
+
+    // derived classes set the range after they prepare their storage.
+    void set_range(const char* first, const char* last) noexcept
+    {
+        first_ = first;
+        last_  = last;
+    }
+
+  private:
+
+    std::size_t offset(const char* p) const noexcept
+    {
+        assert(first_ <= p && p <= last_);
+        return static_cast<std::size_t>(p - first_);
+    }
+
+    // a source is shared by threads, so the index is built without a lock.
+    // if two threads build it at the same time, one of them is discarded.
+    // It is used while an error message is formatted, so it does not throw.
+    // If the index cannot be allocated, it returns nullptr and the callers
+    // scan the content instead.
+    const std::vector<std::size_t>* line_starts() const noexcept
+    {
+        if(const auto built = line_starts_.load(std::memory_order_acquire))
+        {
+            return built;
+        }
+        std::unique_ptr<const std::vector<std::size_t>> starts;
+        try
+        {
+            starts.reset(new std::vector<std::size_t>(
+                        find_line_starts(first_, last_)));
+        }
+        catch(const std::bad_alloc&)
+        {
+            return nullptr;
+        }
+
+        const std::vector<std::size_t>* expected = nullptr;
+        if(line_starts_.compare_exchange_strong(expected, starts.get(),
+                    std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            return starts.release();
+        }
+        return expected;
+    }
+
+    const char* first_;
+    const char* last_;
+    mutable std::atomic<const std::vector<std::size_t>*> line_starts_;
+};
+
+// a source that owns its content as a std::vector<char>.
+struct vector_source final : public source_base
+{
+    explicit vector_source(std::vector<char> cont)
+      : container_(std::move(cont))
+    {
+        this->set_range(container_.data(),
+                        container_.data() + container_.size());
+    }
+    ~vector_source() override = default;
+
+  private:
+    std::vector<char> container_;
+};
+
+// a source that owns its content as a std::string.
+struct string_source final : public source_base
+{
+    explicit string_source(std::string cont)
+      : container_(std::move(cont))
+    {
+        this->set_range(container_.data(),
+                        container_.data() + container_.size());
+    }
+    ~string_source() override = default;
+
+  private:
+    std::string container_;
+};
+
+// a source that refers to a buffer owned by someone else. The owner must keep
+// the buffer alive as long as the locations and regions referring it are used.
+struct borrowed_source final : public source_base
+{
+    borrowed_source(const char* first, const std::size_t len) noexcept
+    {
+        this->set_range(first, first + len);
+    }
+    ~borrowed_source() override = default;
+};
+
 // location represents a position in a container, which contains a file content.
 // it can be considered as a region that contains only one character.
 //
@@ -69,17 +231,21 @@ struct region_base
 // location.
 struct location final : public region_base
 {
-    using const_iterator  = typename std::vector<char>::const_iterator;
-    using difference_type = typename std::iterator_traits<const_iterator>::difference_type;
-    using source_ptr      = std::shared_ptr<const std::vector<char>>;
+    using const_iterator  = const char*;
+    using difference_type = std::ptrdiff_t;
+    using source_ptr      = std::shared_ptr<const source_base>;
 
     location(std::string source_name, std::vector<char> cont)
-      : source_(std::make_shared<std::vector<char>>(std::move(cont))),
-        line_number_(1), source_name_(std::move(source_name)), iter_(source_->cbegin())
+      : source_(std::make_shared<vector_source>(std::move(cont))),
+        source_name_(std::move(source_name)), iter_(source_->begin())
     {}
     location(std::string source_name, const std::string& cont)
-      : source_(std::make_shared<std::vector<char>>(cont.begin(), cont.end())),
-        line_number_(1), source_name_(std::move(source_name)), iter_(source_->cbegin())
+      : source_(std::make_shared<string_source>(cont)),
+        source_name_(std::move(source_name)), iter_(source_->begin())
+    {}
+    location(std::string source_name, source_ptr src)
+      : source_(std::move(src)),
+        source_name_(std::move(source_name)), iter_(source_->begin())
     {}
 
     location(const location&) = default;
@@ -91,48 +257,32 @@ struct location final : public region_base
     bool is_ok() const noexcept override {return static_cast<bool>(source_);}
     char front() const noexcept override {return *iter_;}
 
-    // this const prohibits codes like `++(loc.iter())`.
-    std::add_const<const_iterator>::type iter()  const noexcept {return iter_;}
+    // it returns a pointer by value, so codes like `++(loc.iter())` are
+    // prohibited. use advance(), retrace() or reset() to move the location.
+    const_iterator iter()  const noexcept {return iter_;}
 
-    const_iterator begin() const noexcept {return source_->cbegin();}
-    const_iterator end()   const noexcept {return source_->cend();}
+    const_iterator begin() const noexcept {return source_->begin();}
+    const_iterator end()   const noexcept {return source_->end();}
 
     // XXX `location::line_num()` used to be implemented using `std::count` to
     // count a number of '\n'. But with a long toml file (typically, 10k lines),
     // it becomes intolerably slow because each time it generates error messages,
-    // it counts '\n' from thousands of characters. To workaround it, I decided
-    // to introduce `location::line_number_` member variable and synchronize it
-    // to the location changes the point to look. So an overload of `iter()`
-    // which returns mutable reference is removed and `advance()`, `retrace()`
-    // and `reset()` is added.
+    // it counts '\n' from thousands of characters. Then `location` kept track
+    // of the line number by counting '\n's on each move, but it made each move
+    // cost. Now the source has an index of lines and a line number is looked up
+    // only when it is needed.
     void advance(difference_type n = 1) noexcept
     {
-        this->line_number_ += static_cast<std::size_t>(
-                std::count(this->iter_, std::next(this->iter_, n), '\n'));
         this->iter_ += n;
         return;
     }
     void retrace(difference_type n = 1) noexcept
     {
-        this->line_number_ -= static_cast<std::size_t>(
-                std::count(std::prev(this->iter_, n), this->iter_, '\n'));
         this->iter_ -= n;
         return;
     }
     void reset(const_iterator rollback) noexcept
     {
-        // since c++11, std::distance works in both ways for random-access
-        // iterators and returns a negative value if `first > last`.
-        if(0 <= std::distance(rollback, this->iter_)) // rollback < iter
-        {
-            this->line_number_ -= static_cast<std::size_t>(
-                    std::count(rollback, this->iter_, '\n'));
-        }
-        else // iter < rollback [[unlikely]]
-        {
-            this->line_number_ += static_cast<std::size_t>(
-                    std::count(this->iter_, rollback, '\n'));
-        }
         this->iter_ = rollback;
         return;
     }
@@ -142,7 +292,7 @@ struct location final : public region_base
 
     std::string line_num() const override
     {
-        return std::to_string(this->line_number_);
+        return std::to_string(this->source_->line_number(this->iter()));
     }
 
     std::string line() const override
@@ -152,13 +302,11 @@ struct location final : public region_base
 
     const_iterator line_begin() const noexcept
     {
-        using reverse_iterator = std::reverse_iterator<const_iterator>;
-        return std::find(reverse_iterator(this->iter()),
-                         reverse_iterator(this->begin()), '\n').base();
+        return this->source_->line_begin(this->iter());
     }
     const_iterator line_end() const noexcept
     {
-        return std::find(this->iter(), this->end(), '\n');
+        return this->source_->line_end(this->iter());
     }
 
     // location is always points a character. so the size is 1.
@@ -185,7 +333,6 @@ struct location final : public region_base
   private:
 
     source_ptr     source_;
-    std::size_t    line_number_;
     std::string    source_name_;
     const_iterator iter_;
 };
@@ -196,8 +343,8 @@ struct location final : public region_base
 // and last location.
 struct region final : public region_base
 {
-    using const_iterator = typename std::vector<char>::const_iterator;
-    using source_ptr     = std::shared_ptr<const std::vector<char>>;
+    using const_iterator = location::const_iterator;
+    using source_ptr     = location::source_ptr;
 
     // delete default constructor. source_ never be null.
     region() = delete;
@@ -248,7 +395,7 @@ struct region final : public region_base
     }
     std::string line_num() const override
     {
-        return std::to_string(1 + std::count(this->begin(), this->first(), '\n'));
+        return std::to_string(this->source_->line_number(this->first()));
     }
 
     std::size_t size() const noexcept override
@@ -277,17 +424,15 @@ struct region final : public region_base
 
     const_iterator line_begin() const noexcept
     {
-        using reverse_iterator = std::reverse_iterator<const_iterator>;
-        return std::find(reverse_iterator(this->first()),
-                         reverse_iterator(this->begin()), '\n').base();
+        return this->source_->line_begin(this->first());
     }
     const_iterator line_end() const noexcept
     {
-        return std::find(this->last(), this->end(), '\n');
+        return this->source_->line_end(this->last());
     }
 
-    const_iterator begin() const noexcept {return source_->cbegin();}
-    const_iterator end()   const noexcept {return source_->cend();}
+    const_iterator begin() const noexcept {return source_->begin();}
+    const_iterator end()   const noexcept {return source_->end();}
     const_iterator first() const noexcept {return first_;}
     const_iterator last()  const noexcept {return last_;}
 
@@ -383,22 +528,22 @@ struct region final : public region_base
             //   3.14 # do this if you need a comment here.
             // ]
             // ```
-            const auto comment_found =
-                std::find(this->last(), this->line_end(), '#');
-            if(comment_found != this->line_end()) // '#' found
+            //
+            // table = {key = "value"} # what is this for?
+            // the above comment is not for "value", but {key="value"}. So only
+            // spaces, tabs and commas are allowed before the '#'. It stops at
+            // the first other character, so a long line (e.g. an array with
+            // many elements) is not scanned for each element.
+            const auto comment_found = std::find_if(this->last(), this->end(),
+                [](const char c) noexcept -> bool {
+                    return !(c == ' ' || c == '\t' || c == ',');
+                });
+            if(comment_found != this->end() && *comment_found == '#')
             {
-                // table = {key = "value"} # what is this for?
-                // the above comment is not for "value", but {key="value"}.
-                if(comment_found == std::find_if(this->last(), comment_found,
-                    [](const char c) noexcept -> bool {
-                        return !(c == ' ' || c == '\t' || c == ',');
-                    }))
-                {
-                    // unwrap the first '#' by std::next.
-                    auto s = make_string(std::next(comment_found), this->line_end());
-                    if(!s.empty() && s.back() == '\r') {s.pop_back();}
-                    com.push_back(std::move(s));
-                }
+                // unwrap the first '#' by std::next.
+                auto s = make_string(std::next(comment_found), this->line_end());
+                if(!s.empty() && s.back() == '\r') {s.pop_back();}
+                com.push_back(std::move(s));
             }
         }
         return com;
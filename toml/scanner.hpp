@@ -0,0 +1,140 @@
+//     Copyright Toru Niina 2017.
+// Distributed under the MIT License.
+#ifndef TOML11_SCANNER_HPP
+#define TOML11_SCANNER_HPP
+#include <algorithm>
+#include <cstddef>
+
+namespace toml
+{
+namespace detail
+{
+
+// Scanners that find the structure of a document without parsing values.
+//
+// They only look at quotes, brackets, braces and comments, so they are much
+// faster than lexers. They do not validate anything; an invalid input should
+// be passed to the parser to get a proper error message.
+
+// skips a string that starts at `first` (`"`, `'`, `"""` or `'''`) and returns
+// the next of the closing quote. If it is not closed, it returns the position
+// of the newline (one-line strings) or `last` (multi-line strings).
+inline const char* skip_quoted(const char* first, const char* last) noexcept
+{
+    const char quote  = *first;
+    const bool escape = (quote == '"');
+    if(last - first >= 3 && first[1] == quote && first[2] == quote)
+    {
+        const char* iter = first + 3;
+        while(iter != last)
+        {
+            if(escape && *iter == '\\')
+            {
+                iter += (last - iter >= 2) ? 2 : 1;
+                continue;
+            }
+            if(*iter == quote && last - iter >= 3 &&
+               iter[1] == quote && iter[2] == quote)
+            {
+                iter += 3;
+                // up to two quotes are allowed just before the closing quotes,
+                // like `"""foo"""""`.
+                for(int i=0; i<2 && iter != last && *iter == quote; ++i)
+                {
+                    ++iter;
+                }
+                return iter;
+            }
+            ++iter;
+        }
+        return last;
+    }
+
+    const char* iter = first + 1;
+    while(iter != last && *iter != '\n')
+    {
+        if(escape && *iter == '\\')
+        {
+            iter += (last - iter >= 2) ? 2 : 1;
+            continue;
+        }
+        if(*iter == quote)
+        {
+            return iter + 1;
+        }
+        ++iter;
+    }
+    return iter;
+}
+
+// finds the next `[` that begins a line outside of arrays, inline tables and
+// multi-line strings, i.e. the next [table] or [[array.of.tables]].
+// `first` should point the beginning of a line. It returns `last` if there is
+// no table header.
+inline const char* find_table_header(const char* first, const char* last) noexcept
+{
+    std::size_t depth = 0; // nesting of [] and {} in a value
+    bool line_start   = true;
+    const char* iter  = first;
+    while(iter != last)
+    {
+        const char c = *iter;
+        if(line_start)
+        {
+            if(c == ' ' || c == '\t')
+            {
+                ++iter;
+                continue;
+            }
+            if(c == '[' && depth == 0)
+            {
+                return iter;
+            }
+            line_start = false;
+        }
+        switch(c)
+        {
+            case '"' : {iter = skip_quoted(iter, last); continue;}
+            case '\'': {iter = skip_quoted(iter, last); continue;}
+            case '#' : {iter = std::find(iter, last, '\n'); continue;}
+            case '[' : {++depth; break;}
+            case '{' : {++depth; break;}
+            case ']' : {if(depth != 0) {--depth;} break;}
+            case '}' : {if(depth != 0) {--depth;} break;}
+            case '\n': {line_start = true; break;}
+            default  : {break;}
+        }
+        ++iter;
+    }
+    return last;
+}
+
+// finds the end of a value that starts at `first`, i.e. the first newline
+// outside of arrays, inline tables and strings. A comment after the value is
+// also skipped. It returns `last` if there is no newline.
+inline const char* find_value_end(const char* first, const char* last) noexcept
+{
+    std::size_t depth = 0; // nesting of [] and {}
+    const char* iter  = first;
+    while(iter != last)
+    {
+        switch(*iter)
+        {
+            case '"' : {iter = skip_quoted(iter, last); continue;}
+            case '\'': {iter = skip_quoted(iter, last); continue;}
+            case '#' : {iter = std::find(iter, last, '\n'); continue;}
+            case '[' : {++depth; break;}
+            case '{' : {++depth; break;}
+            case ']' : {if(depth != 0) {--depth;} break;}
+            case '}' : {if(depth != 0) {--depth;} break;}
+            case '\n': {if(depth == 0) {return iter;} break;}
+            default  : {break;}
+        }
+        ++iter;
+    }
+    return last;
+}
+
+} // detail
+} // toml
+#endif// TOML11_SCANNER_HPP
@@ -0,0 +1,291 @@
+//     Copyright Toru Niina 2017.
+// Distributed under the MIT License.
+#ifndef TOML11_SELECTIVE_PARSER_HPP
+#define TOML11_SELECTIVE_PARSER_HPP
+#include <algorithm>
+#include <fstream>
+#include <istream>
+#include <string>
+#include <vector>
+
+#include "parser.hpp"
+#include "scanner.hpp"
+
+namespace toml
+{
+namespace detail
+{
+
+// checks if one of the paths is a prefix of the keys, or the keys are a
+// prefix of one of the paths. In both cases, the value is needed.
+inline bool is_on_selected_path(const std::vector<std::vector<key>>& paths,
+                                const std::vector<key>& keys)
+{
+    for(const auto& path : paths)
+    {
+        const auto n = static_cast<std::ptrdiff_t>(std::min(path.size(), keys.size()));
+        if(std::equal(path.begin(), path.begin() + n, keys.begin()))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+inline std::vector<std::vector<key>>
+parse_key_paths(const std::vector<std::string>& key_paths)
+{
+    std::vector<std::vector<key>> paths;
+    paths.reserve(key_paths.size());
+    for(const auto& str : key_paths)
+    {
+        location loc("toml::parse_only", str);
+        auto keys = parse_key(loc);
+        if(!keys || loc.iter() != loc.end())
+        {
+            throw syntax_error(format_underline(
+                "toml::parse_only: invalid key path",
+                {{source_location(loc), "here"}}), source_location(loc));
+        }
+        paths.push_back(std::move(keys.unwrap().first));
+    }
+    return paths;
+}
+
+// the same as parse_ml_table, but the key-value pairs that are not on the
+// selected paths are skipped by a scanner without being parsed.
+template<typename Value>
+typename Value::table_type
+parse_selected_ml_table(location& loc, const std::vector<std::vector<key>>& paths,
+                        const std::vector<key>& table_keys)
+{
+    using value_type = Value;
+    using table_type = typename value_type::table_type;
+
+    table_type tab;
+    if(loc.iter() == loc.end())
+    {
+        return tab;
+    }
+
+    using skip_line = repeat<
+        sequence<maybe<lex_ws>, maybe<lex_comment>, lex_newline>, at_least<1>>;
+    skip_line::scan(loc);
+    lex_ws::scan(loc);
+    lex_comment::scan(loc);
+
+    std::vector<key> full_keys(table_keys);
+    while(loc.iter() != loc.end())
+    {
+        lex_ws::scan(loc);
+        if(loc.iter() != loc.end() && *loc.iter() == '[')
+        {
+            return tab; // next table found
+        }
+
+        const auto first = loc.iter();
+        bool is_skipped = false;
+        const auto key_reg = parse_key(loc);
+        if(key_reg && lex_keyval_sep::scan(loc))
+        {
+            const auto& keys = key_reg.unwrap().first;
+            full_keys.resize(table_keys.size());
+            full_keys.insert(full_keys.end(), keys.begin(), keys.end());
+            if(!is_on_selected_path(paths, full_keys))
+            {
+                loc.reset(find_value_end(loc.iter(), loc.end()));
+                is_skipped = true;
+            }
+        }
+
+        if(!is_skipped)
+        {
+            loc.reset(first);
+            if(const auto kv = parse_key_value_pair<value_type>(loc))
+            {
+                const auto&             kvpair  = kv.unwrap();
+                const std::vector<key>& keys    = kvpair.first.first;
+                const auto&             reg     = kvpair.first.second;
+                const auto inserted = insert_nested_key(
+                        tab, kvpair.second, keys.begin(), keys.end(), reg);
+                if(!inserted)
+                {
+                    throw syntax_error(inserted.unwrap_err(), source_location(loc));
+                }
+            }
+            else
+            {
+                throw syntax_error(kv.unwrap_err(), source_location(loc));
+            }
+        }
+
+        lex_ws::scan(loc);
+        lex_comment::scan(loc);
+
+        const auto newline = skip_line::invoke(loc);
+        if(!newline && loc.iter() != loc.end())
+        {
+            const auto before = loc.iter();
+            lex_ws::scan(loc); // skip whitespace
+            const auto msg = format_underline("toml::parse_table: "
+                "invalid line format", {{source_location(loc), concat_to_string(
+                "expected newline, but got '", show_char(*loc.iter()), "'.")}});
+            loc.reset(before);
+            throw syntax_error(msg, source_location(loc));
+        }
+        lex_ws::scan(loc);
+        lex_comment::scan(loc);
+    }
+    return tab;
+}
+
+// removes the values that are not on the paths. All the paths have the same
+// prefix of length `depth` that corresponds to `v`.
+template<typename Value>
+void prune_unselected(Value& v, const std::vector<std::vector<key>>& paths,
+                      const std::size_t depth)
+{
+    if(v.is_array())
+    {
+        for(auto& elem : v.as_array())
+        {
+            prune_unselected(elem, paths, depth);
+        }
+        return;
+    }
+    if(!v.is_table())
+    {
+        return;
+    }
+
+    auto& tab = v.as_table();
+    std::vector<key> unselected;
+    for(auto& kv : tab)
+    {
+        bool is_whole = false;
+        std::vector<std::vector<key>> subpaths;
+        for(const auto& path : paths)
+        {
+            if(path.at(depth) != kv.first) {continue;}
+
+            if(path.size() == depth + 1) {is_whole = true;}
+            else                         {subpaths.push_back(path);}
+        }
+        if(is_whole)
+        {
+            continue;
+        }
+        if(subpaths.empty())
+        {
+            unselected.push_back(kv.first);
+        }
+        else
+        {
+            prune_unselected(kv.second, subpaths, depth + 1);
+        }
+    }
+    for(const auto& k : unselected)
+    {
+        tab.erase(k);
+    }
+    return;
+}
+
+template<typename Value>
+Value parse_only(location& loc, const std::vector<std::vector<key>>& paths)
+{
+    using value_type = Value;
+    using table_type = typename value_type::table_type;
+
+    skip_bom(loc);
+    const auto first = loc.iter();
+    // the same region as parse_toml_file
+    const region file(loc, first, (first == loc.end()) ? first : std::next(first));
+    std::vector<std::string> comments = parse_file_comments(loc);
+
+    table_type root = parse_selected_ml_table<value_type>(loc, paths, {});
+    while(loc.iter() != loc.end())
+    {
+        bool is_array_table = true;
+        auto tabkey = parse_array_table_key(loc);
+        if(!tabkey)
+        {
+            is_array_table = false;
+            tabkey = parse_table_key(loc);
+        }
+        if(!tabkey)
+        {
+            throw syntax_error(format_underline("toml::parse_toml_file: "
+                "unknown line appeared", {{source_location(loc), "unknown format"}}),
+                source_location(loc));
+        }
+        const auto& keys = tabkey.unwrap().first;
+        const auto& reg  = tabkey.unwrap().second;
+
+        if(!is_on_selected_path(paths, keys))
+        {
+            loc.reset(find_table_header(loc.iter(), loc.end()));
+            continue;
+        }
+
+        auto tab = parse_selected_ml_table<value_type>(loc, paths, keys);
+        const auto inserted = insert_nested_key(root,
+                value_type(std::move(tab), reg, reg.comments()),
+                keys.begin(), keys.end(), reg, is_array_table);
+        if(!inserted)
+        {
+            throw syntax_error(inserted.unwrap_err(), source_location(loc));
+        }
+    }
+
+    value_type retval(std::move(root), file, std::move(comments));
+    prune_unselected(retval, paths, 0);
+    return retval;
+}
+
+} // detail
+
+// Parses only the values on the key paths, like {"server", "db.pool"}, and
+// their parent tables. The other values are skipped by a scanner that only
+// looks at quotes and brackets, so they are not validated.
+//
+// Note that tables and key-value pairs that are not on the paths are not
+// checked, so a table that is defined twice is not reported if it is skipped.
+template<typename                     Comment = TOML11_DEFAULT_COMMENT_STRATEGY,
+         template<typename ...> class Table   = std::unordered_map,
+         template<typename ...> class Array   = std::vector>
+basic_value<Comment, Table, Array>
+parse_only(std::istream& is, const std::vector<std::string>& key_paths,
+           std::string fname = "unknown file")
+{
+    const auto paths = detail::parse_key_paths(key_paths);
+    detail::location loc(std::move(fname), detail::read_stream(is));
+    return detail::parse_only<basic_value<Comment, Table, Array>>(loc, paths);
+}
+
+// the file is mapped into memory if possible.
+template<typename                     Comment = TOML11_DEFAULT_COMMENT_STRATEGY,
+         template<typename ...> class Table   = std::unordered_map,
+         template<typename ...> class Array   = std::vector>
+basic_value<Comment, Table, Array>
+parse_only(const std::string& fname, const std::vector<std::string>& key_paths)
+{
+    const auto paths = detail::parse_key_paths(key_paths);
+#ifdef TOML11_HAS_MMAP
+    detail::location loc(fname,
+            std::make_shared<detail::mapped_file_source>(fname));
+    return detail::parse_only<basic_value<Comment, Table, Array>>(loc, paths);
+#else
+    std::ifstream ifs(fname, std::ios_base::binary);
+    if(!ifs.good())
+    {
+        throw std::ios_base::failure(
+                "toml::parse: Error opening file \"" + fname + "\"");
+    }
+    ifs.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+    return parse_only<Comment, Table, Array>(ifs, key_paths, fname);
+#endif
+}
+
+} // toml
+#endif// TOML11_SELECTIVE_PARSER_HPP
@@ -36,7 +36,7 @@ format_key(const std::basic_string<charT, traits, Alloc>& k)
 
     // check the key can be a bare (unquoted) key
     detail::location loc(k, std::vector<char>(k.begin(), k.end()));
-    detail::lex_unquoted_key::invoke(loc);
+    detail::lex_unquoted_key::scan(loc);
     if(loc.iter() == loc.end())
     {
         return k; // all the tokens are consumed. the key is unquoted-key.
@@ -0,0 +1,598 @@
+//     Copyright Toru Niina 2017.
+// Distributed under the MIT License.
+#ifndef TOML11_SIMD_HPP
+#define TOML11_SIMD_HPP
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Kernels that skip runs of characters in a class, 16 or 32 bytes per step.
+// They are used to skip whitespaces, comments and the bodies of strings.
+// UTF-8 validation and the search of newlines are also here.
+//
+// On x86, SSE2 is used if it is enabled at compile time (it always is on
+// x86_64), and AVX2 is used if the CPU supports it at runtime (GCC and clang
+// only). Otherwise, a scalar loop is used. Define TOML11_DISABLE_SIMD to use
+// the scalar loops only.
+#ifndef TOML11_DISABLE_SIMD
+#  if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    define TOML11_HAS_SSE2
+#    include <emmintrin.h>
+#  endif
+#  if defined(TOML11_HAS_SSE2) && defined(__GNUC__) && \
+      (defined(__x86_64__) || defined(__i386__))
+#    define TOML11_HAS_AVX2_DISPATCH
+#    include <immintrin.h>
+#  endif
+#endif // TOML11_DISABLE_SIMD
+
+namespace toml
+{
+namespace detail
+{
+
+// ----------------------------------------------------------------------------
+// character classes. `sse2` and `avx2` set 0xFF to the bytes in the class.
+
+struct ws_class // ' ' and '\t'
+{
+    static bool scalar(const char c) noexcept
+    {
+        return c == ' ' || c == '\t';
+    }
+#ifdef TOML11_HAS_SSE2
+    static __m128i sse2(const __m128i x) noexcept
+    {
+        return _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8(' ')),
+                            _mm_cmpeq_epi8(x, _mm_set1_epi8('\t')));
+    }
+#endif
+#ifdef TOML11_HAS_AVX2_DISPATCH
+    __attribute__((target("avx2")))
+    static __m256i avx2(const __m256i x) noexcept
+    {
+        return _mm256_or_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8(' ')),
+                               _mm256_cmpeq_epi8(x, _mm256_set1_epi8('\t')));
+    }
+#endif
+};
+
+struct comment_class // the characters in a comment, not validated as UTF-8
+{
+    static bool scalar(const char c) noexcept
+    {
+        const auto u = static_cast<unsigned char>(c);
+        return c == '\t' || (0x20 <= u && u != 0x7F);
+    }
+#ifdef TOML11_HAS_SSE2
+    static __m128i sse2(const __m128i x) noexcept
+    {
+        // signed comparison. [0x80, 0xFF] are negative.
+        const __m128i ok = _mm_or_si128(
+                _mm_cmpgt_epi8(x, _mm_set1_epi8(0x1F)),
+                _mm_cmplt_epi8(x, _mm_setzero_si128()));
+        return _mm_or_si128(_mm_andnot_si128(
+                _mm_cmpeq_epi8(x, _mm_set1_epi8(0x7F)), ok),
+                _mm_cmpeq_epi8(x, _mm_set1_epi8('\t')));
+    }
+#endif
+#ifdef TOML11_HAS_AVX2_DISPATCH
+    __attribute__((target("avx2")))
+    static __m256i avx2(const __m256i x) noexcept
+    {
+        const __m256i ok = _mm256_or_si256(
+                _mm256_cmpgt_epi8(x, _mm256_set1_epi8(0x1F)),
+                _mm256_cmpgt_epi8(_mm256_setzero_si256(), x));
+        return _mm256_or_si256(_mm256_andnot_si256(
+                _mm256_cmpeq_epi8(x, _mm256_set1_epi8(0x7F)), ok),
+                _mm256_cmpeq_epi8(x, _mm256_set1_epi8('\t')));
+    }
+#endif
+};
+
+struct ascii_class // [0x00, 0x7F]
+{
+    static bool scalar(const char c) noexcept
+    {
+        return static_cast<unsigned char>(c) < 0x80;
+    }
+#ifdef TOML11_HAS_SSE2
+    static __m128i sse2(const __m128i x) noexcept
+    {
+        return _mm_cmpgt_epi8(x, _mm_set1_epi8(-1));
+    }
+#endif
+#ifdef TOML11_HAS_AVX2_DISPATCH
+    __attribute__((target("avx2")))
+    static __m256i avx2(const __m256i x) noexcept
+    {
+        return _mm256_cmpgt_epi8(x, _mm256_set1_epi8(-1));
+    }
+#endif
+};
+
+// the characters in a string body that can be copied as they are: tab,
+// [0x20, 0x7E] except `Q1` and `Q2`, the bytes of multi-byte UTF-8 characters
+// (they are validated separately) and, if `Newline`, '\n'.
+template<char Q1, char Q2, bool Newline>
+struct string_body_class
+{
+    static bool scalar(const char c) noexcept
+    {
+        const auto u = static_cast<unsigned char>(c);
+        return (0x20 <= u || c == '\t' || (Newline && c == '\n')) &&
+               u != 0x7F && c != Q1 && c != Q2;
+    }
+#ifdef TOML11_HAS_SSE2
+    static __m128i sse2(const __m128i x) noexcept
+    {
+        __m128i ok = _mm_or_si128(_mm_or_si128(
+                _mm_cmpgt_epi8(x, _mm_set1_epi8(0x1F)),
+                _mm_cmplt_epi8(x, _mm_setzero_si128())),
+                _mm_cmpeq_epi8(x, _mm_set1_epi8('\t')));
+        if(Newline)
+        {
+            ok = _mm_or_si128(ok, _mm_cmpeq_epi8(x, _mm_set1_epi8('\n')));
+        }
+        const __m128i ng = _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8(0x7F)),
+                _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8(Q1)),
+                             _mm_cmpeq_epi8(x, _mm_set1_epi8(Q2))));
+        return _mm_andnot_si128(ng, ok);
+    }
+#endif
+#ifdef TOML11_HAS_AVX2_DISPATCH
+    __attribute__((target("avx2")))
+    static __m256i avx2(const __m256i x) noexcept
+    {
+        __m256i ok = _mm256_or_si256(_mm256_or_si256(
+                _mm256_cmpgt_epi8(x, _mm256_set1_epi8(0x1F)),
+                _mm256_cmpgt_epi8(_mm256_setzero_si256(), x)),
+                _mm256_cmpeq_epi8(x, _mm256_set1_epi8('\t')));
+        if(Newline)
+        {
+            ok = _mm256_or_si256(ok, _mm256_cmpeq_epi8(x, _mm256_set1_epi8('\n')));
+        }
+        const __m256i ng = _mm256_or_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8(0x7F)),
+                _mm256_or_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8(Q1)),
+                                _mm256_cmpeq_epi8(x, _mm256_set1_epi8(Q2))));
+        return _mm256_andnot_si256(ng, ok);
+    }
+#endif
+};
+using basic_string_body_class      = string_body_class<'"',  '\\', false>;
+using ml_basic_string_body_class   = string_body_class<'"',  '\\', true >;
+using literal_string_body_class    = string_body_class<'\'', '\'',  false>;
+using ml_literal_string_body_class = string_body_class<'\'', '\'',  true >;
+
+inline unsigned int count_trailing_zeros(std::uint32_t x) noexcept
+{
+    // x != 0
+#if defined(__GNUC__)
+    return static_cast<unsigned int>(__builtin_ctz(x));
+#else
+    unsigned int n = 0;
+    while((x & 1u) == 0) {x >>= 1; ++n;}
+    return n;
+#endif
+}
+
+// ----------------------------------------------------------------------------
+// kernels. They return the first character that is not in the class.
+
+template<typename Class>
+const char* skip_scalar(const char* first, const char* last) noexcept
+{
+    while(first != last && Class::scalar(*first)) {++first;}
+    return first;
+}
+
+#ifdef TOML11_HAS_SSE2
+template<typename Class>
+const char* skip_sse2(const char* first, const char* last) noexcept
+{
+    while(last - first >= 16)
+    {
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+        const auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(Class::sse2(x)));
+        if(mask != 0xFFFFu)
+        {
+            return first + count_trailing_zeros(~mask);
+        }
+        first += 16;
+    }
+    return skip_scalar<Class>(first, last);
+}
+#endif // TOML11_HAS_SSE2
+
+#ifdef TOML11_HAS_AVX2_DISPATCH
+template<typename Class>
+__attribute__((target("avx2")))
+const char* skip_avx2(const char* first, const char* last) noexcept
+{
+    while(last - first >= 32)
+    {
+        const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+        const auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(Class::avx2(x)));
+        if(mask != 0xFFFFFFFFu)
+        {
+            return first + count_trailing_zeros(~mask);
+        }
+        first += 32;
+    }
+    return skip_sse2<Class>(first, last);
+}
+
+inline bool cpu_has_avx2() noexcept
+{
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    return has_avx2;
+}
+#endif // TOML11_HAS_AVX2_DISPATCH
+
+template<typename Class>
+const char* skip_class(const char* first, const char* last) noexcept
+{
+#if defined(TOML11_HAS_AVX2_DISPATCH)
+    if(cpu_has_avx2())
+    {
+        return skip_avx2<Class>(first, last);
+    }
+#endif
+#if defined(TOML11_HAS_SSE2)
+    return skip_sse2<Class>(first, last);
+#else
+    return skip_scalar<Class>(first, last);
+#endif
+}
+
+// ----------------------------------------------------------------------------
+
+// skips spaces and tabs.
+inline const char* skip_ws(const char* first, const char* last) noexcept
+{
+    // most of the whitespaces are a single space between tokens.
+    if(last - first < 2 || !ws_class::scalar(first[1]))
+    {
+        return skip_scalar<ws_class>(first, last);
+    }
+    return skip_class<ws_class>(first, last);
+}
+
+// ----------------------------------------------------------------------------
+// newlines. They append the offsets from `base` of the next characters of the
+// '\n's in [first, last), that are the first characters of the lines.
+
+inline void find_line_starts_scalar(const char* base, const char* first,
+        const char* last, std::vector<std::size_t>& starts)
+{
+    for(; first != last; ++first)
+    {
+        if(*first == '\n')
+        {
+            starts.push_back(static_cast<std::size_t>(first - base) + 1);
+        }
+    }
+    return;
+}
+
+inline void push_line_starts(const char* base, const char* block,
+        std::uint32_t mask, std::vector<std::size_t>& starts)
+{
+    const auto offset = static_cast<std::size_t>(block - base) + 1;
+    while(mask != 0)
+    {
+        starts.push_back(offset + count_trailing_zeros(mask));
+        mask &= mask - 1;
+    }
+    return;
+}
+
+#ifdef TOML11_HAS_SSE2
+inline void find_line_starts_sse2(const char* base, const char* first,
+        const char* last, std::vector<std::size_t>& starts)
+{
+    const __m128i newline = _mm_set1_epi8('\n');
+    while(last - first >= 16)
+    {
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+        push_line_starts(base, first, static_cast<std::uint32_t>(
+                    _mm_movemask_epi8(_mm_cmpeq_epi8(x, newline))), starts);
+        first += 16;
+    }
+    find_line_starts_scalar(base, first, last, starts);
+    return;
+}
+#endif // TOML11_HAS_SSE2
+
+#ifdef TOML11_HAS_AVX2_DISPATCH
+__attribute__((target("avx2")))
+inline void find_line_starts_avx2(const char* base, const char* first,
+        const char* last, std::vector<std::size_t>& starts)
+{
+    const __m256i newline = _mm256_set1_epi8('\n');
+    while(last - first >= 32)
+    {
+        const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+        push_line_starts(base, first, static_cast<std::uint32_t>(
+                    _mm256_movemask_epi8(_mm256_cmpeq_epi8(x, newline))), starts);
+        first += 32;
+    }
+    find_line_starts_sse2(base, first, last, starts);
+    return;
+}
+#endif // TOML11_HAS_AVX2_DISPATCH
+
+// returns the offsets of the first characters of all the lines in
+// [first, last). The first one is always 0.
+inline std::vector<std::size_t> find_line_starts(const char* first, const char* last)
+{
+    std::vector<std::size_t> starts;
+    starts.reserve(static_cast<std::size_t>(last - first) / 32 + 1);
+    starts.push_back(0);
+#if defined(TOML11_HAS_AVX2_DISPATCH)
+    if(cpu_has_avx2())
+    {
+        find_line_starts_avx2(first, first, last, starts);
+        return starts;
+    }
+#endif
+#if defined(TOML11_HAS_SSE2)
+    find_line_starts_sse2(first, first, last, starts);
+#else
+    find_line_starts_scalar(first, first, last, starts);
+#endif
+    return starts;
+}
+
+// ----------------------------------------------------------------------------
+// UTF-8 validation.
+//
+// The accepted sequences are the same as lex_utf8_code:
+//
+// | 1st     | 2nd     | 3rd     | 4th     |
+// |:--------|:--------|:--------|:--------|
+// | 00 - 7F |         |         |         |
+// | C2 - DF | 80 - BF |         |         |
+// | E0      | A0 - BF | 80 - BF |         |
+// | E1 - EC | 80 - BF | 80 - BF |         |
+// | ED      | 80 - 9F | 80 - BF |         |
+// | EE - EF | 80 - BF | 80 - BF |         |
+// | F0      | 90 - BF | 80 - BF | 80 - BF |
+// | F1 - F3 | 80 - BF | 80 - BF | 80 - BF |
+// | F4      | 80 - 8F | 80 - BF | 80 - BF |
+
+// the length of a valid UTF-8 sequence that starts at `first`, or 0.
+inline std::size_t utf8_sequence_length(const char* first, const char* last) noexcept
+{
+    const auto in_range = [](const char c, const unsigned char lo,
+                             const unsigned char hi) noexcept -> bool {
+        const auto u = static_cast<unsigned char>(c);
+        return lo <= u && u <= hi;
+    };
+    const auto c0   = static_cast<unsigned char>(*first);
+    const auto rest = last - first;
+    if(c0 < 0x80)
+    {
+        return 1;
+    }
+    else if(0xC2 <= c0 && c0 <= 0xDF)
+    {
+        return (2 <= rest && in_range(first[1], 0x80, 0xBF)) ? 2 : 0;
+    }
+    else if(0xE0 <= c0 && c0 <= 0xEF)
+    {
+        const unsigned char lo = (c0 == 0xE0) ? 0xA0 : 0x80;
+        const unsigned char hi = (c0 == 0xED) ? 0x9F : 0xBF;
+        return (3 <= rest && in_range(first[1], lo, hi) &&
+                in_range(first[2], 0x80, 0xBF)) ? 3 : 0;
+    }
+    else if(0xF0 <= c0 && c0 <= 0xF4)
+    {
+        const unsigned char lo = (c0 == 0xF0) ? 0x90 : 0x80;
+        const unsigned char hi = (c0 == 0xF4) ? 0x8F : 0xBF;
+        return (4 <= rest && in_range(first[1], lo, hi) &&
+                in_range(first[2], 0x80, 0xBF) &&
+                in_range(first[3], 0x80, 0xBF)) ? 4 : 0;
+    }
+    return 0;
+}
+
+// returns the first byte of the first invalid sequence, or `last`.
+inline const char* validate_utf8_scalar(const char* first, const char* last) noexcept
+{
+    while(first != last)
+    {
+        first = skip_class<ascii_class>(first, last);
+        if(first == last)
+        {
+            break;
+        }
+        const auto len = utf8_sequence_length(first, last);
+        if(len == 0)
+        {
+            break;
+        }
+        first += len;
+    }
+    return first;
+}
+
+#ifdef TOML11_HAS_AVX2_DISPATCH
+// The lookup algorithm by John Keiser and Daniel Lemire, "Validating UTF-8 In
+// Less Than One Instruction Per Byte" (2021). Three table lookups by the
+// nibbles of a byte and the previous one find all the errors in a 2-byte
+// window. Longer sequences are checked by the positions of the continuations.
+// It only tells whether the input is valid or not.
+struct utf8_checker_avx2
+{
+    static constexpr std::uint8_t too_short  = 1 << 0;
+    static constexpr std::uint8_t too_long   = 1 << 1;
+    static constexpr std::uint8_t overlong_3 = 1 << 2;
+    static constexpr std::uint8_t too_large  = 1 << 3;
+    static constexpr std::uint8_t surrogate  = 1 << 4;
+    static constexpr std::uint8_t overlong_2 = 1 << 5;
+    static constexpr std::uint8_t too_large_1000 = 1 << 6;
+    static constexpr std::uint8_t overlong_4 = 1 << 6;
+    static constexpr std::uint8_t two_conts  = 1 << 7;
+    static constexpr std::uint8_t carry = too_short | too_long | two_conts;
+
+    __attribute__((target("avx2")))
+    static __m256i table(const std::uint8_t (&t)[16]) noexcept
+    {
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(t));
+        return _mm256_broadcastsi128_si256(x);
+    }
+    __attribute__((target("avx2")))
+    static __m256i high_nibble(const __m256i x) noexcept
+    {
+        return _mm256_and_si256(_mm256_srli_epi16(x, 4), _mm256_set1_epi8(0x0F));
+    }
+    // [prev[32-N], ..., prev[31], x[0], ..., x[31-N]]
+    template<int N>
+    __attribute__((target("avx2")))
+    static __m256i shifted(const __m256i x, const __m256i prev) noexcept
+    {
+        return _mm256_alignr_epi8(x, _mm256_permute2x128_si256(prev, x, 0x21), 16 - N);
+    }
+
+    __attribute__((target("avx2")))
+    static __m256i check(const __m256i x, const __m256i prev) noexcept
+    {
+        static const std::uint8_t byte_1_high[16] = {
+            // 0_______ : ASCII
+            too_long, too_long, too_long, too_long,
+            too_long, too_long, too_long, too_long,
+            // 10______ : continuation
+            two_conts, two_conts, two_conts, two_conts,
+            // 1100____, 1101____ : 2-byte lead
+            too_short | overlong_2,
+            too_short,
+            // 1110____ : 3-byte lead
+            too_short | overlong_3 | surrogate,
+            // 1111____ : 4-byte lead
+            too_short | too_large | too_large_1000 | overlong_4
+        };
+        static const std::uint8_t byte_1_low[16] = {
+            carry | overlong_3 | overlong_2 | overlong_4, // ____0000
+            carry | overlong_2,                           // ____0001
+            carry,                                        // ____0010
+            carry,                                        // ____0011
+            carry | too_large,                            // ____0100
+            carry | too_large | too_large_1000,           // ____0101
+            carry | too_large | too_large_1000,
+            carry | too_large | too_large_1000,
+            carry | too_large | too_large_1000,
+            carry | too_large | too_large_1000,
+            carry | too_large | too_large_1000,
+            carry | too_large | too_large_1000,
+            carry | too_large | too_large_1000,
+            carry | too_large | too_large_1000 | surrogate, // ____1101
+            carry | too_large | too_large_1000,
+            carry | too_large | too_large_1000
+        };
+        static const std::uint8_t byte_2_high[16] = {
+            // ASCII
+            too_short, too_short, too_short, too_short,
+            too_short, too_short, too_short, too_short,
+            // 1000____
+            too_long | overlong_2 | two_conts | overlong_3 | too_large_1000 | overlong_4,
+            // 1001____
+            too_long | overlong_2 | two_conts | overlong_3 | too_large,
+            // 101_____
+            too_long | overlong_2 | two_conts | surrogate  | too_large,
+            too_long | overlong_2 | two_conts | surrogate  | too_large,
+            // 11______ : lead
+            too_short, too_short, too_short, too_short
+        };
+
+        const __m256i prev1 = shifted<1>(x, prev);
+        const __m256i special = _mm256_and_si256(_mm256_and_si256(
+            _mm256_shuffle_epi8(table(byte_1_high), high_nibble(prev1)),
+            _mm256_shuffle_epi8(table(byte_1_low),
+                                _mm256_and_si256(prev1, _mm256_set1_epi8(0x0F)))),
+            _mm256_shuffle_epi8(table(byte_2_high), high_nibble(x)));
+
+        // the 3rd and 4th bytes of a sequence should be continuations
+        const __m256i prev2 = shifted<2>(x, prev);
+        const __m256i prev3 = shifted<3>(x, prev);
+        const __m256i is_third  = _mm256_subs_epu8(prev2, _mm256_set1_epi8(static_cast<char>(0xE0 - 1)));
+        const __m256i is_fourth = _mm256_subs_epu8(prev3, _mm256_set1_epi8(static_cast<char>(0xF0 - 1)));
+        const __m256i must_be_cont = _mm256_and_si256(
+            _mm256_cmpgt_epi8(_mm256_or_si256(is_third, is_fourth), _mm256_setzero_si256()),
+            _mm256_set1_epi8(static_cast<char>(0x80)));
+        return _mm256_xor_si256(must_be_cont, special);
+    }
+
+    // non-zero if the last sequence in `x` is not terminated.
+    __attribute__((target("avx2")))
+    static __m256i incomplete(const __m256i x) noexcept
+    {
+        const __m256i max = _mm256_setr_epi8(
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            static_cast<char>(0xF0 - 1), static_cast<char>(0xE0 - 1),
+            static_cast<char>(0xC0 - 1));
+        return _mm256_subs_epu8(x, max);
+    }
+
+    __attribute__((target("avx2")))
+    static bool is_valid(const char* first, const char* last) noexcept
+    {
+        __m256i error      = _mm256_setzero_si256();
+        __m256i prev       = _mm256_setzero_si256();
+        __m256i prev_incmp = _mm256_setzero_si256();
+
+        alignas(32) char buffer[32];
+        while(first != last)
+        {
+            __m256i x;
+            if(last - first >= 32)
+            {
+                x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+                first += 32;
+            }
+            else // pad the last block with ASCII
+            {
+                std::fill(buffer, buffer + 32, '\0');
+                std::copy(first, last, buffer);
+                x = _mm256_load_si256(reinterpret_cast<const __m256i*>(buffer));
+                first = last;
+            }
+
+            if(_mm256_movemask_epi8(x) == 0) // all ASCII
+            {
+                error = _mm256_or_si256(error, prev_incmp);
+                prev_incmp = _mm256_setzero_si256();
+            }
+            else
+            {
+                error = _mm256_or_si256(error, check(x, prev));
+                prev_incmp = incomplete(x);
+            }
+            prev = x;
+        }
+        error = _mm256_or_si256(error, prev_incmp);
+        return _mm256_testz_si256(error, error) != 0;
+    }
+};
+#endif // TOML11_HAS_AVX2_DISPATCH
+
+// returns the first byte of the first invalid UTF-8 sequence in [first, last),
+// or `last` if all are valid.
+inline const char* validate_utf8(const char* first, const char* last) noexcept
+{
+#if defined(TOML11_HAS_AVX2_DISPATCH)
+    // the validator only tells if there is an error. To find the position,
+    // the scalar version is used. Since an error is rare, it does not matter.
+    if(cpu_has_avx2() && utf8_checker_avx2::is_valid(first, last))
+    {
+        return last;
+    }
+#endif
+    return validate_utf8_scalar(first, last);
+}
+
+} // detail
+} // toml
+#endif // TOML11_SIMD_HPP
@@ -0,0 +1,288 @@
+//     Copyright Toru Niina 2017.
+// Distributed under the MIT License.
+#ifndef TOML11_WATCHED_DOCUMENT_HPP
+#define TOML11_WATCHED_DOCUMENT_HPP
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "exception.hpp"
+#include "incremental_parser.hpp"
+
+#ifndef TOML11_DISABLE_INOTIFY
+#if defined(__linux__)
+#define TOML11_HAS_INOTIFY
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif // linux
+#endif // TOML11_DISABLE_INOTIFY
+
+#ifdef TOML11_HAS_INOTIFY
+namespace toml
+{
+namespace detail
+{
+// closes the file descriptor when it goes out of scope, so that the
+// descriptors opened in a constructor do not leak if it throws later.
+struct file_descriptor
+{
+    explicit file_descriptor(const int fd) noexcept: fd_(fd) {}
+    ~file_descriptor()
+    {
+        if(fd_ != -1) {::close(fd_);}
+    }
+    file_descriptor(const file_descriptor&) = delete;
+    file_descriptor& operator=(const file_descriptor&) = delete;
+
+    void reset(const int fd) noexcept
+    {
+        if(fd_ != -1) {::close(fd_);}
+        fd_ = fd;
+    }
+    int release() noexcept
+    {
+        const int fd = fd_;
+        fd_ = -1;
+        return fd;
+    }
+    int  get()   const noexcept {return fd_;}
+    bool valid() const noexcept {return fd_ != -1;}
+
+  private:
+    int fd_;
+};
+} // detail
+
+// A document that is reloaded when the file is modified.
+//
+// A background thread waits for inotify events in the directory of the file.
+// When the file is written and closed, or another file is renamed to it (as
+// many editors do when they save a file), the thread reads the file and
+// reparses the changed part (see toml::incremental_document). The new value
+// is published by replacing a std::shared_ptr under a mutex that is held only
+// to copy the pointer, so `get()` never sees a value that is being built and
+// never waits for a reload. If the event queue overflows, the file is
+// reloaded because a modification may have been missed. A value obtained by
+// `get()` is kept alive until the last copy of the pointer is destroyed.
+//
+// ```cpp
+// toml::watched_document<> config("config.toml");
+// while(true)
+// {
+//     const auto snapshot = config.get(); // std::shared_ptr<const toml::value>
+//     serve(toml::find<int>(*snapshot, "server", "port"));
+// }
+// ```
+//
+// If the modified file has a syntax error, the previous value is kept and the
+// error message is available from `last_error()`.
+template<typename                     Comment = TOML11_DEFAULT_COMMENT_STRATEGY,
+         template<typename ...> class Table   = std::unordered_map,
+         template<typename ...> class Array   = std::vector>
+class watched_document
+{
+  public:
+    using value_type = basic_value<Comment, Table, Array>;
+
+  public:
+
+    // starts watching the file and parses it. If the file cannot be read or
+    // parsed, it throws in the same way as toml::parse.
+    //
+    // The directory is watched before the file is parsed, so a modification
+    // made while the constructor runs queues an event and is not missed.
+    explicit watched_document(std::string fname)
+        : fname_(std::move(fname)), basename_(basename_of(fname_)),
+          inotify_fd_(watch_directory(fname_)),
+          // used to wake up the watcher thread in the destructor
+          event_fd_(::eventfd(0, EFD_CLOEXEC)),
+          version_(0), value_(nullptr),
+          error_(std::make_shared<const std::string>()),
+          doc_(parse_incremental<Comment, Table, Array>(fname_))
+    {
+        if(!event_fd_.valid())
+        {
+            throw file_io_error(errno, "Failed to create eventfd", fname_);
+        }
+        value_ = std::make_shared<const value_type>(doc_.value());
+
+        // the descriptors are closed by their holders if this throws.
+        watcher_ = std::thread([this]() {this->watch();});
+    }
+
+    // the watcher thread refers to `this`, so it cannot be copied or moved.
+    watched_document(const watched_document&) = delete;
+    watched_document(watched_document&&)      = delete;
+    watched_document& operator=(const watched_document&) = delete;
+    watched_document& operator=(watched_document&&)      = delete;
+
+    ~watched_document()
+    {
+        const std::uint64_t one = 1;
+        const auto written = ::write(event_fd_.get(), &one, sizeof(one));
+        (void)written;
+        watcher_.join();
+    }
+
+    // the latest value. It is safe to call this from any thread.
+    std::shared_ptr<const value_type> get() const
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return value_;
+    }
+
+    // the number of times the value has been reloaded.
+    std::size_t version() const noexcept
+    {
+        return version_.load();
+    }
+
+    // the message of the error in the last reload. Empty if it succeeded.
+    std::string last_error() const
+    {
+        std::shared_ptr<const std::string> latest;
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            latest = error_;
+        }
+        return *latest;
+    }
+
+  private:
+
+    static std::string basename_of(const std::string& fname)
+    {
+        const auto slash = fname.rfind('/');
+        return (slash == std::string::npos) ? fname : fname.substr(slash + 1);
+    }
+
+    // returns an inotify descriptor that watches the directory of the file.
+    static int watch_directory(const std::string& fname)
+    {
+        const auto slash = fname.rfind('/');
+        const std::string dir = (slash == std::string::npos) ? std::string(".") :
+                                (slash == 0) ? std::string("/") : fname.substr(0, slash);
+
+        detail::file_descriptor fd(::inotify_init1(IN_CLOEXEC));
+        if(!fd.valid())
+        {
+            throw file_io_error(errno, "Failed to initialize inotify", fname);
+        }
+        // watch the directory to catch renames. After a file is replaced by
+        // rename(2), a watch on the file would be left on the old inode.
+        if(::inotify_add_watch(fd.get(), dir.c_str(),
+                               IN_CLOSE_WRITE | IN_MOVED_TO) == -1)
+        {
+            throw file_io_error(errno, "Failed to watch", dir);
+        }
+        return fd.release();
+    }
+
+    void watch()
+    {
+        // enough for a few events. inotify_event is followed by the name.
+        alignas(inotify_event) char buffer[4096];
+
+        pollfd fds[2];
+        fds[0].fd = inotify_fd_.get(); fds[0].events = POLLIN; fds[0].revents = 0;
+        fds[1].fd = event_fd_.get();   fds[1].events = POLLIN; fds[1].revents = 0;
+        while(true)
+        {
+            if(::poll(fds, 2, -1) == -1)
+            {
+                if(errno == EINTR) {continue;}
+                this->set_error(file_io_error(errno, "Failed to poll", fname_).what());
+                return;
+            }
+            if(fds[1].revents != 0)
+            {
+                return; // destructor is called
+            }
+
+            // reload only once even if several events are queued
+            bool modified = false;
+            const auto len = ::read(inotify_fd_.get(), buffer, sizeof(buffer));
+            for(ssize_t i = 0; i < len; )
+            {
+                const inotify_event* ev =
+                    reinterpret_cast<const inotify_event*>(buffer + i);
+                if(ev->len != 0 && basename_ == ev->name)
+                {
+                    modified = true;
+                }
+                // some events are dropped. the file may have been modified.
+                if((ev->mask & IN_Q_OVERFLOW) != 0)
+                {
+                    modified = true;
+                }
+                i += static_cast<ssize_t>(sizeof(inotify_event) + ev->len);
+            }
+            if(modified)
+            {
+                this->reload();
+            }
+        }
+    }
+
+    void reload()
+    {
+        try
+        {
+            std::ifstream ifs(fname_, std::ios_base::binary);
+            if(!ifs.good())
+            {
+                throw std::ios_base::failure(
+                        "toml::parse: Error opening file \"" + fname_ + "\"");
+            }
+            ifs.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+            const auto letters = detail::read_stream(ifs);
+
+            doc_.update(std::string(letters.begin(), letters.end()));
+            auto latest = std::make_shared<const value_type>(doc_.value());
+            {
+                std::lock_guard<std::mutex> lock(mtx_);
+                value_ = std::move(latest);
+            }
+            this->set_error(std::string());
+            version_.fetch_add(1);
+        }
+        catch(const std::exception& e)
+        {
+            this->set_error(e.what());
+        }
+        return;
+    }
+
+    void set_error(std::string msg)
+    {
+        auto latest = std::make_shared<const std::string>(std::move(msg));
+        std::lock_guard<std::mutex> lock(mtx_);
+        error_ = std::move(latest);
+    }
+
+  private:
+
+    std::string fname_;
+    std::string basename_;
+    detail::file_descriptor inotify_fd_;
+    detail::file_descriptor event_fd_;
+
+    std::atomic<std::size_t>                 version_;
+    mutable std::mutex                       mtx_; // guards value_ and error_
+    std::shared_ptr<const value_type>        value_;
+    std::shared_ptr<const std::string>       error_;
+    incremental_document<Comment, Table, Array> doc_; // used by the watcher
+    std::thread                              watcher_;
+};
+
+} // toml
+#endif // TOML11_HAS_INOTIFY
+#endif// TOML11_WATCHED_DOCUMENT_HPP